@@ -0,0 +1,420 @@
+#pragma once
+
+#include "main.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Autonomous commands as C++20 coroutines.
+//
+// A command is a coroutine returning Command. It runs until it co_awaits
+// something that isn't ready, and the scheduler task resumes it on a later
+// tick, so any number of commands share one task with no busy waiting:
+//
+//   Command score() {
+//       co_await deadline(nav.go_to(TO_GOAL), spin_intake(INTAKE_MAIN, INTAKE_FWD));
+//       co_await race(chassis.turn(GOAL_TURN), wait(1000));
+//       co_await parallel(chassis.move(-6), wait_until([] { return block_sensed(); }));
+//   }
+//
+//   co_await cmd              run cmd to the end, then carry on
+//   sequence(a, b, ...)       each in turn
+//   parallel(a, b, ...)       all at once, until every one is done
+//   race(a, b, ...)           all at once, until any one is done
+//   deadline(a, b, ...)       all at once, until a is done
+//
+// A group cancels whatever is still running when it ends by destroying the
+// coroutine, which runs the destructors of everything in it, so a command
+// holding a motor should stop it in a destructor (see StopOnExit in
+// drivetrain.cpp). Commands are created suspended and start when awaited or
+// handed to CommandScheduler::run().
+//
+// Coroutine frames come from a fixed arena in size classes, freed blocks are
+// reused, and nothing is allocated from the heap. A command that can't get a
+// frame is empty: awaiting it finishes at once, and the failure is counted.
+
+#define COMMAND_PERIOD_MS 10
+#define COMMAND_PRIORITY TASK_PRIORITY_DEFAULT
+
+// Frame arena, blocks of 64 B up to 64 << (COMMAND_CLASSES - 1)
+#define COMMAND_ARENA_BYTES 16384
+#define COMMAND_CLASSES 7
+
+// Top level commands running at once
+#define COMMAND_MAX_ROOTS 4
+
+class CommandScheduler;
+
+struct CommandStats {
+    std::uint32_t frames;           // live now
+    std::uint32_t arena_used;       // bytes carved from the arena so far
+    std::uint32_t alloc_failures;
+    std::uint32_t ticks;
+};
+
+// Where a coroutine waits for the scheduler, kept inside the awaiter so it
+// lives in the waiting coroutine's frame and unlinks itself if destroyed
+struct Waiter {
+    Waiter* prev = nullptr;
+    Waiter* next = nullptr;
+    CommandScheduler* sched = nullptr;      // set while linked
+    std::coroutine_handle<> handle;
+    std::uint32_t wake_ms = 0;              // not before millis() reaches this
+    std::uint32_t added_tick = 0;           // and not on the tick it was added
+
+    Waiter() = default;
+    Waiter(const Waiter&) = delete;
+    Waiter& operator=(const Waiter&) = delete;
+    ~Waiter();
+};
+
+// Something waiting on several children, told when each finishes
+struct CommandGroupBase {
+    virtual std::coroutine_handle<> child_done(int index) = 0;
+};
+
+void* command_frame_alloc(std::size_t size) noexcept;
+void command_frame_free(void* p, std::size_t size) noexcept;
+void command_alloc_failed() noexcept;
+
+class [[nodiscard]] Command {
+    public:
+        struct promise_type {
+            std::coroutine_handle<> continuation;   // awaited directly
+            CommandGroupBase* group = nullptr;      // or run in a group
+            int index = 0;
+
+            struct Final {
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    promise_type& p = h.promise();
+                    if (p.continuation) {
+                        return p.continuation;
+                    }
+                    if (p.group) {
+                        return p.group->child_done(p.index);
+                    }
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            Command get_return_object() {
+                return Command(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            static Command get_return_object_on_allocation_failure() {
+                command_alloc_failed();
+                return Command();
+            }
+
+            static void* operator new(std::size_t size) noexcept {
+                return command_frame_alloc(size);
+            }
+
+            static void operator delete(void* p, std::size_t size) noexcept {
+                command_frame_free(p, size);
+            }
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            Final final_suspend() noexcept {
+                return {};
+            }
+
+            void return_void() {}
+
+            void unhandled_exception() {
+                std::terminate();
+            }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Command() = default;
+
+        Command(Command&& o) noexcept : h(std::exchange(o.h, {})) {}
+
+        Command& operator=(Command&& o) noexcept {
+            if (this != &o) {
+                cancel();
+                h = std::exchange(o.h, {});
+            }
+            return *this;
+        }
+
+        ~Command() {
+            cancel();
+        }
+
+        /**
+         * True once it has run to the end, or if it never got a frame.
+         */
+        bool done() const {
+            return !h || h.done();
+        }
+
+        /**
+         * Stops it wherever it is suspended and frees its frame.
+         */
+        void cancel() {
+            if (h) {
+                h.destroy();
+                h = {};
+            }
+        }
+
+        Handle handle() const {
+            return h;
+        }
+
+        auto operator co_await() const noexcept {
+            struct Awaiter {
+                Handle h;
+
+                bool await_ready() const noexcept {
+                    return !h || h.done();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) noexcept {
+                    h.promise().continuation = parent;
+                    return h;
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{h};
+        }
+
+    private:
+        explicit Command(Handle h) : h(h) {}
+
+        Handle h;
+};
+
+class CommandScheduler {
+    public:
+        void start();
+
+        /**
+         * Cancels everything and stops the task. Returns once the task has
+         * ended, or at once when called from a command, and then the task
+         * cancels everything and ends after the current tick.
+         */
+        void stop();
+
+        /**
+         * Hands a top level command to the task, it starts on the next tick.
+         * Safe from any task.
+         *
+         * \return false if COMMAND_MAX_ROOTS are already running
+         */
+        bool run(Command cmd);
+
+        /**
+         * Cancels every running command on the next tick, and returns once
+         * that is done. Safe from any task. From a command, which runs on the
+         * scheduler's own task, it can't wait for that tick: it returns at
+         * once and the caller runs on until it next suspends.
+         */
+        void cancel_all();
+
+        /**
+         * True while any top level command is running or waiting to start.
+         */
+        bool busy() const {
+            return roots_live != 0;
+        }
+
+        /**
+         * Blocks the calling task until nothing is running.
+         */
+        void wait() const;
+
+        CommandStats stats() const;
+
+        /**
+         * The scheduler whose task is running commands, for the awaiters.
+         */
+        static CommandScheduler* current() {
+            return running_now;
+        }
+
+        void link(Waiter& w);
+        void unlink(Waiter& w);
+
+    private:
+        static void task_fn(void* param);
+        void run_loop();
+        void tick();
+        void cancel_roots();
+
+        Command roots[COMMAND_MAX_ROOTS];
+        bool started[COMMAND_MAX_ROOTS] = {};
+        Command incoming[COMMAND_MAX_ROOTS];
+        pros::Mutex incoming_lock;
+        std::atomic<int> roots_live{0};
+        std::atomic<bool> cancel_pending{false};
+
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+        Waiter* visit_next = nullptr;       // walk of the list in progress
+
+        std::uint32_t ticks = 0;
+        static CommandScheduler* running_now;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+        pros::task_t task = nullptr;
+};
+
+// AWAITABLES, inside a command
+
+struct TickAwaiter {
+    Waiter w;
+    std::uint32_t wake_ms;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        w.handle = h;
+        w.wake_ms = wake_ms;
+        CommandScheduler::current()->link(w);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * Resumes on the scheduler's next tick.
+ */
+inline TickAwaiter next_tick() {
+    return {{}, pros::millis()};
+}
+
+/**
+ * Resumes on the first tick at least ms from now.
+ */
+inline TickAwaiter sleep_ms(std::uint32_t ms) {
+    return {{}, pros::millis() + ms};
+}
+
+// GROUPS
+
+enum class GroupMode : std::uint8_t {
+    all,            // parallel
+    any,            // race
+    first,          // deadline, the first child
+};
+
+template <std::size_t N>
+class GroupAwaiter : CommandGroupBase {
+    public:
+        template <typename... Cs>
+        GroupAwaiter(GroupMode mode, Cs&&... cs) : mode(mode), cmds{std::move(cs)...} {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            parent = h;
+            starting = true;
+            for (std::size_t i = 0; i < N && !finished; i++) {
+                if (cmds[i].done()) {
+                    note_done(i);
+                    continue;
+                }
+                cmds[i].handle().promise().group = this;
+                cmds[i].handle().promise().index = (int)i;
+                cmds[i].handle().resume();
+            }
+            starting = false;
+
+            // Everything it needed finished while starting, carry straight on
+            if (finished) {
+                cancel_rest();
+                return false;
+            }
+            return true;
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+        std::coroutine_handle<> child_done(int index) override {
+            if (!note_done(index)) {
+                return std::noop_coroutine();
+            }
+            cancel_rest();
+            return starting ? std::noop_coroutine() : parent;
+        }
+
+        bool note_done(std::size_t i) {
+            remaining--;
+            finished = mode == GroupMode::all ? remaining == 0 : mode == GroupMode::any || i == 0;
+            return finished;
+        }
+
+        void cancel_rest() {
+            for (Command& c : cmds) {
+                if (!c.done()) {
+                    c.cancel();
+                }
+            }
+        }
+
+        GroupMode mode;
+        Command cmds[N];
+        std::size_t remaining = N;
+        bool finished = false;
+        bool starting = false;
+        std::coroutine_handle<> parent;
+};
+
+template <typename... Cs>
+Command parallel(Cs... cs) {
+    co_await GroupAwaiter<sizeof...(Cs)>(GroupMode::all, std::move(cs)...);
+}
+
+template <typename... Cs>
+Command race(Cs... cs) {
+    co_await GroupAwaiter<sizeof...(Cs)>(GroupMode::any, std::move(cs)...);
+}
+
+template <typename... Cs>
+Command deadline(Cs... cs) {
+    co_await GroupAwaiter<sizeof...(Cs)>(GroupMode::first, std::move(cs)...);
+}
+
+template <typename... Cs>
+Command sequence(Cs... cs) {
+    (co_await cs, ...);
+}
+
+// SMALL COMMANDS
+
+/**
+ * Finishes after ms.
+ */
+Command wait(std::uint32_t ms);
+
+/**
+ * Finishes on the first tick pred() is true, checked once a tick.
+ */
+template <typename F>
+Command wait_until(F pred) {
+    while (!pred()) {
+        co_await next_tick();
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "main.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Port map checks and hot-plug detection.
+//
+// Every device's port is listed once in a constexpr PortEntry map next to
+// the port defines. The map is checked at compile time (ports in range, no
+// port used twice) and each device object takes its port through port_of(),
+// which fails the build if the map has that port as a different kind of
+// device.
+//
+// At startup scan() compares what is actually plugged in against the map.
+// After that a low priority task checks the mapped ports every few tens of
+// ms and keeps a bitmap of the ports that have their device, so control
+// loops test a bit instead of asking the kernel on every tick. A port's
+// epoch counts its disconnects and reconnects, so a loop holding state from
+// a device (an encoder count) can tell the device restarted under it.
+
+#define DEVICE_SCAN_MS 50
+#define DEVICE_PRIORITY TASK_PRIORITY_DEFAULT
+#define DEVICE_DEBOUNCE 2           // scans in a row a change must hold for
+
+// Smart ports are 1..21, bit p of a mask is port p
+#define DEVICE_PORTS 21
+#define DEVICE_MAX 24               // entries in one map
+
+struct PortEntry {
+    std::int8_t port;               // as passed to the device, the sign is ignored
+    pros::DeviceType type;
+    const char* name;
+};
+
+constexpr int port_number(std::int8_t port) {
+    return port < 0 ? -port : port;
+}
+
+template <std::size_t N>
+constexpr bool ports_in_range(const PortEntry (&map)[N]) {
+    for (std::size_t i = 0; i < N; i++) {
+        int p = port_number(map[i].port);
+        if (p < 1 || p > DEVICE_PORTS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <std::size_t N>
+constexpr bool ports_unique(const PortEntry (&map)[N]) {
+    for (std::size_t i = 0; i < N; i++) {
+        for (std::size_t j = i + 1; j < N; j++) {
+            if (port_number(map[i].port) == port_number(map[j].port)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * A device's port, checked against the map at compile time. A port that
+ * isn't in the map, or is mapped as another type, doesn't compile.
+ */
+template <std::size_t N>
+consteval std::int8_t port_of(const PortEntry (&map)[N], std::int8_t port, pros::DeviceType type) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (port_number(map[i].port) == port_number(port)) {
+            if (map[i].type != type) {
+                throw "port is mapped to a different device type";
+            }
+            return port;
+        }
+    }
+    throw "port is not in the port map";
+}
+
+struct DeviceStats {
+    std::uint32_t disconnects;
+    std::uint32_t reconnects;
+    std::uint32_t last_change_ms;
+};
+
+class DeviceRegistry {
+    public:
+        template <std::size_t N>
+        DeviceRegistry(const PortEntry (&map)[N]) : map(map), n(N) {
+            static_assert(N <= DEVICE_MAX, "port map is larger than DEVICE_MAX");
+        }
+
+        /**
+         * Reads every port once and fills the health bitmap, reporting
+         * missing, wrong and unexpected devices on the terminal.
+         *
+         * \return the number of mapped devices that aren't there
+         */
+        int scan();
+
+        void start();
+        void stop();
+
+        /**
+         * Bit p is set while port p has the device the map expects.
+         */
+        std::uint32_t health() const {
+            return healthy;
+        }
+
+        bool ok(std::int8_t port) const {
+            return (healthy.load() >> port_number(port)) & 1;
+        }
+
+        /**
+         * Ports the map expects a device on.
+         */
+        std::uint32_t expected() const;
+
+        /**
+         * Changes each time the device on the port goes or comes back.
+         */
+        std::uint32_t epoch(std::int8_t port) const {
+            return epochs[port_number(port)];
+        }
+
+        DeviceStats stats() const {
+            return {disconnects, reconnects, last_change_ms};
+        }
+
+        /**
+         * Name in the map of the first missing device, nullptr if none.
+         */
+        const char* first_missing() const;
+
+    private:
+        static void task_fn(void* param);
+        void run();
+        bool present(const PortEntry& e) const;
+        void report(const PortEntry& e, bool up) const;
+
+        const PortEntry* map;
+        std::size_t n;
+
+        std::atomic<std::uint32_t> healthy{0};
+        std::atomic<std::uint32_t> epochs[DEVICE_PORTS + 1] = {};
+        std::uint8_t pending[DEVICE_MAX] = {};     // scans a change has held
+
+        std::atomic<std::uint32_t> disconnects{0};
+        std::atomic<std::uint32_t> reconnects{0};
+        std::atomic<std::uint32_t> last_change_ms{0};
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
+
+/**
+ * Mask of a motor group's ports.
+ */
+std::uint32_t port_mask(const pros::MotorGroup& mg);
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "drive_gains.h"
+#include "pid.h"
+#include "pose.h"
+#include "profile.h"
+#include "pursuit.h"
+#include <cmath>
+#include <cstdint>
+
+// The per-tick control laws behind drivetrain's move, turn and follow.
+//
+// Each controller is given the time and the robot's state once a tick and
+// answers with both sides' feedforward speed and acceleration plus feedback
+// voltage, as drivetrain::drive_ff takes them. The clock, the sensors and the
+// motors are left to the caller, so drivetrain.cpp runs these on the robot
+// with Pid and tools/tune_gains.cpp runs the same laws in its simulation with
+// RuntimePid.
+//
+//   MoveControl ctl(prof, odom.get_pose(), Pid<DRIVE_PID>{}, Pid<HEADING_PID>{});
+//   DriveCommand o = ctl.update(t, odom.get_pose());
+//   if (!o.done) drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+
+struct DriveCommand {
+    float vl = 0, al = 0, fbl = 0;  // left side: in/s, in/s^2, mV of feedback
+    float vr = 0, ar = 0, fbr = 0;
+    bool done = false;              // settled or at the end, stop driving
+};
+
+/**
+ * Drives a distance profile straight along the starting heading, holding
+ * that heading.
+ */
+template <class DistPid, class HoldPid>
+class MoveControl {
+    public:
+        MoveControl(const Profile& prof, const Pose& start, DistPid dist, HoldPid hold)
+            : prof(prof), start(start), dist(dist), hold(hold) {}
+
+        /** How long the move may run before it is given up, ms */
+        std::uint32_t timeout_ms() const {
+            return (std::uint32_t)(prof.duration() * 1000) + MOVE_SETTLE_MS;
+        }
+
+        DriveCommand update(float t, const Pose& p) {
+            ProfileState s = prof.sample(t);
+
+            // Progress is measured along the starting heading
+            float dx = p.x - start.x;
+            float dy = p.y - start.y;
+            float travelled = dx * std::sin(start.theta) + dy * std::cos(start.theta);
+            float drift = std::remainder(p.theta - start.theta, 2 * (float)M_PI);
+
+            if (t >= prof.duration() && std::fabs(s.pos - travelled) < MOVE_TOLERANCE) {
+                return {.done = true};
+            }
+
+            float fb = dist.update(s.pos, travelled);
+            float turn = hold.update(0, drift);
+            return {s.vel, s.acc, fb + turn, s.vel, s.acc, fb - turn};
+        }
+
+    private:
+        Profile prof;
+        Pose start;
+        DistPid dist;
+        HoldPid hold;
+};
+
+/**
+ * Turns in place through an angle profile (rad, clockwise positive) from a
+ * starting heading. half is half the track width, in.
+ */
+template <class TurnPid>
+class TurnControl {
+    public:
+        TurnControl(const Profile& prof, float start, float half, TurnPid pid)
+            : prof(prof), start(start), half(half), pid(pid) {}
+
+        /** How long the turn may run before it is given up, ms */
+        std::uint32_t timeout_ms() const {
+            return (std::uint32_t)(prof.duration() * 1000) + MOVE_SETTLE_MS;
+        }
+
+        DriveCommand update(float t, float theta) {
+            ProfileState s = prof.sample(t);
+            float turned = theta - start;
+
+            if (t >= prof.duration() && std::fabs(s.pos - turned) < TURN_TOLERANCE) {
+                return {.done = true};
+            }
+
+            // Wheel speed for a turn rate, clockwise drives the left side
+            // forward
+            float fb = pid.update(s.pos, turned);
+            return {s.vel * half, s.acc * half, fb, -s.vel * half, -s.acc * half, -fb};
+        }
+
+    private:
+        Profile prof;
+        float start;
+        float half;
+        TurnPid pid;
+};
+
+/**
+ * Follows a path with pure pursuit, holding each side's speed by feedback on
+ * its measured speed. half is half the track width, in. The path has to
+ * outlive the controller.
+ */
+template <class SidePid>
+class FollowControl {
+    public:
+        FollowControl(const Path& path, float half, SidePid left, SidePid right)
+            : path(path), pursuit(path), half(half), left(left), right(right) {}
+
+        /** How long the path may run before it is given up, ms */
+        std::uint32_t timeout_ms() const {
+            return (std::uint32_t)(path.duration() * 1000) + PURSUIT_TIMEOUT_MS;
+        }
+
+        /** ml and mr are the sides' measured speeds, in/s */
+        DriveCommand update(const Pose& p, float ml, float mr) {
+            PursuitOutput out = pursuit.update(p);
+            if (out.done) {
+                return {.done = true};
+            }
+
+            // Side speeds for the commanded arc, clockwise speeds up the left
+            float vl = out.v + out.omega * half;
+            float vr = out.v - out.omega * half;
+            return {vl, out.a, left.update(vl, ml), vr, out.a, right.update(vr, mr)};
+        }
+
+    private:
+        const Path& path;
+        PurePursuit pursuit;
+        float half;
+        SidePid left;
+        SidePid right;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pid.h"
+
+// Drive motion limits and controller gains.
+//
+// Kept apart from drivetrain.h and free of PROS so the host tools can use
+// the same values: tools/tune_gains.cpp starts its search here and prints
+// its result in this form.
+
+// LINEAR LIMITS (in, s)
+#define DRIVE_MAX_VEL 60.0f
+#define DRIVE_MAX_ACCEL 120.0f
+#define DRIVE_MAX_JERK 600.0f
+
+// TURN LIMITS (rad, s)
+#define TURN_MAX_VEL 6.0f
+#define TURN_MAX_ACCEL 20.0f
+#define TURN_MAX_JERK 120.0f
+
+// Moves are stepped once a scheduler tick
+#define MOVE_PERIOD_MS 10
+
+// FEEDFORWARD, per side, mV per in/s and in/s^2
+constexpr FfGains DRIVE_FF = {.ks = 600, .kv = 150, .ka = 20};
+
+// FEEDBACK, mV
+constexpr float MOVE_DT = MOVE_PERIOD_MS / 1000.0f;
+constexpr PidGains DRIVE_PID = {.kp = 500, .dt = MOVE_DT};          // per inch behind the profile
+constexpr PidGains HEADING_PID = {.kp = 6000, .dt = MOVE_DT};       // per rad off heading while driving
+constexpr PidGains TURN_PID = {.kp = 8000, .dt = MOVE_DT};          // per rad behind the turn profile
+constexpr PidGains PURSUIT_VEL_PID = {.kp = 40, .dt = MOVE_DT};     // per in/s of side speed error
+
+// A move ends when the profile is done and it is within tolerance, or this
+// long after the profile ended
+#define MOVE_SETTLE_MS 500
+#define MOVE_TOLERANCE 0.5f     // inches
+#define TURN_TOLERANCE 0.02f    // rad
+
+// Path following gives up this long after the path should have finished
+#define PURSUIT_TIMEOUT_MS 1500
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "main.h"
+#include "command.h"
+#include "odom.h"
+#include "localizer.h"
+#include "motion.h"
+#include "profile.h"
+#include "pursuit.h"
+#include "drive_gains.h"
+#include "drive_control.h"
+
+// Profiled autonomous drive, turn and path following.
+//
+// Each move is an S-curve profile sampled every tick. The sample's velocity
+// and acceleration go through kS/kV/kA feedforward straight to move_voltage,
+// and only the small tracking error is left to PID feedback from the odometry.
+// Paths are followed with pure pursuit on the fused (odometry + GPS) pose,
+// with each side's speed held by feedback on the motion estimator's velocity.
+// The control laws themselves are in drive_control.h, shared with the tuner.
+//
+// Each of these is a Command, stepped once a tick by the command scheduler,
+// so they can be grouped with other commands in a routine. A move that is
+// cancelled stops the drive.
+
+static_assert(MOVE_PERIOD_MS == COMMAND_PERIOD_MS, "moves are stepped once a scheduler tick");
+
+class drivetrain {
+    public:
+        drivetrain(pros::MotorGroup& left, pros::MotorGroup& right, Odometry& odom, Localizer& loc,
+                   MotionEstimator& motion);
+
+        /**
+         * Drives straight by inches (negative is backwards) holding the
+         * current heading. Finishes once the move has settled.
+         */
+        Command move(float inches);
+
+        /**
+         * Turns in place by degrees, clockwise positive. Finishes once the
+         * turn has settled.
+         */
+        Command turn(float degrees);
+
+        /**
+         * Follows a path with pure pursuit. Finishes at its end, or once
+         * timed out. The path has to outlive the command.
+         */
+        Command follow(const Path& path);
+
+        /**
+         * Sets both sides' feedforward voltage for a wheel speed and
+         * acceleration plus extra feedback voltage.
+         */
+        void drive_ff(float vl, float al, float fbl, float vr, float ar, float fbr);
+
+        void stop();
+
+        pros::MotorGroup& groupLeft;
+        pros::MotorGroup& groupRight;
+
+    private:
+        Odometry& odom;
+        Localizer& loc;
+        MotionEstimator& motion;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "matrix.h"
+#include <cmath>
+
+// Pose EKF: wheel odometry prediction, absolute pose corrections.
+//
+// State is (x, y, theta) in the Pose convention (inches, radians, clockwise
+// from +y). predict() takes the distance and heading change the odometry
+// measured over one step; update() takes an absolute fix such as the GPS,
+// weighted by the standard deviation the sensor reports for itself.
+// Header only and free of PROS so it can be replayed on the host.
+
+// PROCESS NOISE
+#define EKF_Q_DIST 0.05f        // in of position sd per inch driven (wheel slip)
+#define EKF_Q_TURN 0.01f        // rad of heading sd per rad turned
+#define EKF_Q_TIME 0.002f       // rad of heading sd per second (gyro drift)
+
+// Chi-square gate for 3 dof at 99.5%, fixes further away than this are dropped
+#define EKF_GATE 12.84f
+
+// After this many rejected fixes in a row the estimate is assumed lost and the
+// next fix is taken regardless of the gate
+#define EKF_MAX_REJECTS 25
+
+class PoseEkf {
+    public:
+        Mat<3, 1> x = Mat<3, 1>::zero();
+        Mat<3, 3> P = Mat<3, 3>::identity();
+        int rejects = 0;
+
+        void reset(float px, float py, float theta, float sd_xy, float sd_theta) {
+            x(0, 0) = px;
+            x(1, 0) = py;
+            x(2, 0) = theta;
+            P = Mat<3, 3>::zero();
+            P(0, 0) = sd_xy * sd_xy;
+            P(1, 1) = sd_xy * sd_xy;
+            P(2, 2) = sd_theta * sd_theta;
+            rejects = 0;
+        }
+
+        /**
+         * Moves the estimate by one odometry step.
+         *
+         * \param ds     signed distance along the mid-step heading, inches
+         * \param dtheta heading change, radians
+         * \param dt     step length, seconds
+         */
+        void predict(float ds, float dtheta, float dt) {
+            float mid = x(2, 0) + dtheta / 2;
+            float s = std::sin(mid);
+            float c = std::cos(mid);
+
+            x(0, 0) += ds * s;
+            x(1, 0) += ds * c;
+            x(2, 0) += dtheta;
+
+            // Jacobian of the motion with respect to the state
+            Mat<3, 3> F = Mat<3, 3>::identity();
+            F(0, 2) = ds * c;
+            F(1, 2) = -ds * s;
+
+            // Noise grows with distance driven, angle turned and time
+            float sd_d = EKF_Q_DIST * std::fabs(ds);
+            float sd_t = EKF_Q_TURN * std::fabs(dtheta) + EKF_Q_TIME * dt;
+
+            Mat<3, 3> Q = Mat<3, 3>::zero();
+            Q(0, 0) = sd_d * sd_d * s * s + 1e-6f;
+            Q(1, 1) = sd_d * sd_d * c * c + 1e-6f;
+            Q(0, 1) = Q(1, 0) = sd_d * sd_d * s * c;
+            Q(2, 2) = sd_t * sd_t;
+
+            P = F * P * F.transpose() + Q;
+        }
+
+        /**
+         * Corrects the estimate with an absolute pose measurement.
+         *
+         * \return false if the fix was rejected by the gate or was unusable
+         */
+        bool update(float zx, float zy, float ztheta, float sd_xy, float sd_theta) {
+            Mat<3, 1> y;
+            y(0, 0) = zx - x(0, 0);
+            y(1, 0) = zy - x(1, 0);
+            y(2, 0) = wrap(ztheta - x(2, 0));
+
+            Mat<3, 3> R = Mat<3, 3>::zero();
+            R(0, 0) = sd_xy * sd_xy;
+            R(1, 1) = sd_xy * sd_xy;
+            R(2, 2) = sd_theta * sd_theta;
+
+            // H is the identity, so S = P + R and K = P S^-1
+            Mat<3, 3> Si;
+            if (!invert(P + R, Si)) {
+                return false;
+            }
+
+            float d2 = (y.transpose() * Si * y)(0, 0);
+            if (d2 > EKF_GATE && rejects < EKF_MAX_REJECTS) {
+                rejects++;
+                return false;
+            }
+            rejects = 0;
+
+            Mat<3, 3> K = P * Si;
+            x = x + K * y;
+
+            // Joseph form keeps P symmetric and positive in float
+            Mat<3, 3> IK = Mat<3, 3>::identity() - K;
+            P = IK * P * IK.transpose() + K * R * K.transpose();
+            return true;
+        }
+
+        // Angle difference folded into -pi..pi
+        static float wrap(float a) {
+            return std::remainder(a, 2 * (float)M_PI);
+        }
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Push Back field geometry seen by the distance sensors.
+//
+// Everything a sensor at mounting height can hit, as line segments in the
+// pose frame (inches from the field center, +y away from the red alliance
+// station). The particle filter scores a reading by how far its end point
+// lands from the nearest segment, so the segments are turned once at startup
+// into a distance transform grid: one byte per half inch cell holding the
+// squared distance to the nearest wall, clamped. (At this size the grid is
+// too much work for the compiler's constexpr evaluator.) The simulator casts
+// its readings against the same segments exactly.
+
+// Inside of the perimeter, 6 tiles of 23.4 in
+#define FIELD_HALF 70.2f
+
+// DISTANCE GRID, covers the field plus a margin past each wall
+#define FIELD_GRID_CELL 0.5f        // inches
+#define FIELD_GRID_ORIGIN -72.0f    // inches, the low edge on both axes
+#define FIELD_GRID_N 289            // cells per side
+
+// Squared distances are stored in quarter square inches and clamp at
+// FIELD_GRID_MAX_IN, past which a reading is just wrong
+#define FIELD_GRID_MAX_IN 7.9f
+#define FIELD_GRID_D2_SCALE 4.0f
+
+struct FieldSegment {
+    float x0, y0, x1, y1;
+};
+
+// The perimeter, then the center goal structure at sensor height. The center
+// goal's footprint is approximate, measure it on the field.
+constexpr FieldSegment FIELD_SEGMENTS[] = {
+    {-FIELD_HALF, -FIELD_HALF, FIELD_HALF, -FIELD_HALF},
+    {FIELD_HALF, -FIELD_HALF, FIELD_HALF, FIELD_HALF},
+    {FIELD_HALF, FIELD_HALF, -FIELD_HALF, FIELD_HALF},
+    {-FIELD_HALF, FIELD_HALF, -FIELD_HALF, -FIELD_HALF},
+
+    {0, -7, 7, 0},
+    {7, 0, 0, 7},
+    {0, 7, -7, 0},
+    {-7, 0, 0, -7},
+};
+
+constexpr int FIELD_SEGMENT_COUNT = sizeof(FIELD_SEGMENTS) / sizeof(FieldSegment);
+
+/**
+ * A weighted sum of every segment's ends, so tables baked from the segments
+ * can check they still match them.
+ */
+constexpr float field_fingerprint() {
+    float f = 0;
+    float w = 1;
+    for (const FieldSegment& s : FIELD_SEGMENTS) {
+        f += w * (s.x0 + 2 * s.y0 + 3 * s.x1 + 4 * s.y1);
+        w += 1;
+    }
+    return f;
+}
+
+/**
+ * Squared distance from a point to a segment.
+ */
+constexpr float segment_d2(const FieldSegment& s, float x, float y) {
+    float dx = s.x1 - s.x0;
+    float dy = s.y1 - s.y0;
+    float t = ((x - s.x0) * dx + (y - s.y0) * dy) / (dx * dx + dy * dy);
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    float ex = s.x0 + t * dx - x;
+    float ey = s.y0 + t * dy - y;
+    return ex * ex + ey * ey;
+}
+
+struct FieldGrid {
+    std::uint8_t d2[FIELD_GRID_N * FIELD_GRID_N];   // row major, y rows
+};
+
+/**
+ * Fills in the distance transform.
+ */
+inline void build_field_grid(FieldGrid& g) {
+    constexpr float max_d2 = FIELD_GRID_MAX_IN * FIELD_GRID_MAX_IN;
+    for (int iy = 0; iy < FIELD_GRID_N; iy++) {
+        for (int ix = 0; ix < FIELD_GRID_N; ix++) {
+            float x = FIELD_GRID_ORIGIN + (ix + 0.5f) * FIELD_GRID_CELL;
+            float y = FIELD_GRID_ORIGIN + (iy + 0.5f) * FIELD_GRID_CELL;
+            float best = max_d2;
+            for (const FieldSegment& s : FIELD_SEGMENTS) {
+                float d2 = segment_d2(s, x, y);
+                best = d2 < best ? d2 : best;
+            }
+            g.d2[iy * FIELD_GRID_N + ix] = (std::uint8_t)(best * FIELD_GRID_D2_SCALE + 0.5f);
+        }
+    }
+}
+
+/**
+ * Distance along a ray to the first segment it hits, or max if none is
+ * closer. Direction is a unit vector.
+ */
+inline float field_raycast(float x, float y, float dx, float dy, float max) {
+    float best = max;
+    for (const FieldSegment& s : FIELD_SEGMENTS) {
+        float sx = s.x1 - s.x0;
+        float sy = s.y1 - s.y0;
+        float den = dx * sy - dy * sx;
+        if (std::fabs(den) < 1e-9f) {
+            continue;
+        }
+        float qx = s.x0 - x;
+        float qy = s.y0 - y;
+        float t = (qx * sy - qy * sx) / den;
+        float u = (qx * dy - qy * dx) / den;
+        if (t >= 0 && t < best && u >= 0 && u <= 1) {
+            best = t;
+        }
+    }
+    return best;
+}
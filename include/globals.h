@@ -1,4 +1,19 @@
 #include "main.h"
+#include "scheduler.h"
+#include "input.h"
+#include "odom.h"
+#include "localizer.h"
+#include "drivetrain.h"
+#include "recorder.h"
+#include "telemetry.h"
+#include "tick_profile.h"
+#include "intake.h"
+#include "power.h"
+#include "devices.h"
+#include "command.h"
+#include "motion.h"
+#include "sysid.h"
+#include "navigator.h"
 
 using namespace pros;
 
@@ -7,6 +22,9 @@ using namespace pros;
 // Master Controller
 extern Controller ct;
 
+// Controller state for the current tick
+extern ControllerSnapshot ctIn;
+
 // LEFT MOTORS
 extern Motor mtL1;
 extern Motor mtL2;
@@ -23,11 +41,64 @@ extern Motor mtIN2;
 extern Motor mtIN3;
 extern Motor mtIN4;
 
+// SENSORS
+extern Imu imu;
+extern Gps gps;
+
 // MOTOR GROUPS
 extern MotorGroup mgL;
 extern MotorGroup mgR;
 extern MotorGroup mgIN;
 
+// DEVICE REGISTRY (port map and hot-plug health)
+extern DeviceRegistry devices;
+
+// INTAKE (jam detecting roller stages)
+extern Intake rollers;
+
+// POWER (shared current and thermal budget)
+extern PowerBudget power;
+
+// CONTROL LOOP SCHEDULER
+extern Scheduler sched;
+
+// MOTOR VELOCITY (timestamped encoder fits)
+extern MotionEstimator motion;
+
+// ODOMETRY
+extern Odometry odom;
+
+// PARTICLE FILTER (distance sensors against the field map)
+extern ParticleLocalizer mcl;
+
+// FUSED POSE (odometry + GPS + particle filter)
+extern Localizer loc;
+
+// DRIVETRAIN (profiled moves and path following)
+extern drivetrain chassis;
+
+// PATH PLANNING (occupancy grid and any-angle planner)
+extern Navigator nav;
+
+// AUTONOMOUS COMMANDS (coroutine scheduler)
+extern CommandScheduler commands;
+
+// DRIVER INPUT RECORDING / REPLAY
+extern InputRecorder recorder;
+
+// TELEMETRY LOG (SD card)
+extern TelemetryLog telem;
+
+// CONTROL TICK STAGE LATENCY
+extern TickProfile tick_prof;
+
 // FUNCTIONS
+
+// Scheduler period of drive(), its output slew is stepped at it
+#define DRIVE_PERIOD_MS 10
+
 extern void drive();
-extern void intake();
\ No newline at end of file
+extern void reset_drive();
+extern void intake();
+extern void movement();
+extern void sysid();
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+
+// Log-linear latency histogram in constant memory.
+//
+// Values below 2^SUB_BITS get a bucket each. Above that every power of two
+// is split into 2^(SUB_BITS-1) equal buckets, so any value is recorded to
+// within 1/2^(SUB_BITS-1) of itself however large it is, from 1 us up to
+// 2^MAX_BITS us. Recording is a count leading zeros and an increment.
+template <int SUB_BITS, int MAX_BITS>
+class HdrHistogram {
+    static_assert(SUB_BITS >= 2 && SUB_BITS < MAX_BITS && MAX_BITS < 32, "bad histogram range");
+
+    public:
+        static constexpr int SUB = 1 << SUB_BITS;
+        static constexpr int HALF = SUB / 2;
+        static constexpr int BUCKETS = SUB + (MAX_BITS - SUB_BITS) * HALF;
+        static constexpr std::uint32_t MAX_VALUE = (1u << MAX_BITS) - 1;
+
+        void record(std::uint32_t v) {
+            if (v > MAX_VALUE) {
+                v = MAX_VALUE;
+            }
+            counts[index(v)]++;
+            n++;
+            if (v > max) {
+                max = v;
+            }
+        }
+
+        void reset() {
+            for (std::uint32_t& c : counts) {
+                c = 0;
+            }
+            n = 0;
+            max = 0;
+        }
+
+        std::uint32_t count() const {
+            return n;
+        }
+
+        std::uint32_t max_value() const {
+            return max;
+        }
+
+        /**
+         * Smallest value that at least a fraction q of the recorded values
+         * are at or below, reported as the top of its bucket (never above
+         * the largest value seen). 0 if nothing was recorded.
+         */
+        std::uint32_t percentile(float q) const {
+            std::uint32_t want = (std::uint32_t)(q * n + 0.5f);
+            if (want == 0) {
+                want = 1;
+            }
+            std::uint32_t seen = 0;
+            for (int i = 0; i < BUCKETS; i++) {
+                seen += counts[i];
+                if (seen >= want && n) {
+                    std::uint32_t top = upper(i);
+                    return top < max ? top : max;
+                }
+            }
+            return max;
+        }
+
+        static constexpr int index(std::uint32_t v) {
+            if (v < (std::uint32_t)SUB) {
+                return v;
+            }
+            int msb = 31 - __builtin_clz(v);
+            int shift = msb - (SUB_BITS - 1);
+            return SUB + (shift - 1) * HALF + (int)((v >> shift) - HALF);
+        }
+
+        // Largest value that lands in bucket i
+        static constexpr std::uint32_t upper(int i) {
+            if (i < SUB) {
+                return i;
+            }
+            int shift = (i - SUB) / HALF + 1;
+            std::uint32_t base = (std::uint32_t)(HALF + (i - SUB) % HALF) << shift;
+            return base + (1u << shift) - 1;
+        }
+
+    private:
+        std::uint32_t counts[BUCKETS] = {};
+        std::uint32_t n = 0;
+        std::uint32_t max = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "main.h"
+#include <cstdint>
+
+// Per-tick controller snapshot.
+//
+// All four axes and twelve buttons are read from the kernel once per control
+// tick. Subsystems then read this struct instead of the Controller, so every
+// loop in a tick sees the same values and pays nothing for the lookups.
+// The getters mirror pros::Controller so call sites only change the object.
+
+// Bit for a button inside the held / pressed / released masks
+#define BTN_BIT(btn) (1u << ((btn) - pros::E_CONTROLLER_DIGITAL_L1))
+
+// L1 through A, POWER is not readable
+#define NUM_BUTTONS 12
+#define NUM_AXES 4
+
+struct ControllerSnapshot {
+    std::int8_t axis[NUM_AXES];     // indexed by controller_analog_e_t
+    std::uint16_t held;             // buttons down this tick
+    std::uint16_t pressed;          // rising edges since the last tick
+    std::uint16_t released;         // falling edges since the last tick
+    std::uint32_t time_ms;          // millis() when the snapshot was taken
+
+    /**
+     * Reads every axis and button from the controller and updates the edges.
+     */
+    void update(pros::Controller& c);
+
+    /**
+     * Loads already-read values and updates the edges against the last tick.
+     */
+    void apply(const std::int8_t* axes, std::uint16_t buttons, std::uint32_t time);
+
+    std::int32_t get_analog(pros::controller_analog_e_t a) const {
+        return axis[a];
+    }
+
+    bool get_digital(pros::controller_digital_e_t btn) const {
+        return held & BTN_BIT(btn);
+    }
+
+    bool get_digital_new_press(pros::controller_digital_e_t btn) const {
+        return pressed & BTN_BIT(btn);
+    }
+
+    bool get_digital_new_release(pros::controller_digital_e_t btn) const {
+        return released & BTN_BIT(btn);
+    }
+};
+
+// Scheduler loop that refreshes the global snapshot, add it before its users
+void read_input();
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "main.h"
+#include "slew.h"
+#include "motion.h"
+#include <atomic>
+#include <cstdint>
+
+// Intake rollers with jam detection.
+//
+// The intake runs as two stages, the main rollers (mgIN with mtIN3 turning
+// against them) and the top roller (mtIN4), each its own state machine in one
+// task that samples the motors every few ms. Driver input only sets the mode
+// a stage should be in; the task turns mode changes, stalls and timeouts into
+// events and is the only thing that writes the motors.
+//
+// A stage is stalled when any of its motors pulls stall current while barely
+// turning, a quarter of free speed, which a loaded roller stays well above.
+// Speeds come from the motion estimator when there is one: the motor's own
+// velocity reading is filtered and takes a few updates to fall to 0. Held
+// for STALL_MS that is a jam: the stage reverses for a short pulse and spins
+// back up, and if that keeps happening it stops for a while instead of
+// sitting at stall current heating the motors.
+//
+// Stage voltages pass through a slew limiter on the way out, so a roller
+// ramps to full (or through a reversal) over a few samples instead of
+// pulling a current spike from a standing start.
+
+#define INTAKE_PERIOD_MS 5
+#define INTAKE_PRIORITY (TASK_PRIORITY_DEFAULT + 2)
+
+#define INTAKE_VOLTAGE 12000        // mV
+#define INTAKE_SLEW_MV_S 240000     // 0 to full in 50 ms, rollers can't tip or slip
+
+// STALL DETECTION
+#define STALL_CURRENT_MA 1800
+#define STALL_SPEED_PCT 25          // of the cartridge's free speed
+#define FREE_COUNTS_S 3000          // raw counts/s at free speed, any cartridge
+#define STALL_MS 30
+#define SPINUP_MS 150               // inrush looks like a stall, ignore it this long
+
+// UNJAM
+#define UNJAM_REVERSE_MS 150
+#define UNJAM_TRIES 3               // jams within UNJAM_WINDOW_MS before giving up
+#define UNJAM_WINDOW_MS 2000
+#define JAM_REST_MS 1000            // stopped after too many jams
+
+// Motors in one stage
+#define INTAKE_STAGE_MOTORS 4
+
+enum IntakeStage : std::uint8_t {
+    INTAKE_MAIN = 0,
+    INTAKE_TOP,
+    INTAKE_STAGES,
+};
+
+enum IntakeMode : std::uint8_t {
+    INTAKE_OFF = 0,
+    INTAKE_FWD,                     // pulling game elements in / up
+    INTAKE_REV,
+};
+
+enum IntakeState : std::uint8_t {
+    ROLLER_IDLE = 0,
+    ROLLER_SPINUP,
+    ROLLER_RUNNING,
+    ROLLER_UNJAM,
+    ROLLER_REST,
+};
+
+struct IntakeStats {
+    std::uint32_t jams;
+    std::uint32_t rests;
+    std::uint32_t last_jam_ms;      // millis() the last jam was detected
+};
+
+class Intake {
+    public:
+        /**
+         * Adds a motor (signed port) to a stage. dir is the sign of the
+         * voltage that turns it forward. Only before start().
+         */
+        bool add(IntakeStage s, std::int8_t port, int dir);
+        void add(IntakeStage s, const pros::MotorGroup& mg, int dir);
+
+        /**
+         * Reads roller speeds from the estimator, which should have the
+         * intake motors added.
+         */
+        void use_motion(const MotionEstimator& m) {
+            motion = &m;
+        }
+
+        void start();
+        void stop();
+
+        /**
+         * Sets the mode a stage should run in. Takes effect on the task's
+         * next sample, safe from any task.
+         */
+        void set(IntakeStage s, IntakeMode m) {
+            stages[s].want = m;
+        }
+
+        /**
+         * Turns every stage off.
+         */
+        void off();
+
+        IntakeState state(IntakeStage s) const {
+            return stages[s].state;
+        }
+
+        /**
+         * Copies a stage's motors (signed ports) and the sign of the voltage
+         * that turns each forward.
+         *
+         * \return how many motors the stage has
+         */
+        int motors(IntakeStage s, std::int8_t* port, std::int8_t* dir) const;
+
+        IntakeStats stats(IntakeStage s) const {
+            return {stages[s].jams, stages[s].rests, stages[s].last_jam_ms};
+        }
+
+    private:
+        enum Event : std::uint8_t {
+            EV_NONE,
+            EV_MODE,                // the wanted mode changed
+            EV_STALL,
+            EV_TIMEOUT,
+        };
+
+        struct Stage {
+            std::int8_t port[INTAKE_STAGE_MOTORS];
+            std::int8_t dir[INTAKE_STAGE_MOTORS];
+            float counts_per_rev[INTAKE_STAGE_MOTORS];  // of the cartridge configured
+            int count = 0;
+
+            std::atomic<IntakeMode> want{INTAKE_OFF};
+            IntakeMode mode = INTAKE_OFF;       // the mode being run
+            std::atomic<IntakeState> state{ROLLER_IDLE};
+            bool timed = false;                 // EV_TIMEOUT at deadline
+            std::uint32_t deadline = 0;
+            std::uint32_t stall_since = 0;      // 0 = not stalled
+
+            int sign = 0;                       // direction the stage is driven
+            std::int32_t written = 0;           // mV last sent to the motors
+
+            std::uint32_t window_start = 0;
+            int tries = 0;
+
+            std::atomic<std::uint32_t> jams{0};
+            std::atomic<std::uint32_t> rests{0};
+            std::atomic<std::uint32_t> last_jam_ms{0};
+        };
+
+        static void task_fn(void* param);
+        void run();
+        Event poll(Stage& s, std::uint32_t now);
+        void handle(Stage& s, Event e, std::uint32_t now);
+        void aim(Stage& s, int sign);
+        void write_outputs();
+        void enter(Stage& s, IntakeState st, std::uint32_t now, std::uint32_t timeout_ms);
+
+        static constexpr SlewConfig<INTAKE_STAGES> SLEW = {
+            .dt = INTAKE_PERIOD_MS / 1000.0f,
+            .ch = {{INTAKE_SLEW_MV_S, 0}, {INTAKE_SLEW_MV_S, 0}},
+        };
+
+        Stage stages[INTAKE_STAGES];
+        const MotionEstimator* motion = nullptr;
+        SlewStage<INTAKE_STAGES, SLEW> slew;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "main.h"
+#include "ekf.h"
+#include "odom.h"
+#include "mcl.h"
+
+// Fused pose: wheel odometry corrected by the GPS sensor and the distance
+// sensor particle filter.
+//
+// Runs its own task behind the odometry. Each step turns the change in the
+// odometry pose into a predict(), every fresh GPS fix into an update()
+// weighted by the sensor's own get_error(), and every fresh particle filter
+// fix into an update() weighted by the particles' spread.
+
+#define LOC_PERIOD_MS 10
+#define LOC_PRIORITY (TASK_PRIORITY_MAX - 3)
+
+// GPS fixes reporting more error than this are not used, meters
+#define GPS_MAX_ERROR 0.05
+// Heading sd assumed for a fix, radians
+#define GPS_THETA_SD 0.035f
+
+// Particle filter fixes spread wider than this are not used, inches
+#define MCL_MAX_SD 6.0f
+// With no GPS fix taken for LOC_GPS_QUIET_MS, this many particle filter
+// fixes rejected in a row means the robot slid where the odometry couldn't
+// see, and the estimate is moved to the filter's
+#define MCL_MAX_REJECTS 10
+#define LOC_GPS_QUIET_MS 1000
+
+#define METERS_TO_INCHES 39.3701f
+
+struct LocalizerStats {
+    std::uint32_t updates;
+    std::uint32_t rejected;
+    std::uint32_t relocalized;  // moved to the particle filter's fix
+    std::uint32_t last_us;      // predict + update time of the last step
+    std::uint32_t max_us;
+};
+
+class Localizer {
+    public:
+        Localizer(Odometry& odom, pros::Gps& gps);
+
+        /**
+         * Also corrects with a particle filter's fixes, before start().
+         */
+        void use_mcl(ParticleLocalizer& m) {
+            mcl = &m;
+        }
+
+        void start();
+        void stop();
+
+        /**
+         * Resets the estimate and the odometry to a known pose.
+         * Coordinates are the GPS field frame: inches from the field center.
+         */
+        void set_pose(float x, float y, float theta);
+
+        Pose get_pose() const {
+            return pose.read();
+        }
+
+        LocalizerStats stats() const {
+            return st;
+        }
+
+    private:
+        static void task_fn(void* param);
+        void run();
+        bool read_gps(float& x, float& y, float& theta, float& sd);
+        bool read_mcl(MclFix& f);
+
+        Odometry& odom;
+        pros::Gps& gps;
+        ParticleLocalizer* mcl = nullptr;
+        PoseEkf ekf;
+
+        SeqLock<Pose> pose;
+        SeqLock<Pose> reset_to;
+        std::atomic<bool> reset_pending{false};
+        LocalizerStats st = {};
+
+        double last_gps_x = 0;
+        double last_gps_y = 0;
+        std::uint32_t last_mcl_ms = 0;
+        std::uint32_t last_gps_ok_ms = 0;
+        int mcl_rejects = 0;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+// Fixed-size matrices for the estimators.
+//
+// Sizes are template parameters so every loop has a compile-time trip count
+// and nothing is ever allocated. Only what the filters need is here: add,
+// subtract, multiply, transpose and a pivoting inverse for small square
+// matrices. Header only and free of PROS so host tools can use it.
+
+template <int R, int C>
+struct Mat {
+    float m[R][C];
+
+    static constexpr Mat zero() {
+        Mat a{};
+        return a;
+    }
+
+    static constexpr Mat identity() {
+        static_assert(R == C, "identity needs a square matrix");
+        Mat a{};
+        for (int i = 0; i < R; i++) {
+            a.m[i][i] = 1;
+        }
+        return a;
+    }
+
+    constexpr float& operator()(int r, int c) {
+        return m[r][c];
+    }
+
+    constexpr float operator()(int r, int c) const {
+        return m[r][c];
+    }
+
+    constexpr Mat operator+(const Mat& b) const {
+        Mat a{};
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                a.m[i][j] = m[i][j] + b.m[i][j];
+        return a;
+    }
+
+    constexpr Mat operator-(const Mat& b) const {
+        Mat a{};
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                a.m[i][j] = m[i][j] - b.m[i][j];
+        return a;
+    }
+
+    constexpr Mat operator*(float s) const {
+        Mat a{};
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                a.m[i][j] = m[i][j] * s;
+        return a;
+    }
+
+    template <int K>
+    constexpr Mat<R, K> operator*(const Mat<C, K>& b) const {
+        Mat<R, K> a{};
+        for (int i = 0; i < R; i++)
+            for (int k = 0; k < C; k++)
+                for (int j = 0; j < K; j++)
+                    a.m[i][j] += m[i][k] * b.m[k][j];
+        return a;
+    }
+
+    constexpr Mat<C, R> transpose() const {
+        Mat<C, R> a{};
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                a.m[j][i] = m[i][j];
+        return a;
+    }
+};
+
+/**
+ * Gauss-Jordan inverse with partial pivoting.
+ *
+ * \return false if the matrix is singular, out is left unchanged
+ */
+template <int N>
+constexpr bool invert(const Mat<N, N>& in, Mat<N, N>& out) {
+    Mat<N, N> a = in;
+    Mat<N, N> inv = Mat<N, N>::identity();
+
+    for (int col = 0; col < N; col++) {
+        int pivot = col;
+        float best = a.m[col][col] < 0 ? -a.m[col][col] : a.m[col][col];
+        for (int r = col + 1; r < N; r++) {
+            float v = a.m[r][col] < 0 ? -a.m[r][col] : a.m[r][col];
+            if (v > best) {
+                best = v;
+                pivot = r;
+            }
+        }
+        if (best < 1e-12f) {
+            return false;
+        }
+
+        if (pivot != col) {
+            for (int j = 0; j < N; j++) {
+                float t = a.m[col][j];
+                a.m[col][j] = a.m[pivot][j];
+                a.m[pivot][j] = t;
+                t = inv.m[col][j];
+                inv.m[col][j] = inv.m[pivot][j];
+                inv.m[pivot][j] = t;
+            }
+        }
+
+        float d = 1 / a.m[col][col];
+        for (int j = 0; j < N; j++) {
+            a.m[col][j] *= d;
+            inv.m[col][j] *= d;
+        }
+
+        for (int r = 0; r < N; r++) {
+            if (r == col) continue;
+            float f = a.m[r][col];
+            for (int j = 0; j < N; j++) {
+                a.m[r][j] -= f * a.m[col][j];
+                inv.m[r][j] -= f * inv.m[col][j];
+            }
+        }
+    }
+
+    out = inv;
+    return true;
+}
+
+static_assert((Mat<2, 2>::identity() * Mat<2, 2>::identity())(1, 1) == 1);
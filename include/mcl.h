@@ -0,0 +1,201 @@
+#pragma once
+
+#include "main.h"
+#include "odom.h"
+#include "field_map.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Monte Carlo localization from distance sensors against the field map.
+//
+// A particle filter that runs beside the wheel odometry. Each particle is a
+// guess at the pose; every period the odometry step moves them all (with
+// noise), and once the robot has moved enough each distance reading scores
+// them by where the reading would end if that guess were right. A reading
+// that ends on a wall scores well. The result is published as a fix with its
+// spread, which the Localizer folds into its EKF like a GPS fix.
+//
+// Particles are kept as structure of arrays and each step is a flat loop
+// over them, so the motion and scoring math vectorizes. A particle's heading
+// is kept as a small offset from the IMU heading, which lets its sine and
+// cosine come from a short polynomial instead of a call per particle. The
+// particle count adapts (KLD sampling): spread out takes up to
+// MCL_MAX_PARTICLES, and once the filter has converged it runs on far fewer.
+// Wheel slip the odometry can't see is recovered from as in augmented MCL.
+
+#define MCL_PERIOD_MS 50
+#define MCL_PRIORITY TASK_PRIORITY_DEFAULT
+
+// PARTICLES
+#define MCL_MAX_PARTICLES 1024
+#define MCL_MIN_PARTICLES 128
+
+// KLD sampling: bin size, and the error bound and its z for 99%
+#define MCL_KLD_BIN_XY 2.0f         // inches
+#define MCL_KLD_BIN_THETA 0.05f     // rad
+#define MCL_KLD_EPSILON 0.05f
+#define MCL_KLD_Z 2.33f
+
+// MOTION NOISE, sd
+#define MCL_NOISE_DIST 0.05f        // in per inch driven
+#define MCL_NOISE_TURN 0.02f        // rad per rad turned
+#define MCL_NOISE_XY 0.05f          // in per period, even standing still
+#define MCL_NOISE_THETA 0.003f      // rad per period
+
+// RECOVERY: when the readings fit the particles much worse lately than
+// they have on average (the robot slid, or was pushed), some particles are
+// scattered wide around the estimate so the filter can find it again
+#define MCL_ALPHA_SLOW 0.02f        // filter on the average fit, per scoring
+#define MCL_ALPHA_FAST 0.3f
+#define MCL_MIN_INJECT 0.15f        // fit this far down before any are
+#define MCL_MAX_INJECT 0.25f        // most of the set replaced in one resample
+#define MCL_RECOVER_SD 10.0f        // in
+#define MCL_RECOVER_THETA_SD 0.05f  // rad
+
+// Readings are only scored after the robot has moved this far since the
+// last scoring, or this long has passed, so a robot standing still doesn't
+// collapse the particles onto one set of readings
+#define MCL_UPDATE_DIST 1.0f        // inches
+#define MCL_UPDATE_TURN 0.05f       // rad
+#define MCL_UPDATE_MS 500
+
+// DISTANCE SENSORS
+#define MCL_RANGE_MIN_MM 20
+#define MCL_RANGE_MAX_MM 2000       // past this the sensor reports 9999 or guesses
+#define MCL_CONFIDENCE_MM 200       // confidence is only reported past this
+#define MCL_MIN_CONFIDENCE 32       // of 63
+#define MCL_SD_NEAR 0.6f            // in, sd of a reading under MCL_CONFIDENCE_MM
+#define MCL_SD_FRACTION 0.05f       // of the reading past it
+#define MCL_SD_MAP 0.5f             // in, for the field not being where the map says
+#define MCL_READING_AGE 0.04f       // s, a reading can be this old when read
+#define MCL_MAX_SENSORS 8
+
+// A fix is never reported tighter than this
+#define MCL_FIX_SD_MIN 2.0f         // in
+#define MCL_FIX_THETA_SD_MIN 0.02f  // rad
+
+struct DistanceMount {
+    std::int8_t port;
+    float forward;                  // in, sensor ahead of the tracking center
+    float right;                    // in, sensor right of it
+    float angle;                    // deg, beam clockwise from straight ahead
+};
+
+struct MclFix {
+    float x;
+    float y;
+    float theta;
+    float sd_xy;
+    float sd_theta;
+    float odom_x;                   // the odometry pose the fix goes with,
+    float odom_y;                   // to carry it forward to a later one
+    float odom_theta;
+    std::uint32_t time_ms;          // 0 until the first scored reading
+};
+
+struct MclStats {
+    std::uint32_t updates;          // periods that scored readings
+    std::uint32_t resamples;
+    std::uint32_t injected;         // recovery particles scattered
+    std::uint32_t particles;        // in use now
+    std::uint32_t readings;         // used in the last scoring
+    std::uint32_t last_us;          // time of the last period's work
+    std::uint32_t max_us;
+};
+
+class ParticleLocalizer {
+    public:
+        template <std::size_t N>
+        ParticleLocalizer(Odometry& odom, const DistanceMount (&mounts)[N]) : odom(odom) {
+            static_assert(N <= MCL_MAX_SENSORS, "more distance sensors than MCL_MAX_SENSORS");
+            sensors.reserve(N);
+            for (const DistanceMount& m : mounts) {
+                add_sensor(m);
+            }
+        }
+
+        /**
+         * Builds the field grid and starts the filter around the current
+         * odometry pose. The odometry should already be running.
+         */
+        void start();
+        void stop();
+
+        /**
+         * Restarts the filter tightly around a known position, in the pose
+         * frame. Headings follow the odometry's, so reset that to match and
+         * pass the number Odometry::set_pose returned, the filter takes up
+         * the odometry again from the first pose carrying it.
+         */
+        void set_pose(float x, float y, std::uint32_t reset_seq);
+
+        MclFix fix() const {
+            return out.read();
+        }
+
+        MclStats stats() const {
+            return st;
+        }
+
+        std::size_t sensor_count() const {
+            return sensors.size();
+        }
+
+        const DistanceMount& mount(std::size_t i) const {
+            return mounts[i];
+        }
+
+    private:
+        struct Reading {
+            float ahead;            // end point in the robot frame, in
+            float right;
+            float inv_2var;         // 1 / 2 sd^2 of the reading, in^-2
+        };
+
+        void add_sensor(const DistanceMount& m);
+        static void task_fn(void* param);
+        void run();
+
+        void seed(float x, float y, float sd_xy, float sd_theta);
+        void motion(float ds, float dtheta, float odom_mid);
+        int read_sensors(Reading* r, float speed);
+        float score(const Reading* r, int count, float odom_theta);
+        void estimate(const Pose& at);
+        void resample(float inject);
+        std::size_t kld_count() const;
+
+        Odometry& odom;
+        std::vector<pros::Distance> sensors;
+        DistanceMount mounts[MCL_MAX_SENSORS] = {};
+
+        // Particles, two sets so resampling can copy from one to the other
+        alignas(16) float px[2][MCL_MAX_PARTICLES];
+        alignas(16) float py[2][MCL_MAX_PARTICLES];
+        alignas(16) float pt[2][MCL_MAX_PARTICLES];     // heading minus the odometry's
+        alignas(16) float w[MCL_MAX_PARTICLES];         // normalized weight
+        alignas(16) float ll[MCL_MAX_PARTICLES];        // log likelihood of this scoring
+        alignas(16) float sn[MCL_MAX_PARTICLES];        // sin and cos of each heading
+        alignas(16) float cs[MCL_MAX_PARTICLES];
+        alignas(16) std::uint32_t cell[MCL_MAX_PARTICLES];
+        int cur = 0;
+        std::size_t n = 0;
+        std::uint32_t rng = 1;
+
+        // Average fit of the readings, slow and fast
+        float fit_slow = 0;
+        float fit_fast = 0;
+        float fit = 0;              // of the last scoring, per reading
+        float est_x = 0;            // last estimate, for recovery particles
+        float est_y = 0;
+        float est_t = 0;
+
+        SeqLock<MclFix> out;
+        SeqLock<Pose> reset_to;
+        std::atomic<bool> reset_pending{false};
+        MclStats st = {};
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Joystick shaping and arcade mixing for the drivetrain.
+//
+// Stick curves are baked into 128-entry tables at compile time, so shaping a
+// stick each tick is one table lookup with no floating point.
+
+// Maps |stick| 0..127 to |output| 0..127.
+//  deadband: readings at or below this are 0, the rest is rescaled so output
+//            still starts at 0 right after the deadband
+//  expo:     0 = linear, 100 = pure cubic, blended as (1-e)x + e*x^3
+constexpr std::array<std::int8_t, 128> make_curve(int deadband, int expo) {
+    std::array<std::int8_t, 128> t{};
+    for (int i = 0; i < 128; i++) {
+        if (i <= deadband) {
+            t[i] = 0;
+            continue;
+        }
+
+        // Stay in integer math scaled by 127 so the table is exact
+        long x = (long)(i - deadband) * 127 / (127 - deadband);
+        long cube = x * x * x / (127 * 127);
+        t[i] = ((100 - expo) * x + expo * cube + 50) / 100;
+    }
+    return t;
+}
+
+template <int DEADBAND, int EXPO>
+struct InputCurve {
+    static_assert(DEADBAND >= 0 && DEADBAND < 127, "deadband must be 0..126");
+    static_assert(EXPO >= 0 && EXPO <= 100, "expo must be 0..100");
+
+    static constexpr std::array<std::int8_t, 128> table = make_curve(DEADBAND, EXPO);
+
+    static constexpr int apply(int v) {
+        if (v > 127) v = 127;
+        if (v < -127) v = -127;
+        return v < 0 ? -table[-v] : table[v];
+    }
+
+    static_assert(apply(127) == 127 && apply(-127) == -127, "curve must reach full scale");
+    static_assert(apply(DEADBAND) == 0, "deadband must read 0");
+};
+
+struct DriveOutput {
+    int left;
+    int right;
+};
+
+/**
+ * Mixes throttle and turn into side outputs.
+ *
+ * If either side would pass ±127 both sides are scaled down by the same
+ * factor, so the ratio between them (the curvature driven) is kept instead of
+ * clipping one side and losing the turn.
+ */
+constexpr DriveOutput arcade_mix(int throttle, int turn) {
+    int l = throttle + turn;
+    int r = throttle - turn;
+
+    int al = l < 0 ? -l : l;
+    int ar = r < 0 ? -r : r;
+    int m = al > ar ? al : ar;
+
+    if (m > 127) {
+        l = l * 127 / m;
+        r = r * 127 / m;
+    }
+    return {l, r};
+}
+
+static_assert(arcade_mix(127, 127).left == 127 && arcade_mix(127, 127).right == 0);
+static_assert(arcade_mix(0, -127).left == -127 && arcade_mix(0, -127).right == 127);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "main.h"
+#include "seqlock.h"
+#include "devices.h"
+#include "velocity_fit.h"
+#include <atomic>
+#include <cstdint>
+
+// Motor velocity and acceleration estimates for the feedback loops.
+//
+// Runs in its own high priority task. Every period it reads each motor's raw
+// count with the device time it was taken, and each new sample goes into
+// that motor's VelocityFit. The fits are published through SeqLocks, and a
+// reader gets the velocity carried forward to its own millis(), so a loop
+// sees each motor where it is now instead of where the motor's own filter
+// had it tens of ms ago.
+//
+// Motors are added to groups (each drive side, the intake) and a group reads
+// as the average of its motors, so a motor that drops out is just left out.
+// Velocities are in raw counts per second, the counts the odometry
+// integrates, which turn at the same rate whatever cartridge is fitted.
+
+#define MOTION_PERIOD_MS 5
+#define MOTION_PRIORITY (TASK_PRIORITY_MAX - 2)
+
+#define MOTION_WINDOW 8             // samples fitted, a motor reports every 10 ms
+#define MOTION_MAX_LEAD_MS 30       // furthest a reading is carried forward
+#define MOTION_MAX_MOTORS 12
+
+enum MotionGroup : std::uint8_t {
+    MOTION_LEFT = 0,
+    MOTION_RIGHT,
+    MOTION_INTAKE,
+    MOTION_GROUPS,
+};
+
+class MotionEstimator {
+    public:
+        /**
+         * Adds a motor (signed port) to a group. Only before start().
+         */
+        bool add(MotionGroup g, std::int8_t port);
+        void add(MotionGroup g, const pros::MotorGroup& mg);
+
+        /**
+         * Restarts a motor's fit whenever the registry sees it come back.
+         */
+        void use_devices(const DeviceRegistry& d) {
+            devices = &d;
+        }
+
+        void start();
+        void stop();
+
+        /**
+         * A motor's velocity (counts/s) carried forward to now and its
+         * acceleration (counts/s^2). time_ms is 0 if it has no estimate.
+         */
+        MotionState motor(std::int8_t port) const;
+
+        /**
+         * Average over the group's motors that have an estimate.
+         */
+        MotionState group(MotionGroup g) const;
+
+    private:
+        struct Channel {
+            std::int8_t port;
+            MotionGroup group;
+            std::uint32_t epoch;
+            VelocityFit<MOTION_WINDOW> fit;
+            SeqLock<MotionState> out;
+        };
+
+        static void task_fn(void* param);
+        void run();
+        MotionState now(const Channel& ch, std::uint32_t t) const;
+
+        static constexpr std::uint32_t RESEED = 0xffffffff;
+
+        Channel channels[MOTION_MAX_MOTORS];
+        int n = 0;
+        const DeviceRegistry* devices = nullptr;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
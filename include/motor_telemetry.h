@@ -0,0 +1,51 @@
+#pragma once
+
+#include "main.h"
+#include <cstdint>
+
+// Batched motor telemetry.
+//
+// The MotorGroup *_all() getters each return a new std::vector, so polling
+// a group at 100 Hz hits the allocator several times per tick. read_telemetry()
+// fills a caller-owned struct-of-arrays for the whole group in one pass with
+// no allocation. Index i of every array is motor i of the group, and values
+// keep the group's sign convention (reversed ports read negated).
+
+// Largest group a single snapshot can hold
+#define TELEM_MAX_MOTORS 8
+
+struct MotorTelemetry {
+    std::uint8_t count;
+    std::int8_t port[TELEM_MAX_MOTORS];
+    float position[TELEM_MAX_MOTORS];       // encoder units, as get_position()
+    float velocity[TELEM_MAX_MOTORS];       // rpm, as get_actual_velocity()
+    std::int32_t current[TELEM_MAX_MOTORS]; // mA
+    std::int32_t voltage[TELEM_MAX_MOTORS]; // mV
+    float temperature[TELEM_MAX_MOTORS];    // degrees C
+    std::uint32_t flags[TELEM_MAX_MOTORS];  // motor_flag_e bits
+    std::uint32_t time_ms;                  // millis() at the start of the read
+};
+
+/**
+ * Caches a group's ports once so later reads never touch the group's vectors.
+ *
+ * \return the number of ports copied, at most TELEM_MAX_MOTORS
+ */
+int telemetry_ports(const pros::MotorGroup& mg, std::int8_t* ports);
+
+/**
+ * Reads every field for the given ports into out.
+ */
+void read_telemetry(const std::int8_t* ports, int count, MotorTelemetry& out);
+
+/**
+ * Reads every field for every motor in mg into out.
+ */
+void read_telemetry(const pros::MotorGroup& mg, MotorTelemetry& out);
+
+/**
+ * Times read_telemetry() against the MotorGroup *_all() getters on mg and
+ * prints the average per-call cost to the terminal. Run it with a terminal
+ * attached, e.g. temporarily from initialize().
+ */
+void bench_telemetry(const pros::MotorGroup& mg, int iterations);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "main.h"
+#include "command.h"
+#include "drivetrain.h"
+#include "localizer.h"
+#include "planner.h"
+#include "routes_baked.h"
+#include "seqlock.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// Planned driving to points on the field.
+//
+// go_to() plans from the fused pose to a goal over the field's occupancy grid
+// (the walls and structures in field_map.h, grown by the robot's radius and
+// PLAN_MARGIN), turns the plan into a Path and follows it with the
+// drivetrain. Obstacles that come and go, like an opponent seen on the way,
+// are discs set with block(). When they change and the rest of the path now
+// runs into one, the follow is cancelled and a new plan starts from where
+// the robot is, leaving the way it faces at the speed it is going. A plan
+// that sets off well away from that, like backing out of an obstacle that
+// turned up close, is turned to in place first; pursuit would loop wide
+// onto it.
+//
+// A leg baked ahead of time (routes_baked.h) is driven as it is, without
+// planning, when the robot sets off from where it starts and nothing is in
+// its way, and planned like any other goal when not. The field's grid comes
+// baked too. Every planner buffer is a member, so a plan allocates nothing.
+// One go_to() at a time, the path is shared.
+
+#define NAV_MAX_OBSTACLES 4
+#define NAV_MAX_REPLANS 8           // per go_to(), then it gives up
+#define NAV_TURN_FIRST 60           // degrees off the robot's heading a path can start
+#define NAV_CLEARANCE 4.0f          // inches past PLAN_MARGIN kept from obstacles
+#define NAV_BAKED_SLACK 2.0f        // inches from a baked leg's start it is still driven
+#define NAV_BAKED_SLACK_DEG 20      // and degrees
+
+struct NavStats {
+    std::uint32_t plans;
+    std::uint32_t baked;            // legs driven as baked, not counted in plans
+    std::uint32_t replans;          // plans made because the path got blocked
+    std::uint32_t failures;         // goal blocked or out of reach
+    std::uint32_t last_us;          // time of the last plan
+    std::uint32_t max_us;
+};
+
+class Navigator {
+    public:
+        Navigator(drivetrain& chassis, Localizer& loc);
+
+        /**
+         * Loads the field's grid from flash. Call once from initialize().
+         */
+        void init();
+
+        /**
+         * Sets obstacle id (0 to NAV_MAX_OBSTACLES - 1) to a disc of radius
+         * inches at (x, y), or clears it. Only one task may set obstacles.
+         */
+        void block(int id, float x, float y, float radius);
+        void unblock(int id);
+
+        /**
+         * Drives to (x, y), arriving at heading degrees (NAN to arrive
+         * however the path does). Finishes there, or at once if no plan
+         * can be found.
+         */
+        Command go_to(float x, float y, float heading = NAN);
+
+        /**
+         * Drives a baked leg, or plans to its goal if the robot isn't at its
+         * start or something is in the way. The leg has to outlive the
+         * command.
+         */
+        Command go_to(const BakedLeg& leg);
+
+        NavStats stats() const {
+            return st;
+        }
+
+    private:
+        struct Obstacles {
+            float x[NAV_MAX_OBSTACLES];
+            float y[NAV_MAX_OBSTACLES];
+            float r[NAV_MAX_OBSTACLES];     // 0 if unused
+        };
+
+        Command drive(const BakedLeg* leg, float x, float y, float heading);
+        bool load_baked(const BakedLeg& leg, const Pose& p);
+        void publish();
+        bool plan(const Pose& from, float x, float y, float heading, float& turn);
+        void build_grid();
+        bool blocked_ahead(const Pose& p);
+
+        drivetrain& chassis;
+        Localizer& loc;
+
+        OccupancyGrid field;            // static, inflated once
+        OccupancyGrid grid;             // field plus the obstacles
+        Planner planner;
+        Waypoint wps[PLAN_MAX_WAYPOINTS];
+        Path path;
+
+        Obstacles staged = {};          // the writer's copy
+        SeqLock<Obstacles> obstacles;
+        std::atomic<std::uint32_t> version{0};
+
+        NavStats st = {};
+};
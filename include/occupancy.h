@@ -0,0 +1,244 @@
+#pragma once
+
+#include "field_map.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Bit-packed occupancy grid over the field, for the path planner.
+//
+// One bit per 2 in cell, rows of y packed into 64 bit words, so the whole
+// field is about 650 bytes and copying or clearing it is a few hundred word
+// stores. Inflating by the robot's radius works a row at a time with word
+// shifts: each row is widened sideways by the disc's half width at every
+// row offset and ORed into the row that far away. Same frame as field_map.h.
+
+#define OCC_CELL 2.0f           // inches
+#define OCC_ORIGIN -72.0f       // inches, the low edge on both axes
+#define OCC_N 72                // cells per side
+#define OCC_WORDS ((OCC_N + 63) / 64)
+
+class OccupancyGrid {
+    public:
+        using Row = std::uint64_t[OCC_WORDS];
+
+        void clear() {
+            std::memset(rows, 0, sizeof rows);
+        }
+
+        /**
+         * Copies in every row, as baked by tools/bake_routes.cpp.
+         */
+        void load(const Row* src) {
+            std::memcpy(rows, src, sizeof rows);
+        }
+
+        const Row* data() const {
+            return rows;
+        }
+
+        /**
+         * Off the grid counts as occupied.
+         */
+        bool occupied(int ix, int iy) const {
+            if (ix < 0 || iy < 0 || ix >= OCC_N || iy >= OCC_N) {
+                return true;
+            }
+            return rows[iy][ix >> 6] >> (ix & 63) & 1;
+        }
+
+        void set(int ix, int iy) {
+            if (ix >= 0 && iy >= 0 && ix < OCC_N && iy < OCC_N) {
+                rows[iy][ix >> 6] |= (std::uint64_t)1 << (ix & 63);
+            }
+        }
+
+        static int cell(float v) {
+            return (int)std::floor((v - OCC_ORIGIN) / OCC_CELL);
+        }
+
+        static float center(int i) {
+            return OCC_ORIGIN + (i + 0.5f) * OCC_CELL;
+        }
+
+        /**
+         * Marks every cell a segment passes through.
+         */
+        void fill_segment(const FieldSegment& s) {
+            float len = std::hypot(s.x1 - s.x0, s.y1 - s.y0);
+            int steps = (int)(len / (OCC_CELL / 4)) + 1;
+            for (int i = 0; i <= steps; i++) {
+                float t = (float)i / steps;
+                set(cell(s.x0 + t * (s.x1 - s.x0)), cell(s.y0 + t * (s.y1 - s.y0)));
+            }
+        }
+
+        /**
+         * Marks the cells whose centers are within r of a point.
+         */
+        void fill_disc(float x, float y, float r) {
+            for (int iy = cell(y - r); iy <= cell(y + r); iy++) {
+                float dy = center(iy) - y;
+                if (iy < 0 || iy >= OCC_N || dy * dy > r * r) {
+                    continue;
+                }
+                float w = std::sqrt(r * r - dy * dy);
+                int x0 = (int)std::ceil((x - w - OCC_ORIGIN) / OCC_CELL - 0.5f);
+                int x1 = (int)std::floor((x + w - OCC_ORIGIN) / OCC_CELL - 0.5f);
+                set_span(rows[iy], x0, x1);
+            }
+        }
+
+        /**
+         * Marks the cells outside a square of half width half, the area past
+         * the field walls.
+         */
+        void fill_outside(float half) {
+            int lo = cell(-half);
+            int hi = cell(half);
+            for (int iy = 0; iy < OCC_N; iy++) {
+                if (iy <= lo || iy >= hi) {
+                    set_span(rows[iy], 0, OCC_N - 1);
+                } else {
+                    set_span(rows[iy], 0, lo);
+                    set_span(rows[iy], hi, OCC_N - 1);
+                }
+            }
+        }
+
+        /**
+         * This grid becomes src grown by r inches in every direction.
+         */
+        void inflate(const OccupancyGrid& src, float r) {
+            const int R = (int)(r / OCC_CELL);
+            clear();
+
+            // Rows widened by each half width the disc has, then ORed into
+            // every row offset with that half width
+            Row wide[OCC_N];
+            int last_w = -1;
+            for (int dy = 0; dy <= R; dy++) {
+                int w = (int)std::sqrt((float)(R * R - dy * dy));
+                if (w != last_w) {
+                    for (int iy = 0; iy < OCC_N; iy++) {
+                        widen(src.rows[iy], w, wide[iy]);
+                    }
+                    last_w = w;
+                }
+                for (int iy = 0; iy < OCC_N; iy++) {
+                    if (iy + dy < OCC_N) {
+                        for (int k = 0; k < OCC_WORDS; k++) rows[iy + dy][k] |= wide[iy][k];
+                    }
+                    if (dy && iy - dy >= 0) {
+                        for (int k = 0; k < OCC_WORDS; k++) rows[iy - dy][k] |= wide[iy][k];
+                    }
+                }
+            }
+        }
+
+        /**
+         * ORs another grid into this one.
+         */
+        void merge(const OccupancyGrid& other) {
+            for (int iy = 0; iy < OCC_N; iy++) {
+                for (int k = 0; k < OCC_WORDS; k++) rows[iy][k] |= other.rows[iy][k];
+            }
+        }
+
+        /**
+         * Whether two free cells are joined by free cells side to side. A
+         * flood fill a whole row of bits at a time, swept up and down the
+         * rows until nothing more is reached.
+         */
+        bool connected(int ax, int ay, int bx, int by) const {
+            if (occupied(ax, ay) || occupied(bx, by)) {
+                return false;
+            }
+            Row reach[OCC_N] = {};
+            reach[ay][ax >> 6] = (std::uint64_t)1 << (ax & 63);
+
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (int pass = 0; pass < 2; pass++) {
+                    for (int i = 0; i < OCC_N; i++) {
+                        int iy = pass ? OCC_N - 1 - i : i;
+                        Row r;
+                        for (int k = 0; k < OCC_WORDS; k++) {
+                            r[k] = reach[iy][k];
+                            if (iy > 0) r[k] |= reach[iy - 1][k];
+                            if (iy + 1 < OCC_N) r[k] |= reach[iy + 1][k];
+                            r[k] &= ~rows[iy][k];
+                        }
+                        // Along the row until the free run is filled
+                        for (bool grew = true; grew;) {
+                            Row w;
+                            widen(r, 1, w);
+                            grew = false;
+                            for (int k = 0; k < OCC_WORDS; k++) {
+                                w[k] &= ~rows[iy][k];
+                                grew = grew || w[k] != r[k];
+                                r[k] = w[k];
+                            }
+                        }
+                        for (int k = 0; k < OCC_WORDS; k++) {
+                            changed = changed || r[k] != reach[iy][k];
+                            reach[iy][k] = r[k];
+                        }
+                    }
+                }
+                if (reach[by][bx >> 6] >> (bx & 63) & 1) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        static constexpr std::uint64_t last_mask() {
+            return OCC_N % 64 ? ((std::uint64_t)1 << (OCC_N % 64)) - 1 : ~(std::uint64_t)0;
+        }
+
+        static void set_span(Row& row, int x0, int x1) {
+            if (x0 < 0) x0 = 0;
+            if (x1 >= OCC_N) x1 = OCC_N - 1;
+            for (int k = 0; k < OCC_WORDS && x0 <= x1; k++) {
+                int lo = k * 64;
+                int a = x0 > lo ? x0 - lo : 0;
+                int b = x1 < lo + 63 ? x1 - lo : 63;
+                if (a > b) continue;
+                std::uint64_t hi_bits = b == 63 ? ~(std::uint64_t)0 : ((std::uint64_t)1 << (b + 1)) - 1;
+                row[k] |= hi_bits & ~(((std::uint64_t)1 << a) - 1);
+            }
+        }
+
+        // out = in spread w cells to each side
+        static void widen(const Row& in, int w, Row& out) {
+            std::memcpy(out, in, sizeof(Row));
+            for (int s = 1; s <= w; s++) {
+                for (int k = 0; k < OCC_WORDS; k++) {
+                    std::uint64_t up = in[k] << s;
+                    std::uint64_t down = in[k] >> s;
+                    if (s < 64) {
+                        if (k > 0) up |= in[k - 1] >> (64 - s);
+                        if (k + 1 < OCC_WORDS) down |= in[k + 1] << (64 - s);
+                    }
+                    out[k] |= up | down;
+                }
+            }
+            out[OCC_WORDS - 1] &= last_mask();
+        }
+
+        Row rows[OCC_N] = {};
+};
+
+/**
+ * The walls and everything in FIELD_SEGMENTS, grown by the robot's radius.
+ */
+inline void build_field_occupancy(OccupancyGrid& out, float robot_radius) {
+    OccupancyGrid raw;
+    raw.fill_outside(FIELD_HALF);
+    for (const FieldSegment& s : FIELD_SEGMENTS) {
+        raw.fill_segment(s);
+    }
+    out.inflate(raw, robot_radius);
+}
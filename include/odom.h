@@ -0,0 +1,115 @@
+#pragma once
+
+#include "main.h"
+#include "pose.h"
+#include "seqlock.h"
+#include "motor_telemetry.h"
+#include "devices.h"
+#include <atomic>
+
+// Wheel + IMU odometry.
+//
+// Runs in its own high priority task. Every period it reads the raw drive
+// encoder counts with their device timestamps and the IMU rotation, and
+// integrates the arc travelled. The pose is published through a SeqLock so
+// any task can read it without ever blocking the integrator.
+//
+// Each side's travel is the average of its motors' own count changes, so a
+// motor that drops out is just left out of the average, and one that comes
+// back with its count restarted is re-seeded instead of read as a jump.
+
+// DRIVE GEOMETRY, measure these on the robot
+#define WHEEL_DIAMETER 3.25         // inches
+#define DRIVE_RATIO (36.0 / 48.0)   // wheel turns per motor turn
+#define TICKS_PER_REV 300.0         // raw counts per motor turn, blue cartridge
+#define TRACK_WIDTH 12.0            // inches, only used if the IMU is missing
+
+#define ODOM_PERIOD_MS 5
+#define ODOM_PRIORITY (TASK_PRIORITY_MAX - 2)
+
+// Inches travelled per raw encoder count
+#define INCHES_PER_TICK (WHEEL_DIAMETER * M_PI * DRIVE_RATIO / TICKS_PER_REV)
+
+class Odometry {
+    public:
+        Odometry(pros::MotorGroup& left, pros::MotorGroup& right, pros::Imu& imu);
+
+        /**
+         * Starts the integrator task from the current pose.
+         * The IMU should already be calibrated.
+         */
+        void start();
+        void stop();
+
+        /**
+         * Skips motors the registry has as unplugged, before start().
+         */
+        void use_devices(const DeviceRegistry& d) {
+            devices = &d;
+        }
+
+        /**
+         * Moves the pose, e.g. to the starting tile before autonomous.
+         * Applied by the integrator on its next step so it stays the only writer.
+         *
+         * \return the reset's number, which every pose published after it
+         * carries in reset_seq. Estimators differencing the pose resync on it,
+         * a pose from before the reset can still be published after this
+         * returns.
+         */
+        std::uint32_t set_pose(float x, float y, float theta);
+
+        Pose get_pose() const {
+            return pose.read();
+        }
+
+        // Distance each side moved and heading change over the last step,
+        // consumed by estimators that build on the wheel odometry
+        struct Step {
+            float left;
+            float right;
+            float dtheta;
+            float dt;
+        };
+        Step last_step() const {
+            return step_out.read();
+        }
+
+    private:
+        static void task_fn(void* param);
+        void run();
+        void read_raw(std::int32_t* now_l, std::int32_t* now_r, std::uint32_t& ts);
+        float side_delta(const std::int8_t* ports, const std::int32_t* now, std::int32_t* last,
+                         std::uint32_t* epoch, int n, int& used);
+        float heading_change(float dl, float dr);
+
+        pros::MotorGroup& left;
+        pros::MotorGroup& right;
+        pros::Imu& imu;
+
+        std::int8_t portsL[TELEM_MAX_MOTORS];
+        std::int8_t portsR[TELEM_MAX_MOTORS];
+        int nL = 0;
+        int nR = 0;
+
+        // Each motor's count at the last step, and the registry epoch it
+        // was seeded in (RESEED to take the next reading as the new start)
+        static constexpr std::uint32_t RESEED = 0xffffffff;
+        std::int32_t lastL[TELEM_MAX_MOTORS];
+        std::int32_t lastR[TELEM_MAX_MOTORS];
+        std::uint32_t epochL[TELEM_MAX_MOTORS];
+        std::uint32_t epochR[TELEM_MAX_MOTORS];
+        const DeviceRegistry* devices = nullptr;
+
+        SeqLock<Pose> pose;
+        SeqLock<Step> step_out;
+        SeqLock<Pose> reset_to;
+        std::atomic<bool> reset_pending{false};
+        std::atomic<std::uint32_t> resets{0};
+
+        float last_imu = 0;
+        bool imu_ok = false;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
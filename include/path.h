@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Precomputed drive paths.
+//
+// Waypoints (position + heading) are joined with cubic Hermite splines and
+// resampled at an even spacing into flat arrays of x, y, heading, curvature
+// and target velocity. Followers walk these arrays forward by index, so the
+// per-tick search only ever looks at a few neighbouring points. Uses the
+// Pose convention: inches, radians clockwise from +y. Header only and free of
+// PROS so paths can also be generated on the host.
+//
+// Paths generated on the host ahead of time (tools/bake_routes.cpp) are kept
+// in flash as PathSamples, the same arrays in 16 bit fixed point, and only
+// scaled back into a Path when driven.
+
+#define PATH_MAX_POINTS 512
+#define PATH_SPACING 1.0f       // inches between samples
+
+// PathSample fixed point, counts per unit
+#define SAMPLE_POS_SCALE 100.0f         // per inch
+#define SAMPLE_ANGLE_SCALE 10000.0f     // per radian
+#define SAMPLE_CURVATURE_SCALE 10000.0f // per 1/in, clamped to about 3.3/in
+#define SAMPLE_VEL_SCALE 100.0f         // per in/s
+
+struct Waypoint {
+    float x;
+    float y;
+    float heading;      // degrees, direction of travel through the point
+};
+
+struct PathLimits {
+    float max_vel;      // in/s
+    float max_accel;    // in/s^2
+    float turn_k;       // cap on speed in curves: v <= turn_k / |curvature|
+    float start_vel = 0;    // in/s already moving at the first point, 0 from rest
+};
+
+struct PathSample {
+    std::int16_t x;
+    std::int16_t y;
+    std::int16_t heading;
+    std::int16_t curvature;
+    std::int16_t vel;
+};
+
+class Path {
+    public:
+        int size = 0;
+        float x[PATH_MAX_POINTS];
+        float y[PATH_MAX_POINTS];
+        float heading[PATH_MAX_POINTS];
+        float curvature[PATH_MAX_POINTS];   // 1/in, positive curving clockwise
+        float vel[PATH_MAX_POINTS];         // target speed at the point, in/s
+
+        /**
+         * Builds the path through the waypoints.
+         *
+         * \return false if there are fewer than two waypoints or the path is
+         * longer than PATH_MAX_POINTS samples (it is truncated)
+         */
+        bool generate(const Waypoint* wps, int count, const PathLimits& lim) {
+            size = 0;
+            if (count < 2) {
+                return false;
+            }
+
+            bool fits = sample_splines(wps, count);
+            compute_curvature();
+            compute_velocity(lim);
+            return fits;
+        }
+
+        /**
+         * Fills the path from baked samples, at most PATH_MAX_POINTS of them.
+         */
+        void load(const PathSample* samples, int count) {
+            size = count < PATH_MAX_POINTS ? count : PATH_MAX_POINTS;
+            for (int i = 0; i < size; i++) {
+                const PathSample& s = samples[i];
+                x[i] = s.x / SAMPLE_POS_SCALE;
+                y[i] = s.y / SAMPLE_POS_SCALE;
+                heading[i] = s.heading / SAMPLE_ANGLE_SCALE;
+                curvature[i] = s.curvature / SAMPLE_CURVATURE_SCALE;
+                vel[i] = s.vel / SAMPLE_VEL_SCALE;
+            }
+        }
+
+        // Rough time to drive the whole path at its target speeds
+        float duration() const {
+            float t = 0;
+            for (int i = 1; i < size; i++) {
+                float v = (vel[i] + vel[i - 1]) / 2;
+                t += PATH_SPACING / (v > 1 ? v : 1);
+            }
+            return t;
+        }
+
+    private:
+        static float deg(float d) {
+            return d * (float)(M_PI / 180.0);
+        }
+
+        // Walks each spline in small parameter steps and drops a sample every
+        // PATH_SPACING inches of arc length
+        bool sample_splines(const Waypoint* wps, int count) {
+            x[0] = wps[0].x;
+            y[0] = wps[0].y;
+            size = 1;
+            float since = 0;
+            float px = wps[0].x, py = wps[0].y;
+
+            for (int k = 0; k + 1 < count; k++) {
+                const Waypoint& a = wps[k];
+                const Waypoint& b = wps[k + 1];
+
+                // Tangents along the headings, scaled to the chord length
+                float chord = std::hypot(b.x - a.x, b.y - a.y);
+                float tax = chord * std::sin(deg(a.heading)), tay = chord * std::cos(deg(a.heading));
+                float tbx = chord * std::sin(deg(b.heading)), tby = chord * std::cos(deg(b.heading));
+
+                const int steps = 200;
+                for (int i = 1; i <= steps; i++) {
+                    float t = (float)i / steps;
+                    float t2 = t * t, t3 = t2 * t;
+                    float h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t;
+                    float h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+                    float cx = h00 * a.x + h10 * tax + h01 * b.x + h11 * tbx;
+                    float cy = h00 * a.y + h10 * tay + h01 * b.y + h11 * tby;
+
+                    since += std::hypot(cx - px, cy - py);
+                    px = cx;
+                    py = cy;
+
+                    bool last = k + 2 == count && i == steps;
+                    if (since >= PATH_SPACING || last) {
+                        if (size == PATH_MAX_POINTS) {
+                            return false;
+                        }
+                        x[size] = cx;
+                        y[size] = cy;
+                        size++;
+                        since = 0;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Heading from neighbouring samples, curvature from the circle
+        // through each point and its two neighbours
+        void compute_curvature() {
+            for (int i = 0; i < size; i++) {
+                int a = i > 0 ? i - 1 : i;
+                int b = i + 1 < size ? i + 1 : i;
+                heading[i] = std::atan2(x[b] - x[a], y[b] - y[a]);
+
+                if (i == 0 || i + 1 == size) {
+                    curvature[i] = 0;
+                    continue;
+                }
+
+                float ax = x[i] - x[a], ay = y[i] - y[a];
+                float bx = x[b] - x[i], by = y[b] - y[i];
+                float cx = x[b] - x[a], cy = y[b] - y[a];
+                float cross = ax * by - ay * bx;
+                float den = std::hypot(ax, ay) * std::hypot(bx, by) * std::hypot(cx, cy);
+
+                // Negated so turning clockwise (to the right) is positive
+                curvature[i] = den > 1e-6f ? -2 * cross / den : 0;
+            }
+        }
+
+        // Speed limited by the curve, then by what can be reached accelerating
+        // from the start and braking into the end
+        void compute_velocity(const PathLimits& lim) {
+            for (int i = 0; i < size; i++) {
+                float k = std::fabs(curvature[i]);
+                float v = lim.max_vel;
+                if (k > 1e-6f && lim.turn_k / k < v) {
+                    v = lim.turn_k / k;
+                }
+                vel[i] = v;
+            }
+
+            vel[size - 1] = 0;
+            for (int i = size - 2; i >= 0; i--) {
+                float v = std::sqrt(vel[i + 1] * vel[i + 1] + 2 * lim.max_accel * PATH_SPACING);
+                if (v < vel[i]) vel[i] = v;
+            }
+
+            // Starting from rest, but never 0 or the robot would never leave
+            float v0 = std::sqrt(2 * lim.max_accel * PATH_SPACING);
+            if (lim.start_vel > v0) v0 = lim.start_vel;
+            if (v0 < vel[0]) vel[0] = v0;
+            for (int i = 1; i < size; i++) {
+                float v = std::sqrt(vel[i - 1] * vel[i - 1] + 2 * lim.max_accel * PATH_SPACING);
+                if (v < vel[i]) vel[i] = v;
+            }
+        }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+// Compile-time PID and feedforward.
+//
+// Gains, loop period and filter settings are template parameters, so every
+// product of constants is folded by the compiler and terms with a zero gain
+// are dropped entirely. An update is a handful of multiplies and clamps with
+// no allocation.
+//
+//   constexpr PidGains LIFT = {.kp = 300, .ki = 50, .dt = 0.01f};
+//   Pid<LIFT> lift;
+//   float mv = lift.update(target, measured);
+//
+// RuntimePid is the same controller, through the same pid_step, with the
+// gains held at run time, for tools that try many gains on the host
+// (tools/tune_gains.cpp). The robot uses Pid.
+
+struct PidGains {
+    float kp = 0;
+    float ki = 0;
+    float kd = 0;
+    float dt = 0.01f;       // loop period, s
+    float i_max = 0;        // clamp on the integral term's output, 0 = out_max
+    float d_alpha = 1;      // derivative low-pass weight per tick, 1 = unfiltered
+    float out_max = 12000;  // output clamp
+};
+
+struct FfGains {
+    float ks = 0;           // static friction, applied with the sign of v
+    float kv = 0;           // per unit velocity
+    float ka = 0;           // per unit acceleration
+};
+
+// What a PID carries from one update to the next
+struct PidState {
+    float integral = 0;
+    float d_filt = 0;
+    float prev = 0;
+    bool primed = false;    // prev holds a measurement
+};
+
+constexpr float pid_clamp(float v, float lim) {
+    return v > lim ? lim : v < -lim ? -lim : v;
+}
+
+/**
+ * One loop step, the one both Pid and RuntimePid run. The derivative acts on
+ * the measurement, not the error, so setpoint steps don't kick the output,
+ * and is 0 on the first step after construction or reset(), which has no
+ * measurement to difference against. Inlined into Pid with its constant gains, the products fold and the terms
+ * with a zero gain drop out.
+ */
+constexpr float pid_step(const PidGains& g, PidState& s, float setpoint, float measurement) {
+    float err = setpoint - measurement;
+    float out = g.kp * err;
+
+    if (g.ki != 0) {
+        // Integral kept in output units and clamped, so it can never wind up
+        // past what it is allowed to contribute
+        float lim = g.i_max > 0 ? g.i_max : g.out_max;
+        s.integral = pid_clamp(s.integral + (g.ki * g.dt) * err, lim);
+        out += s.integral;
+    }
+
+    if (g.kd != 0) {
+        float d = s.primed ? (s.prev - measurement) * (g.kd / g.dt) : 0;
+        if (g.d_alpha < 1) {
+            s.d_filt += g.d_alpha * (d - s.d_filt);
+            d = s.d_filt;
+        }
+        out += d;
+    }
+    s.prev = measurement;
+    s.primed = true;
+
+    return pid_clamp(out, g.out_max);
+}
+
+template <PidGains G>
+class Pid {
+    static_assert(G.dt > 0, "loop period must be positive");
+    static_assert(G.d_alpha > 0 && G.d_alpha <= 1, "d_alpha must be in (0, 1]");
+    static_assert(G.out_max > 0, "out_max must be positive");
+
+    public:
+        /** One loop step, see pid_step */
+        float update(float setpoint, float measurement) {
+            return pid_step(G, state, setpoint, measurement);
+        }
+
+        /**
+         * Clears the integral and filter. The next update starts the
+         * derivative from its measurement.
+         */
+        void reset() {
+            state = {};
+        }
+
+        /**
+         * Clears the integral and filter, starting from a measurement.
+         */
+        void reset(float measurement) {
+            state = {0, 0, measurement, true};
+        }
+
+    private:
+        PidState state;
+};
+
+class RuntimePid {
+    public:
+        explicit RuntimePid(const PidGains& g) : g(g) {}
+
+        /** As Pid::update */
+        float update(float setpoint, float measurement) {
+            return pid_step(g, state, setpoint, measurement);
+        }
+
+        /** As Pid::reset */
+        void reset() {
+            state = {};
+        }
+
+        /** As Pid::reset */
+        void reset(float measurement) {
+            state = {0, 0, measurement, true};
+        }
+
+    private:
+        PidGains g;
+        PidState state;
+};
+
+template <FfGains G>
+struct Feedforward {
+    static constexpr float calc(float vel, float acc) {
+        float out = G.kv * vel;
+        if constexpr (G.ks != 0) {
+            out += G.ks * (float)((vel > 0) - (vel < 0));
+        }
+        if constexpr (G.ka != 0) {
+            out += G.ka * acc;
+        }
+        return out;
+    }
+};
@@ -0,0 +1,419 @@
+#pragma once
+
+#include "occupancy.h"
+#include "path.h"
+#include <cmath>
+#include <cstdint>
+
+// Any-angle path planner over an OccupancyGrid.
+//
+// Lazy Theta*: an A* search on the 8-connected grid where a cell's parent can
+// be any cell it can see, not just a neighbour, so a plan comes out as a few
+// straight legs between obstacle corners instead of a staircase. Line of
+// sight is only checked when a cell is taken off the open list, once per
+// expanded cell. Every buffer the search needs (costs, parents, the binary
+// heap and its index) is part of the Planner, sized for the whole grid, and
+// cells are reset lazily by a generation stamp, so a plan allocates nothing
+// and clears nothing up front.
+//
+// The grid is expected to be inflated by the robot's radius already. A robot
+// that starts inside an obstacle's margin first heads straight for the
+// nearest free cell, within PLAN_ESCAPE of it, and plans on from there. The
+// legs are turned into Waypoints for Path::generate, which joins them with
+// splines: corners get the heading halfway between their legs, and long legs
+// are split so the spline can't bow far from the line. A goal with a heading
+// is planned to a point PLAN_APPROACH behind it when that line is clear and
+// the plan doesn't double back into it, so the robot comes in straight
+// instead of hooking round at the end.
+
+// Grids are inflated by the radius plus the margin, the margin is room for
+// the splines and the follower to stray
+#define PLAN_ROBOT_RADIUS 9.0f      // inches, half the robot's width
+#define PLAN_MARGIN 2.0f            // inches
+
+#define PLAN_MAX_CORNERS 32         // legs of a plan, longer plans fail
+#define PLAN_MAX_WAYPOINTS 64       // after splitting long legs
+#define PLAN_MAX_LEG 24.0f          // inches between waypoints
+#define PLAN_ESCAPE 12.0f           // inches, furthest a start is moved to a free cell
+#define PLAN_TURN_K 30.0f           // PathLimits::turn_k for planned paths
+#define PLAN_APPROACH 30.0f         // inches of straight line into a goal heading
+#define PLAN_APPROACH_TURN 120.0f   // degrees, sharpest turn onto that line
+
+/**
+ * A leg planned and generated on the host ahead of time, see
+ * tools/bake_routes.cpp. It starts from rest at the start pose.
+ */
+struct BakedLeg {
+    float start_x;
+    float start_y;
+    float start_heading;            // degrees
+    float goal_x;
+    float goal_y;
+    float goal_heading;             // degrees, NAN for however the path arrives
+    const Waypoint* wps;            // the plan, to regenerate with other limits
+    int wp_count;
+    const PathSample* samples;      // the path generated from it
+    int size;
+};
+
+class Planner {
+    public:
+        /**
+         * Plans from (sx, sy) to (gx, gy) in field inches and writes the
+         * waypoints to out, ending at heading goal_deg (NAN to arrive along
+         * the last leg). Returns the waypoint count, 0 if the goal is
+         * blocked or out of reach.
+         */
+        int plan(const OccupancyGrid& grid, float sx, float sy, float gx, float gy, float goal_deg, Waypoint* out,
+                 int max) {
+            // The approach point, if the goal has a heading, isn't close and
+            // the way in is clear
+            float ax = gx;
+            float ay = gy;
+            bool approach = false;
+            if (!std::isnan(goal_deg) && std::hypot(gx - sx, gy - sy) > 2 * PLAN_APPROACH) {
+                float h = goal_deg * (float)(M_PI / 180);
+                ax = gx - PLAN_APPROACH * std::sin(h);
+                ay = gy - PLAN_APPROACH * std::cos(h);
+                int a = OccupancyGrid::cell(ay) * OCC_N + OccupancyGrid::cell(ax);
+                int g = OccupancyGrid::cell(gy) * OCC_N + OccupancyGrid::cell(gx);
+                approach = !grid.occupied(OccupancyGrid::cell(ax), OccupancyGrid::cell(ay)) &&
+                           !grid.occupied(OccupancyGrid::cell(gx), OccupancyGrid::cell(gy)) && line_of_sight(grid, a, g);
+                if (!approach) {
+                    ax = gx;
+                    ay = gy;
+                }
+            }
+
+            int corners = search(grid, OccupancyGrid::cell(sx), OccupancyGrid::cell(sy), OccupancyGrid::cell(ax),
+                                 OccupancyGrid::cell(ay));
+
+            // Not if the way there doubles back into it, pursuit can't turn
+            // that sharply; straight to the goal instead
+            if (approach && corners >= 2) {
+                int before = path_cells[corners - 2];
+                float bx = corners > 2 ? OccupancyGrid::center(before % OCC_N) : sx;
+                float by = corners > 2 ? OccupancyGrid::center(before / OCC_N) : sy;
+                float in = std::atan2(ax - bx, ay - by);
+                float turn = std::remainder(in - goal_deg * (float)(M_PI / 180), 2 * (float)M_PI);
+                if (std::fabs(turn) > PLAN_APPROACH_TURN * (float)(M_PI / 180)) {
+                    approach = false;
+                    ax = gx;
+                    ay = gy;
+                    corners = search(grid, OccupancyGrid::cell(sx), OccupancyGrid::cell(sy), OccupancyGrid::cell(gx),
+                                     OccupancyGrid::cell(gy));
+                }
+            }
+            if (corners == 0) {
+                return 0;
+            }
+
+            // Corner cells to field points, the ends where they really are
+            float px[PLAN_MAX_CORNERS];
+            float py[PLAN_MAX_CORNERS];
+            for (int i = 0; i < corners; i++) {
+                px[i] = OccupancyGrid::center(path_cells[i] % OCC_N);
+                py[i] = OccupancyGrid::center(path_cells[i] / OCC_N);
+            }
+            px[0] = sx;
+            py[0] = sy;
+            if (corners == 1) {
+                corners = 2;    // same cell, one short leg
+            }
+            px[corners - 1] = ax;
+            py[corners - 1] = ay;
+            if (approach) {
+                if (corners == PLAN_MAX_CORNERS) return 0;
+                px[corners] = gx;
+                py[corners] = gy;
+                corners++;
+            }
+
+            // Long legs split evenly, every point heading along its leg for now
+            int n = 0;
+            for (int i = 0; i + 1 < corners; i++) {
+                float dx = px[i + 1] - px[i];
+                float dy = py[i + 1] - py[i];
+                int parts = (int)(std::hypot(dx, dy) / PLAN_MAX_LEG) + 1;
+                float heading = std::atan2(dx, dy) * (float)(180 / M_PI);
+                for (int k = 0; k < parts; k++) {
+                    if (n == max) return 0;
+                    out[n++] = {px[i] + dx * k / parts, py[i] + dy * k / parts, heading};
+                }
+            }
+            if (n == max) return 0;
+            out[n] = {gx, gy, std::isnan(goal_deg) ? out[n - 1].heading : goal_deg};
+            n++;
+
+            // Corners head between their legs
+            for (int i = 1; i + 1 < n; i++) {
+                float a = out[i - 1].heading * (float)(M_PI / 180);
+                float b = out[i].heading * (float)(M_PI / 180);
+                float mid = std::atan2(std::sin(a) + std::sin(b), std::cos(a) + std::cos(b));
+                out[i].heading = mid * (float)(180 / M_PI);
+            }
+            return n;
+        }
+
+        /**
+         * Cells expanded by the last plan.
+         */
+        int expanded() const {
+            return expansions;
+        }
+
+    private:
+        static constexpr int CELLS = OCC_N * OCC_N;
+        static constexpr std::int16_t NONE = -1;
+        static constexpr std::int16_t CLOSED = -2;
+
+        static_assert(CELLS <= 32767, "cell indices are 16 bit");
+
+        // Grid cells of the plan from start to goal, corners only. Returns
+        // their count, 0 for no plan.
+        int search(const OccupancyGrid& grid, int sx, int sy, int gx, int gy) {
+            if (sx < 0 || sy < 0 || sx >= OCC_N || sy >= OCC_N || grid.occupied(gx, gy)) {
+                return 0;
+            }
+            const int from = sy * OCC_N + sx;
+            if (grid.occupied(sx, sy) && !escape(grid, sx, sy)) {
+                return 0;
+            }
+            if (!grid.connected(sx, sy, gx, gy)) {
+                return 0;   // or the search would expand everything it can reach
+            }
+            if (++gen == 0) {
+                // Stamps wrapped, every old one has to go
+                for (std::uint16_t& s : stamp) s = 0;
+                gen = 1;
+            }
+
+            const int start = sy * OCC_N + sx;
+            const int goal = gy * OCC_N + gx;
+            heap_size = 0;
+            expansions = 0;
+            visit(start);
+            g[start] = 0;
+            parent[start] = start;
+            push(start, h(start, goal));
+
+            while (heap_size > 0) {
+                int s = pop();
+                pos[s] = CLOSED;
+                expansions++;
+
+                // The lazy part: the parent was assumed visible when s was
+                // reached, and if it isn't the best closed neighbour takes over
+                if (s != start && !adjacent(parent[s], s) && !line_of_sight(grid, parent[s], s)) {
+                    float best = INFINITY;
+                    for_neighbours(s, [&](int n, float step) {
+                        if (stamp[n] == gen && pos[n] == CLOSED && g[n] + step < best && step_ok(grid, n, s)) {
+                            best = g[n] + step;
+                            parent[s] = n;
+                        }
+                    });
+                    g[s] = best;
+                }
+
+                if (s == goal) {
+                    return trace(from, start, goal);
+                }
+
+                const int p = parent[s];
+                for_neighbours(s, [&](int n, float) {
+                    if (!step_ok(grid, s, n)) {
+                        return;
+                    }
+                    if (stamp[n] != gen) {
+                        visit(n);
+                    } else if (pos[n] == CLOSED) {
+                        return;
+                    }
+                    float cost = g[p] + dist(p, n);
+                    if (cost < g[n]) {
+                        g[n] = cost;
+                        parent[n] = p;
+                        push(n, cost + h(n, goal));
+                    }
+                });
+            }
+            return 0;
+        }
+
+        // Whether one step between neighbouring cells is allowed. Diagonals
+        // can't cut a blocked corner.
+        static bool step_ok(const OccupancyGrid& grid, int from, int to) {
+            const int x = from % OCC_N, y = from / OCC_N;
+            const int nx = to % OCC_N, ny = to / OCC_N;
+            return !grid.occupied(nx, ny) && (nx == x || ny == y || (!grid.occupied(nx, y) && !grid.occupied(x, ny)));
+        }
+
+        // Moves an occupied start to the nearest free cell within PLAN_ESCAPE
+        static bool escape(const OccupancyGrid& grid, int& sx, int& sy) {
+            constexpr int R = (int)(PLAN_ESCAPE / OCC_CELL);
+            int best = R * R + 1;
+            int bx = sx, by = sy;
+            for (int dy = -R; dy <= R; dy++) {
+                for (int dx = -R; dx <= R; dx++) {
+                    int d = dx * dx + dy * dy;
+                    if (d < best && !grid.occupied(sx + dx, sy + dy)) {
+                        best = d;
+                        bx = sx + dx;
+                        by = sy + dy;
+                    }
+                }
+            }
+            if (best > R * R) {
+                return false;
+            }
+            sx = bx;
+            sy = by;
+            return true;
+        }
+
+        // Calls f(cell, step length) for each neighbour on the grid
+        template <typename F>
+        static void for_neighbours(int s, F f) {
+            const int x = s % OCC_N;
+            const int y = s / OCC_N;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if ((dx || dy) && nx >= 0 && ny >= 0 && nx < OCC_N && ny < OCC_N) {
+                        f(ny * OCC_N + nx, dx && dy ? (float)M_SQRT2 : 1.0f);
+                    }
+                }
+            }
+        }
+
+        // Whether the line between two cell centers stays clear of every
+        // cell it touches
+        static bool line_of_sight(const OccupancyGrid& grid, int a, int b) {
+            int x = a % OCC_N, y = a / OCC_N;
+            const int bx = b % OCC_N, by = b / OCC_N;
+            const int nx = std::abs(bx - x), ny = std::abs(by - y);
+            const int sx = bx > x ? 1 : -1, sy = by > y ? 1 : -1;
+
+            for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+                int d = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+                if (d == 0) {
+                    // Through a corner exactly, both cells beside it count
+                    if (grid.occupied(x + sx, y) || grid.occupied(x, y + sy)) return false;
+                    x += sx;
+                    y += sy;
+                    ix++;
+                    iy++;
+                } else if (d < 0) {
+                    x += sx;
+                    ix++;
+                } else {
+                    y += sy;
+                    iy++;
+                }
+                if (grid.occupied(x, y)) return false;
+            }
+            return true;
+        }
+
+        // Parents back from the goal, reversed into path_cells, from the
+        // cell the robot is really in if it had to escape
+        int trace(int from, int start, int goal) {
+            int n = 0;
+            for (int c = goal;; c = parent[c]) {
+                if (n == PLAN_MAX_CORNERS) return 0;
+                path_cells[n++] = (std::int16_t)c;
+                if (c == start) break;
+            }
+            if (from != start) {
+                if (n == PLAN_MAX_CORNERS) return 0;
+                path_cells[n++] = (std::int16_t)from;
+            }
+            for (int i = 0; i < n / 2; i++) {
+                std::int16_t t = path_cells[i];
+                path_cells[i] = path_cells[n - 1 - i];
+                path_cells[n - 1 - i] = t;
+            }
+            return n;
+        }
+
+        static bool adjacent(int a, int b) {
+            return std::abs(a % OCC_N - b % OCC_N) <= 1 && std::abs(a / OCC_N - b / OCC_N) <= 1;
+        }
+
+        static float dist(int a, int b) {
+            float dx = (float)(a % OCC_N - b % OCC_N);
+            float dy = (float)(a / OCC_N - b / OCC_N);
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        static float h(int a, int goal) {
+            return dist(a, goal);
+        }
+
+        void visit(int c) {
+            stamp[c] = gen;
+            g[c] = INFINITY;
+            pos[c] = NONE;
+        }
+
+        // BINARY HEAP on f, pos[] tracks where each cell sits so a cheaper
+        // path moves it up in place
+
+        void push(int c, float key) {
+            f[c] = key;
+            int i = pos[c];
+            if (i < 0) {
+                i = heap_size++;
+                heap[i] = (std::int16_t)c;
+            }
+            up(i);
+        }
+
+        int pop() {
+            int top = heap[0];
+            heap[0] = heap[--heap_size];
+            pos[heap[0]] = 0;
+            if (heap_size > 0) down(0);
+            return top;
+        }
+
+        void up(int i) {
+            std::int16_t c = heap[i];
+            while (i > 0) {
+                int p = (i - 1) / 2;
+                if (f[heap[p]] <= f[c]) break;
+                heap[i] = heap[p];
+                pos[heap[i]] = (std::int16_t)i;
+                i = p;
+            }
+            heap[i] = c;
+            pos[c] = (std::int16_t)i;
+        }
+
+        void down(int i) {
+            std::int16_t c = heap[i];
+            for (;;) {
+                int l = 2 * i + 1;
+                if (l >= heap_size) break;
+                int m = l + 1 < heap_size && f[heap[l + 1]] < f[heap[l]] ? l + 1 : l;
+                if (f[c] <= f[heap[m]]) break;
+                heap[i] = heap[m];
+                pos[heap[i]] = (std::int16_t)i;
+                i = m;
+            }
+            heap[i] = c;
+            pos[c] = (std::int16_t)i;
+        }
+
+        float g[CELLS];
+        float f[CELLS];
+        std::int16_t parent[CELLS];
+        std::int16_t pos[CELLS];            // heap index, NONE or CLOSED
+        std::int16_t heap[CELLS];
+        std::uint16_t stamp[CELLS] = {};
+        std::uint16_t gen = 0;
+        int heap_size = 0;
+        int expansions = 0;
+        std::int16_t path_cells[PLAN_MAX_CORNERS];
+};
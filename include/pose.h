@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Robot pose on the field.
+//
+// Inches for distance and radians for angles. theta follows the IMU / GPS
+// heading convention: 0 faces +y and it grows clockwise, so moving forward a
+// distance d goes (d sin(theta), d cos(theta)).
+struct Pose {
+    float x;
+    float y;
+    float theta;
+    float v;            // forward speed, in/s
+    float omega;        // turn rate, rad/s, clockwise positive
+    std::uint32_t time_ms;
+    std::uint32_t reset_seq;    // Odometry::set_pose resets applied, see there
+};
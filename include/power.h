@@ -0,0 +1,162 @@
+#pragma once
+
+#include "main.h"
+#include "intake.h"
+#include <atomic>
+#include <cstdint>
+
+// Shared current and thermal budget for every motor.
+//
+// The brain shares about 20 A between all its motors, and ten motors at their
+// 2.5 A default limit can ask for 25. Past that the brain drops every motor
+// at once and the battery sags toward a brownout, so pushing and a loaded
+// intake together lose force from both. This task samples every motor's
+// current and temperature, predicts each one's draw a little ahead and
+// hands out current limits so the total stays inside the budget, filling the
+// group that matters right now first:
+//
+//   pushing   drive motors loaded near stall, the drive gets what it asks for
+//   cycling   an intake stage running, the intake gets what it asks for
+//   balanced  both get what they ask for in proportion
+//
+// Every motor keeps a floor so nothing stops outright. Limits are winding
+// current, which is never less than what the motor pulls from the battery.
+//
+// Temperature is reported in 5 C steps, so each motor also carries a small
+// thermal model run off its current and kept inside the step it reports.
+// Past POWER_SOFT_C its current and voltage limits come down smoothly, so it
+// settles below the 55 C where the firmware halves its current late in a
+// match instead of hitting it and losing half its force at once.
+
+#define POWER_PERIOD_MS 20
+#define POWER_PRIORITY (TASK_PRIORITY_DEFAULT + 1)
+
+// BUDGET (mA of winding current)
+#define POWER_BUDGET_MA 20000
+#define POWER_MOTOR_MAX_MA 2500
+#define POWER_MIN_MA 500            // floor every motor keeps
+#define POWER_HEADROOM_MA 300       // over the prediction, so a motor can ramp up
+#define POWER_WRITE_STEP_MA 100     // limits are sent in whole steps of this
+
+// PREDICTION
+#define POWER_FILTER 0.5f           // current low pass per sample
+#define POWER_HORIZON_MS 60         // how far ahead a rising draw is extrapolated
+
+// MODES
+#define PUSH_CURRENT_MA 1500        // average drive current ...
+#define PUSH_SPEED_PCT 30           // ... under this % of free speed is pushing
+#define POWER_MODE_HOLD_MS 300      // a new mode holds at least this long
+
+// THERMAL (rough figures for the 11 W motor)
+#define POWER_SOFT_C 51             // derating starts
+#define POWER_HARD_C 54             // fully derated, under the firmware's 55
+#define POWER_HOT_PCT 60            // of full current left when fully derated
+#define POWER_WINDING_OHM 4.8f
+#define POWER_HEAT_CAP 60           // J/C
+#define POWER_HEAT_RES 2            // C/W to the air
+#define POWER_TEMP_STEP 5           // C, resolution of the reported temperature
+#define POWER_AMBIENT_C 25          // assumed for a motor that can't report one
+
+// Motors under the budget
+#define POWER_MAX_MOTORS 12
+
+enum PowerGroup : std::uint8_t {
+    POWER_DRIVE = 0,
+    POWER_INTAKE,
+    POWER_GROUPS,
+};
+
+enum PowerMode : std::uint8_t {
+    POWER_BALANCED = 0,
+    POWER_PUSHING,
+    POWER_CYCLING,
+};
+
+struct PowerStats {
+    PowerMode mode;
+    std::int32_t draw_ma;           // measured, all motors
+    std::int32_t peak_ma;
+    std::uint32_t short_samples;    // predicted demand was over the budget
+    float hottest_c;                // estimated, hottest motor
+};
+
+class PowerBudget {
+    public:
+        PowerBudget(Intake& rollers);
+
+        /**
+         * Adds a motor (signed port) to a group. Only before start().
+         */
+        bool add(PowerGroup g, std::int8_t port);
+        void add(PowerGroup g, const pros::MotorGroup& mg);
+
+        void start();
+
+        /**
+         * Stops the task and puts back the limits the motors had at start().
+         */
+        void stop();
+
+        PowerStats stats() const;
+
+        int count() const {
+            return n;
+        }
+
+        /**
+         * Current limit (mA) and estimated temperature (C) of motor i, in the
+         * order added.
+         */
+        std::int32_t limit(int i) const {
+            return motors[i].limit;
+        }
+
+        float temp(int i) const {
+            return motors[i].temp_est;
+        }
+
+    private:
+        struct Budgeted {
+            std::int8_t port;
+            PowerGroup group;
+            float free_rpm;
+            std::int32_t old_current_limit;
+            std::int32_t old_voltage_limit;
+
+            float filt_ma = 0;
+            float rpm = 0;
+            float ambient = POWER_AMBIENT_C;    // C, what it read at start()
+            bool ambient_read = false;          // or assumed, it was unplugged
+            std::atomic<float> temp_est{0};
+            float demand = 0;       // mA it should get, capped for heat
+            float cap = 0;          // most it may get at this temperature
+            float alloc = 0;
+            std::atomic<std::int32_t> limit{POWER_MOTOR_MAX_MA};
+            std::int32_t voltage = 0;          // mV limit wanted, 0 = none
+            std::int32_t voltage_set = 0;
+        };
+
+        static void task_fn(void* param);
+        void run();
+        void sample(Budgeted& m, float dt);
+        PowerMode pick_mode(std::uint32_t now);
+        float fill(int tier_mask, float left);
+        void allocate();
+        void write(Budgeted& m);
+
+        Intake& rollers;
+
+        Budgeted motors[POWER_MAX_MOTORS];
+        int n = 0;
+
+        PowerMode mode = POWER_BALANCED;
+        std::uint32_t mode_since = 0;
+
+        std::atomic<PowerMode> seen_mode{POWER_BALANCED};
+        std::atomic<std::int32_t> draw_ma{0};
+        std::atomic<std::int32_t> peak_ma{0};
+        std::atomic<std::uint32_t> short_samples{0};
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cmath>
+
+// Rest-to-rest motion profiles.
+//
+// A profile is up to seven constant-jerk segments. Trapezoids use three (jerk
+// 0, with a step in acceleration), S-curves use all seven. Any point in time
+// is evaluated in closed form from the segment it falls in, so sampling is
+// O(1) and nothing drifts from numeric integration. Units are whatever the
+// limits are given in (inches or radians, per second). Header only and free
+// of PROS.
+
+struct ProfileState {
+    float pos;
+    float vel;
+    float acc;
+};
+
+class Profile {
+    public:
+        /**
+         * Fastest move of dist with |v| <= vmax and |a| <= amax.
+         * If vmax can't be reached the cruise phase is dropped (triangle).
+         */
+        static Profile trapezoid(float dist, float vmax, float amax) {
+            Profile p;
+            p.sign = dist < 0 ? -1 : 1;
+            float d = std::fabs(dist);
+
+            float ta = vmax / amax;
+            float tc;
+            float a = amax;
+            if (vmax * ta > d) {
+                ta = std::sqrt(d / amax);
+                tc = 0;
+            } else {
+                tc = (d - vmax * ta) / vmax;
+            }
+
+            p.push(ta, a, 0);
+            p.push(tc, 0, 0);
+            p.push(ta, -a, 0);
+            return p;
+        }
+
+        /**
+         * Fastest move of dist with |v| <= vmax, |a| <= amax and |jerk| <= jmax.
+         * Peak acceleration and velocity are lowered for moves too short to
+         * reach them.
+         */
+        static Profile s_curve(float dist, float vmax, float amax, float jmax) {
+            Profile p;
+            p.sign = dist < 0 ? -1 : 1;
+            float d = std::fabs(dist);
+
+            // Tj: length of each jerk phase, Ta: whole accel phase, Tv: cruise
+            float tj, ta;
+            if (vmax * jmax >= amax * amax) {
+                tj = amax / jmax;
+                ta = tj + vmax / amax;
+            } else {
+                tj = std::sqrt(vmax / jmax);
+                ta = 2 * tj;
+            }
+
+            float tv = d / vmax - ta;
+            if (tv < 0) {
+                tv = 0;
+                if (d >= 2 * amax * amax * amax / (jmax * jmax)) {
+                    tj = amax / jmax;
+                    ta = tj / 2 + std::sqrt(tj * tj / 4 + d / amax);
+                } else {
+                    tj = std::cbrt(d / (2 * jmax));
+                    ta = 2 * tj;
+                }
+            }
+
+            float alim = jmax * tj;
+            p.push(tj, 0, jmax);
+            p.push(ta - 2 * tj, alim, 0);
+            p.push(tj, alim, -jmax);
+            p.push(tv, 0, 0);
+            p.push(tj, 0, -jmax);
+            p.push(ta - 2 * tj, -alim, 0);
+            p.push(tj, -alim, jmax);
+            return p;
+        }
+
+        ProfileState sample(float t) const {
+            if (t <= 0 || n == 0) {
+                return {0, 0, 0};
+            }
+            if (t >= total) {
+                return {sign * end_pos, 0, 0};
+            }
+
+            int i = 0;
+            while (i + 1 < n && t >= seg[i + 1].t0) {
+                i++;
+            }
+
+            const Segment& s = seg[i];
+            float u = t - s.t0;
+            float acc = s.a0 + s.j * u;
+            float vel = s.v0 + s.a0 * u + s.j * u * u / 2;
+            float pos = s.p0 + s.v0 * u + s.a0 * u * u / 2 + s.j * u * u * u / 6;
+            return {sign * pos, sign * vel, sign * acc};
+        }
+
+        float duration() const {
+            return total;
+        }
+
+        float distance() const {
+            return sign * end_pos;
+        }
+
+    private:
+        struct Segment {
+            float t0, p0, v0, a0, j;
+        };
+
+        // Appends a segment starting at acceleration a0 with constant jerk j,
+        // continuing position and velocity from the end of the last one
+        void push(float dur, float a0, float j) {
+            if (dur <= 0) {
+                return;
+            }
+
+            seg[n] = {total, end_pos, end_vel, a0, j};
+            end_pos += end_vel * dur + a0 * dur * dur / 2 + j * dur * dur * dur / 6;
+            end_vel += a0 * dur + j * dur * dur / 2;
+            total += dur;
+            n++;
+        }
+
+        Segment seg[7] = {};
+        int n = 0;
+        float total = 0;
+        float end_pos = 0;
+        float end_vel = 0;
+        float sign = 1;
+};
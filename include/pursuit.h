@@ -0,0 +1,90 @@
+#pragma once
+
+#include "path.h"
+#include "pose.h"
+#include <cmath>
+
+// Pure pursuit over a precomputed Path.
+//
+// The closest point and the lookahead point only ever move forward along the
+// path, and each is searched within a fixed window past where it was last
+// tick, so an update costs the same at the start and end of a long route.
+
+#define PURSUIT_LOOKAHEAD 12.0f     // inches
+#define PURSUIT_WINDOW 24           // samples searched past the last index
+#define PURSUIT_END_TOLERANCE 1.0f  // inches from the last point to finish
+
+struct PursuitOutput {
+    float v;            // forward speed, in/s
+    float a;            // forward acceleration along the path, in/s^2
+    float omega;        // turn rate, rad/s clockwise
+    bool done;
+};
+
+class PurePursuit {
+    public:
+        PurePursuit(const Path& path, float lookahead = PURSUIT_LOOKAHEAD)
+            : path(path), lookahead(lookahead) {}
+
+        PursuitOutput update(const Pose& p) {
+            const int last = path.size - 1;
+
+            // Closest point: step forward while the next sample is nearer
+            float best = dist2(closest, p);
+            int stop = closest + PURSUIT_WINDOW < last ? closest + PURSUIT_WINDOW : last;
+            for (int i = closest + 1; i <= stop; i++) {
+                float d = dist2(i, p);
+                if (d > best) break;
+                best = d;
+                closest = i;
+            }
+
+            // Lookahead point: first sample at least the lookahead away
+            if (look < closest) look = closest;
+            float l2 = lookahead * lookahead;
+            stop = look + PURSUIT_WINDOW < last ? look + PURSUIT_WINDOW : last;
+            while (look < stop && dist2(look, p) < l2) {
+                look++;
+            }
+
+            float ex = path.x[last] - p.x;
+            float ey = path.y[last] - p.y;
+            if (closest == last || (look == last && ex * ex + ey * ey < PURSUIT_END_TOLERANCE * PURSUIT_END_TOLERANCE)) {
+                return {0, 0, 0, true};
+            }
+
+            // Lookahead point in the robot frame, lateral positive to the right
+            float dx = path.x[look] - p.x;
+            float dy = path.y[look] - p.y;
+            float lateral = dx * std::cos(p.theta) - dy * std::sin(p.theta);
+            float d2 = dx * dx + dy * dy;
+            float k = d2 > 1e-6f ? 2 * lateral / d2 : 0;
+
+            float v = path.vel[closest];
+            float vn = path.vel[closest + 1];
+            float a = (vn * vn - v * v) / (2 * PATH_SPACING);
+
+            return {v, a, v * k, false};
+        }
+
+        void reset() {
+            closest = 0;
+            look = 0;
+        }
+
+        int progress() const {
+            return closest;
+        }
+
+    private:
+        float dist2(int i, const Pose& p) const {
+            float dx = path.x[i] - p.x;
+            float dy = path.y[i] - p.y;
+            return dx * dx + dy * dy;
+        }
+
+        const Path& path;
+        float lookahead;
+        int closest = 0;
+        int look = 0;
+};
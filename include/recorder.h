@@ -0,0 +1,140 @@
+#pragma once
+
+#include "main.h"
+#include "input.h"
+#include <cstdint>
+
+// Driver input recorder and replay.
+//
+// Every input tick of opcontrol() is appended to a fixed RAM buffer as a
+// delta against the tick before: a flag byte saying which axes and buttons
+// changed, the tick's pros::micros() offset from the nominal period, then
+// only the values that changed. A held stick costs 2-3 bytes a tick, so a
+// whole match is a few tens of KB, nothing is allocated while recording, and
+// the buffer is written to the SD card once the robot is disabled.
+//
+// Replay loads a recording into the same buffer and read_input() feeds it to
+// ctIn in place of the controller, so drive() and intake() run exactly as
+// they did, each recorded tick landing on the scheduler tick nearest its time.
+
+#define RECORD_PATH "/usd/driver.rec"
+#define REPLAY_PATH "/usd/replay.rec"
+
+// Longest recording: the 1:45 driver period at 10 ms ticks, plus margin
+#define RECORD_MAX_TICKS 15000
+
+// Worst case bytes per tick: flags, 5 byte time varint, 4 axes, 2 button bytes
+#define RECORD_TICK_MAX 12
+#define RECORD_BUFFER_SIZE (RECORD_MAX_TICKS * RECORD_TICK_MAX)
+
+// Input tick the recording is made at, the scheduler period of read_input()
+#define RECORD_PERIOD_MS 10
+
+struct RecordHeader {
+    char magic[4];                  // "VXIR"
+    std::uint16_t version;
+    std::uint16_t period_ms;
+    std::uint32_t ticks;
+    std::uint32_t bytes;            // size of the tick stream after the header
+};
+
+class InputRecorder {
+    public:
+        /**
+         * Starts a new recording, discarding anything in the buffer.
+         */
+        void start();
+        void stop();
+
+        bool recording() const {
+            return rec;
+        }
+
+        /**
+         * Appends one tick, called right after the snapshot is read. Stops
+         * recording when the buffer is full.
+         */
+        void append(const ControllerSnapshot& s);
+
+        /**
+         * Writes the recording to a file. False if the SD card or file
+         * can't be written.
+         */
+        bool save(const char* path) const;
+
+        /**
+         * Loads a recording for replay. False if the file is missing or
+         * isn't a recording.
+         */
+        bool load(const char* path);
+
+        /**
+         * Starts replaying the loaded recording from its first tick, timed
+         * from now.
+         */
+        void begin_replay();
+
+        /**
+         * Applies every recorded tick due by now into the snapshot, keeping
+         * presses and releases from ticks that landed together. Once the
+         * recording runs out the sticks and buttons read as released.
+         *
+         * \return false once the recording has run out
+         */
+        bool replay(ControllerSnapshot& s);
+
+        /**
+         * Leaves replay, read_input() goes back to the controller.
+         */
+        void end_replay() {
+            playing = false;
+        }
+
+        bool replaying() const {
+            return playing;
+        }
+
+        bool finished() const {
+            return !have_next;
+        }
+
+        std::uint32_t ticks() const {
+            return n;
+        }
+
+        std::uint32_t size() const {
+            return len;
+        }
+
+    private:
+        struct Tick {
+            std::uint64_t time_us;      // since the start of the recording
+            std::int8_t axis[NUM_AXES];
+            std::uint16_t buttons;
+        };
+
+        bool decode(Tick& t);
+
+        std::uint8_t buf[RECORD_BUFFER_SIZE];
+        std::uint32_t len = 0;
+        std::uint32_t n = 0;
+        bool rec = false;
+
+        // Encoder state
+        Tick last = {};
+        std::uint64_t start_us = 0;
+        std::uint64_t prev_us = 0;
+
+        // Decoder state
+        bool playing = false;
+        std::uint32_t pos = 0;
+        Tick next = {};
+        bool have_next = false;
+        std::uint64_t play_start_us = 0;
+};
+
+/**
+ * Runs a loaded recording through the driver control loops until it ends,
+ * then stops the drive and intake. Blocks, for use from autonomous().
+ */
+void replay_recording();
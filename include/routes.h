@@ -0,0 +1,20 @@
+#pragma once
+
+// The autonomous route's poses, shared by auton.cpp and the host tools that
+// drive it in simulation. The paths between them are planned ahead of time
+// into routes_baked.h by tools/bake_routes.cpp.
+
+// ROUTE: field inches from the center, headings in degrees clockwise from +y
+// Placeholder points, replace with the match plan
+#define START_X -60
+#define START_Y -24
+#define START_HEADING 90
+
+#define GOAL_X 12
+#define GOAL_Y -48
+#define GOAL_HEADING 90
+#define GOAL_TURN 180       // turned in place there, clockwise
+
+#define LOADER_X -60
+#define LOADER_Y -24
+#define LOADER_HEADING 0
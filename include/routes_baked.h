@@ -0,0 +1,213 @@
+#pragma once
+
+#include "drive_gains.h"
+#include "planner.h"
+#include "routes.h"
+#include <cstdint>
+
+// Generated by tools/bake_routes.cpp, do not edit. The autonomous route's
+// legs planned on the bare field and generated at the drive's limits, and
+// the inflated field grid, all in flash.
+
+// BAKED FROM, re-run tools/bake_routes if any of these fail
+static_assert(DRIVE_MAX_VEL == 60.0f, "stale routes_baked.h");
+static_assert(DRIVE_MAX_ACCEL == 120.0f, "stale routes_baked.h");
+static_assert(PATH_SPACING == 1.0f, "stale routes_baked.h");
+static_assert(PLAN_TURN_K == 30.0f, "stale routes_baked.h");
+static_assert(PLAN_ROBOT_RADIUS == 9.0f, "stale routes_baked.h");
+static_assert(PLAN_MARGIN == 2.0f, "stale routes_baked.h");
+static_assert(PLAN_MAX_LEG == 24.0f, "stale routes_baked.h");
+static_assert(PLAN_ESCAPE == 12.0f, "stale routes_baked.h");
+static_assert(PLAN_APPROACH == 30.0f, "stale routes_baked.h");
+static_assert(PLAN_APPROACH_TURN == 120.0f, "stale routes_baked.h");
+static_assert(OCC_CELL == 2.0f, "stale routes_baked.h");
+static_assert(OCC_ORIGIN == -72.0f, "stale routes_baked.h");
+static_assert(OCC_N == 72.0f, "stale routes_baked.h");
+static_assert(SAMPLE_POS_SCALE == 100.0f, "stale routes_baked.h");
+static_assert(SAMPLE_ANGLE_SCALE == 10000.0f, "stale routes_baked.h");
+static_assert(SAMPLE_CURVATURE_SCALE == 10000.0f, "stale routes_baked.h");
+static_assert(SAMPLE_VEL_SCALE == 100.0f, "stale routes_baked.h");
+static_assert(START_X == -60.0f, "stale routes_baked.h");
+static_assert(START_Y == -24.0f, "stale routes_baked.h");
+static_assert(START_HEADING == 90.0f, "stale routes_baked.h");
+static_assert(GOAL_X == 12.0f, "stale routes_baked.h");
+static_assert(GOAL_Y == -48.0f, "stale routes_baked.h");
+static_assert(GOAL_HEADING == 90.0f, "stale routes_baked.h");
+static_assert(GOAL_TURN == 180.0f, "stale routes_baked.h");
+static_assert(LOADER_X == -60.0f, "stale routes_baked.h");
+static_assert(LOADER_Y == -24.0f, "stale routes_baked.h");
+static_assert(LOADER_HEADING == 0.0f, "stale routes_baked.h");
+static_assert(field_fingerprint() == -364.799927f, "stale routes_baked.h");
+
+inline constexpr Waypoint TO_GOAL_WAYPOINTS[] = {
+    {-60.0f, -24.0f, 90.0f},
+    {-46.0f, -32.0f, 119.744881f},
+    {-32.0f, -40.0f, 119.744881f},
+    {-18.0f, -48.0f, 104.872437f},
+    {-3.0f, -48.0f, 97.4362183f},
+    {12.0f, -48.0f, 90.0f},
+};
+
+inline constexpr PathSample TO_GOAL_SAMPLES[] = {
+    {-6000, -2400, 16342, 0, 1549}, {-5897, -2407, 16948, 1192, 2191}, {-5797, -2425, 18118, 1093, 2683},
+    {-5700, -2455, 19160, 952, 3098}, {-5606, -2494, 20054, 793, 3464}, {-5514, -2542, 20794, 635, 3795},
+    {-5423, -2596, 21386, 489, 4099}, {-5334, -2656, 21825, 360, 4382}, {-5253, -2715, 22144, 247, 4648},
+    {-5173, -2777, 22342, 146, 4899}, {-5093, -2840, 22441, 50, 5138}, {-5013, -2904, 22444, -44, 5367},
+    {-4933, -2968, 22350, -140, 5586}, {-4853, -3030, 22157, -241, 5797}, {-4772, -3089, 21845, -354, 6000},
+    {-4683, -3149, 21414, -480, 6000}, {-4593, -3204, 21028, -244, 6000}, {-4502, -3256, 20899, 0, 6000},
+    {-4411, -3308, 20899, 0, 6000}, {-4320, -3360, 20899, 0, 6000}, {-4229, -3412, 20899, 0, 6000},
+    {-4138, -3464, 20899, 0, 6000}, {-4047, -3516, 20899, 0, 6000}, {-3956, -3568, 20899, 0, 6000},
+    {-3865, -3620, 20899, 0, 6000}, {-3774, -3672, 20899, 0, 6000}, {-3683, -3724, 20899, 0, 6000},
+    {-3592, -3776, 20899, 0, 6000}, {-3501, -3828, 20899, 0, 6000}, {-3410, -3880, 20899, 0, 6000},
+    {-3319, -3932, 20899, 0, 6000}, {-3228, -3984, 20938, 73, 6000}, {-3137, -4037, 21111, 258, 6000},
+    {-3048, -4092, 21357, 209, 6000}, {-2959, -4150, 21545, 147, 6000}, {-2871, -4209, 21668, 86, 6000},
+    {-2783, -4269, 21727, 26, 6000}, {-2696, -4329, 21723, -34, 6000}, {-2608, -4389, 21656, -93, 6000},
+    {-2520, -4448, 21524, -154, 6000}, {-2431, -4506, 21328, -217, 6000}, {-2341, -4561, 21066, -281, 6000},
+    {-2250, -4613, 20737, -347, 6000}, {-2158, -4662, 20339, -414, 6000}, {-2064, -4706, 19873, -481, 6000},
+    {-1968, -4746, 19339, -544, 6000}, {-1870, -4780, 18744, -610, 6000}, {-1771, -4807, 18026, -768, 6000},
+    {-1669, -4827, 17251, -735, 6000}, {-1565, -4839, 16542, -625, 6000}, {-1461, -4845, 15951, -508, 6000},
+    {-1357, -4844, 15480, -392, 6000}, {-1251, -4840, 15126, -279, 6000}, {-1146, -4832, 14888, -171, 6000},
+    {-1040, -4822, 14763, -66, 6000}, {-933, -4812, 14748, 38, 6000}, {-827, -4802, 14843, 141, 6000},
+    {-721, -4794, 15050, 247, 6000}, {-615, -4788, 15369, 356, 6000}, {-510, -4786, 15804, 468, 6000},
+    {-404, -4790, 16357, 581, 6000}, {-300, -4800, 16746, 161, 6000}, {-196, -4812, 16668, -310, 5797},
+    {-91, -4820, 16362, -274, 5586}, {13, -4825, 16093, -238, 5367}, {118, -4828, 15864, -201, 5138},
+    {223, -4829, 15672, -164, 4899}, {328, -4827, 15519, -127, 4648}, {433, -4825, 15405, -91, 4382},
+    {539, -4821, 15328, -55, 4099}, {644, -4817, 15289, -19, 3795}, {749, -4812, 15289, 17, 3464},
+    {854, -4808, 15326, 53, 3098}, {960, -4804, 15400, 89, 2683}, {1065, -4801, 15513, 125, 2191},
+    {1170, -4800, 15602, 153, 1549}, {1200, -4800, 15683, 0, 0},
+};
+
+inline constexpr BakedLeg TO_GOAL = {
+    -60.0f, -24.0f, 90.0f,
+    12.0f, -48.0f, 90.0f,
+    TO_GOAL_WAYPOINTS, 6,
+    TO_GOAL_SAMPLES, 77,
+};
+
+inline constexpr Waypoint TO_LOADER_WAYPOINTS[] = {
+    {12.0f, -48.0f, 270.0f},
+    {-6.0f, -49.5f, -94.7636414f},
+    {-24.0f, -51.0f, -94.7636414f},
+    {-42.0f, -52.5f, -94.7636414f},
+    {-60.0f, -54.0f, -47.3818169f},
+    {-60.0f, -39.0f, -23.6909103f},
+    {-60.0f, -24.0f, 0.0f},
+};
+
+inline constexpr PathSample TO_LOADER_SAMPLES[] = {
+    {1200, -4800, -15805, 0, 1549}, {1092, -4801, -15895, -168, 2191}, {983, -4804, -16068, -151, 2683},
+    {875, -4809, -16223, -135, 3098}, {767, -4815, -16360, -118, 3464}, {659, -4823, -16478, -101, 3795},
+    {551, -4832, -16579, -85, 4099}, {443, -4842, -16662, -68, 4382}, {335, -4853, -16726, -51, 4648},
+    {227, -4864, -16773, -35, 4899}, {119, -4876, -16802, -18, 5138}, {12, -4888, -16813, -2, 5367},
+    {-96, -4900, -16806, 15, 5586}, {-204, -4911, -16781, 31, 5797}, {-312, -4923, -16738, 48, 6000},
+    {-420, -4934, -16677, 64, 6000}, {-528, -4944, -16602, 76, 6000}, {-636, -4953, -16550, 20, 6000},
+    {-744, -4962, -16539, 0, 6000}, {-852, -4971, -16539, 0, 6000}, {-960, -4980, -16539, 0, 6000},
+    {-1068, -4989, -16539, 0, 6000}, {-1176, -4998, -16539, 0, 6000}, {-1284, -5007, -16539, 0, 6000},
+    {-1392, -5016, -16539, 0, 6000}, {-1500, -5025, -16539, 0, 6000}, {-1608, -5034, -16539, 0, 6000},
+    {-1716, -5043, -16539, 0, 6000}, {-1824, -5052, -16539, 0, 6000}, {-1932, -5061, -16539, 0, 6000},
+    {-2040, -5070, -16539, 0, 6000}, {-2148, -5079, -16539, 0, 6000}, {-2256, -5088, -16539, 0, 6000},
+    {-2364, -5097, -16539, 0, 6000}, {-2472, -5106, -16539, 0, 6000}, {-2580, -5115, -16539, 0, 6000},
+    {-2688, -5124, -16539, 0, 6000}, {-2796, -5133, -16539, 0, 6000}, {-2904, -5142, -16539, 0, 6000},
+    {-3012, -5151, -16539, 0, 6000}, {-3120, -5160, -16539, 0, 6000}, {-3228, -5169, -16539, 0, 6000},
+    {-3336, -5178, -16539, 0, 6000}, {-3444, -5187, -16539, 0, 6000}, {-3552, -5196, -16539, 0, 6000},
+    {-3660, -5205, -16539, 0, 6000}, {-3768, -5214, -16539, 0, 6000}, {-3876, -5223, -16539, 0, 6000},
+    {-3984, -5232, -16539, 0, 6000}, {-4092, -5241, -16539, 0, 6000}, {-4200, -5250, -16721, -359, 6000},
+    {-4300, -5262, -17237, -615, 6000}, {-4403, -5281, -17789, -450, 6000}, {-4508, -5306, -18197, -314, 6000},
+    {-4614, -5335, -18468, -203, 6000}, {-4711, -5364, -18635, -108, 6000}, {-4809, -5394, -18701, -22, 6000},
+    {-4907, -5424, -18681, 62, 6000}, {-5004, -5453, -18574, 150, 6000}, {-5101, -5481, -18362, 250, 6000},
+    {-5207, -5509, -18040, 368, 6000}, {-5311, -5531, -17574, 516, 6000}, {-5412, -5547, -16919, 702, 6000},
+    {-5520, -5557, -16069, 935, 6000}, {-5625, -5555, -14949, 1212, 6000}, {-5725, -5541, -13507, 1501, 6000},
+    {-5828, -5510, -11888, 1714, 6000}, {-5917, -5464, -10041, 1761, 6000}, {-6000, -5400, -8018, 2137, 6000},
+    {-6068, -5318, -5535, 2681, 6000}, {-6108, -5225, -2884, 2351, 6000}, {-6126, -5123, -819, 1703, 6000},
+    {-6125, -5021, 630, 1125, 6000}, {-6113, -4921, 1578, 707, 6000}, {-6093, -4817, 2141, 411, 6000},
+    {-6069, -4719, 2453, 186, 6000}, {-6043, -4620, 2546, -3, 6000}, {-6017, -4520, 2448, -186, 6000},
+    {-5993, -4420, 2158, -384, 6000}, {-5973, -4321, 1629, -623, 6000}, {-5959, -4215, 837, -930, 6000},
+    {-5956, -4113, -365, -1326, 6000}, {-5967, -4007, -1969, -1768, 6000}, {-5997, -3907, -3283, -713, 6000},
+    {-6034, -3810, -3139, 1003, 5797}, {-6061, -3710, -2150, 909, 5586}, {-6078, -3609, -1276, 783, 5367},
+    {-6087, -3506, -535, 647, 5138}, {-6089, -3401, 72, 514, 4899}, {-6086, -3295, 549, 389, 4648},
+    {-6078, -3189, 893, 275, 4382}, {-6067, -3089, 1126, 171, 4099}, {-6055, -2989, 1250, 75, 3795},
+    {-6042, -2889, 1278, -19, 3464}, {-6029, -2789, 1211, -114, 3098}, {-6018, -2689, 1038, -215, 2683},
+    {-6008, -2582, 757, -324, 2191}, {-6001, -2475, 420, -432, 1549}, {-6000, -2400, 190, 0, 0},
+};
+
+inline constexpr BakedLeg TO_LOADER = {
+    12.0f, -48.0f, 270.0f,
+    -60.0f, -24.0f, 0.0f,
+    TO_LOADER_WAYPOINTS, 7,
+    TO_LOADER_SAMPLES, 99,
+};
+
+inline constexpr OccupancyGrid::Row FIELD_OCCUPANCY[OCC_N] = {
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000180000003full, 0x00000000000000fcull},
+    {0x000000ff0000003full, 0x00000000000000fcull},
+    {0x000001ff8000003full, 0x00000000000000fcull},
+    {0x000003ffc000003full, 0x00000000000000fcull},
+    {0x000007ffe000003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x00001ffff800003full, 0x00000000000000fcull},
+    {0x00001ffff800003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x00000ffff000003full, 0x00000000000000fcull},
+    {0x000007ffe000003full, 0x00000000000000fcull},
+    {0x000003ffc000003full, 0x00000000000000fcull},
+    {0x000001ff8000003full, 0x00000000000000fcull},
+    {0x000000ff0000003full, 0x00000000000000fcull},
+    {0x000000180000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0x000000000000003full, 0x00000000000000fcull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+    {0xffffffffffffffffull, 0x00000000000000ffull},
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "main.h"
+#include <atomic>
+#include <cstdint>
+
+// Fixed-rate loop executor.
+//
+// Every registered loop runs inside one pros::Task paced by task_delay_until(),
+// in the order it was added, each at its own period. Loops that share a tick
+// always run back to back in that order, so a loop that reads the controller
+// can be added before the loops that consume it.
+
+// MAX LOOPS PER SCHEDULER
+#define SCHED_MAX_LOOPS 8
+
+// Control loops take priority over telemetry / display tasks
+#define SCHED_PRIORITY (TASK_PRIORITY_DEFAULT + 2)
+
+typedef void (*loop_fn_t)();
+
+class TelemetryLog;
+
+struct LoopStats {
+    std::uint32_t runs;
+    std::uint32_t overruns;         // runs that finished past their next deadline
+    std::uint32_t last_period_us;   // start-to-start time of the last two runs
+    std::uint32_t min_period_us;
+    std::uint32_t max_period_us;
+    std::uint32_t avg_period_us;    // moving average, 1/8 weight per run
+    std::uint32_t last_exec_us;
+    std::uint32_t max_exec_us;
+};
+
+class Scheduler {
+    public:
+        /**
+         * Registers a loop to be called every period_ms milliseconds.
+         * Loops can only be added while the scheduler is stopped.
+         *
+         * \return false if the table is full, the period is 0, or it is running
+         */
+        bool add(const char* name, loop_fn_t fn, std::uint32_t period_ms);
+
+        /**
+         * Starts the executor task. Does nothing if it is already running.
+         */
+        void start(std::uint32_t prio = SCHED_PRIORITY);
+
+        /**
+         * Stops the executor task and blocks until the current tick finishes.
+         */
+        void stop();
+
+        bool is_running() const;
+        void reset_stats();
+
+        int count() const;
+        const char* name(int i) const;
+        LoopStats stats(int i) const;
+
+        // Base tick of the executor, the gcd of every loop period
+        std::uint32_t tick_ms() const;
+
+        /**
+         * Logs the timing of every loop run to a telemetry log, nullptr to
+         * stop. Only while the scheduler is stopped.
+         */
+        void set_log(TelemetryLog* log);
+
+    private:
+        struct Loop {
+            const char* name;
+            loop_fn_t fn;
+            std::uint32_t period_ms;
+            std::uint32_t next_ms;
+            std::uint64_t last_start_us;
+            LoopStats stats;
+        };
+
+        static void task_fn(void* param);
+        void run();
+
+        Loop loops[SCHED_MAX_LOOPS] = {};
+        int n = 0;
+        std::uint32_t tick = 1;
+        TelemetryLog* log = nullptr;
+        std::atomic<bool> running{false};
+        std::atomic<bool> alive{false};
+};
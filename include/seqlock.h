@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock.
+//
+// The writer never waits and readers never block it: a reader copies the
+// value and retries if the writer was in the middle of an update. The value
+// is stored as relaxed atomic words so a torn copy is well defined, it is
+// just thrown away. Only one task may call write().
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock needs a trivially copyable type");
+
+    public:
+        void write(const T& value) {
+            std::uint32_t buf[WORDS] = {};
+            std::memcpy(buf, &value, sizeof(T));
+
+            std::uint32_t s = seq.load(std::memory_order_relaxed);
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int i = 0; i < WORDS; i++) {
+                words[i].store(buf[i], std::memory_order_relaxed);
+            }
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        T read() const {
+            std::uint32_t buf[WORDS];
+            std::uint32_t s1, s2;
+            do {
+                s1 = seq.load(std::memory_order_acquire);
+                for (int i = 0; i < WORDS; i++) {
+                    buf[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                s2 = seq.load(std::memory_order_relaxed);
+            } while ((s1 & 1) || s1 != s2);
+
+            T value;
+            std::memcpy(&value, buf, sizeof(T));
+            return value;
+        }
+
+        // Bumped on every write, lets readers tell whether anything changed
+        std::uint32_t version() const {
+            return seq.load(std::memory_order_acquire) / 2;
+        }
+
+    private:
+        static constexpr int WORDS = (sizeof(T) + 3) / 4;
+
+        std::atomic<std::uint32_t> seq{0};
+        std::atomic<std::uint32_t> words[WORDS] = {};
+};
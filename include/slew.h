@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// Slew and jerk limiting for motor outputs.
+//
+// Sits between a subsystem's logic and its motor writes. The logic says where
+// each output should be, apply() moves every channel toward that by at most
+// the channel's rate per second, with the rate itself changing by at most
+// the jerk per second, and slows the approach in time to land on the target
+// rather than overshoot it. Limits and period are template parameters so
+// every per-tick step is folded to a constant, and the channels are plain
+// arrays walked in one branch-free loop the compiler can vectorize.
+//
+//   constexpr SlewConfig<2> DRIVE = {.dt = 0.01f, .ch = {{500, 5000}, {500, 5000}}};
+//   SlewStage<2, DRIVE> slew;
+//   float out[2] = {left, right};
+//   slew.apply(out);
+
+struct SlewLimit {
+    float rate = 0;         // most change per second, 0 = unlimited
+    float jerk = 0;         // most change in rate per second^2, 0 = unlimited
+};
+
+template <std::size_t N>
+struct SlewConfig {
+    float dt = 0.01f;       // period apply() is called at, s
+    SlewLimit ch[N] = {};
+};
+
+template <std::size_t N, SlewConfig<N> C>
+class SlewStage {
+    static_assert(N > 0, "a stage needs a channel");
+    static_assert(C.dt > 0, "period must be positive");
+
+    // Per tick limits, unlimited is just far past any output's range
+    static constexpr float UNLIMITED = 1e30f;
+
+    struct Steps {
+        float step[N];      // most change in one tick
+        float accel[N];     // most change in the step in one tick
+    };
+
+    static constexpr Steps make_steps() {
+        Steps s = {};
+        for (std::size_t i = 0; i < N; i++) {
+            s.step[i] = C.ch[i].rate > 0 ? C.ch[i].rate * C.dt : UNLIMITED;
+            s.accel[i] = C.ch[i].jerk > 0 ? C.ch[i].jerk * C.dt * C.dt : UNLIMITED;
+        }
+        return s;
+    }
+
+    static constexpr Steps LIM = make_steps();
+
+    public:
+        /**
+         * One tick. Takes the outputs the logic wants and replaces them with
+         * what should be written this tick.
+         */
+        void apply(float (&out)[N]) {
+            for (std::size_t i = 0; i < N; i++) {
+                float err = out[i] - value[i];
+                float dist = std::fabs(err);
+
+                // Fastest step that can still be braked to 0 by the target,
+                // s + (s - a) + (s - 2a) + ... = s (s + a) / 2a <= dist, solved
+                // in a form that stays exact when a is unlimited
+                float brake = 4 * dist / (std::sqrt(1 + 8 * dist / LIM.accel[i]) + 1);
+                float want = std::copysign(lo(dist, brake), err);
+
+                // Step changes by at most accel, and is at most step
+                float s = lo(hi(want, last[i] - LIM.accel[i]), last[i] + LIM.accel[i]);
+                s = lo(hi(s, -LIM.step[i]), LIM.step[i]);
+
+                value[i] += s;
+                last[i] = s;
+                out[i] = value[i];
+            }
+        }
+
+        /**
+         * Starts over at rest from the given outputs, for when the motors were
+         * written by something else (or stopped) in between.
+         */
+        void reset(const float (&now)[N] = {}) {
+            for (std::size_t i = 0; i < N; i++) {
+                value[i] = now[i];
+                last[i] = 0;
+            }
+        }
+
+        float output(std::size_t i) const {
+            return value[i];
+        }
+
+    private:
+        // Plain compares rather than fmin/fmax, which have to handle NaN and
+        // so don't map onto vector min/max instructions
+        static float lo(float a, float b) {
+            return a < b ? a : b;
+        }
+
+        static float hi(float a, float b) {
+            return a > b ? a : b;
+        }
+
+        float value[N] = {};
+        float last[N] = {};
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "main.h"
+#include "command.h"
+
+// Feedforward characterization.
+//
+// Picked on the screen in competition_initialize() in place of the match
+// routine. autonomous() then drives each mechanism through voltage tests and
+// logs a TELEM_SYSID record per mechanism every tick with the voltage, and
+// the velocity and acceleration from the motion estimator:
+//
+//   quasistatic   voltage ramped slowly each way, acceleration stays small
+//                 so speed against voltage shows kS and kV
+//   step          a voltage step each way, mostly acceleration, for kA
+//   turn          the drive sides ramped against each other, for the
+//                 effective track width from the IMU's turn rate
+//
+// The intake stages run their tests alongside the drive's. tools/sysid_fit.cpp
+// fits kS/kV/kA per mechanism and the track width from the log. The drive
+// tests travel about 40 in forward and come back, so give the robot room.
+// They take about 23 s, longer than a match's 15 s autonomous period, so run
+// them with a longer period (skills, or a timed field controller); cut short,
+// the tests finished so far are still logged.
+
+// DRIVE TESTS
+#define SYSID_DRIVE_RAMP_MV_S 1000
+#define SYSID_DRIVE_RAMP_MAX_MV 4000    // about 25 in/s, ramps end here
+#define SYSID_DRIVE_STEP_MV 6000
+#define SYSID_DRIVE_STEP_MS 800
+
+// INTAKE TESTS, the rollers spin free so they can go to full voltage
+#define SYSID_INTAKE_RAMP_MV_S 2000
+#define SYSID_INTAKE_RAMP_MAX_MV 12000
+#define SYSID_INTAKE_STEP_MV 8000
+#define SYSID_INTAKE_STEP_MS 1000
+
+// Stopped between tests, to come to rest
+#define SYSID_REST_MS 1000
+
+/**
+ * Every test, the drive's and the intake's at once. The intake task must be
+ * stopped first, the tests write the roller motors themselves; it is
+ * started again when the routine ends or is cancelled.
+ */
+Command sysid_routine();
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "main.h"
+#include "odom.h"
+#include "localizer.h"
+#include "motor_telemetry.h"
+#include "telemetry_record.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+// Binary telemetry log.
+//
+// Any task can push fixed size records into a lock-free ring without ever
+// waiting: a producer claims a slot with one compare-and-swap on the head and
+// publishes it by bumping the slot's sequence number, and if the ring is full
+// the record is counted as dropped instead. A low priority writer task drains
+// the ring into a 4 KB block and writes each block to the SD card whole, so
+// the control loops never touch the filesystem.
+//
+// Records come from the sampler task (motors and poses every 10 ms) and from
+// anything else given the log, e.g. the scheduler's per-run loop timing.
+// Files are /usd/tlm000.bin, tlm001.bin, ... numbered per start(), in the
+// format of telemetry_record.h.
+
+#define TELEM_FILE_FMT "/usd/tlm%03u.bin"
+#define TELEM_MAX_FILES 1000
+
+// Ring size in records, a power of two. 2048 records is about a second of
+// everything at once, enough to ride out a slow SD write.
+#define TELEM_RING_SIZE 2048
+
+#define TELEM_SAMPLE_MS 10
+#define TELEM_WRITE_MS 20
+#define TELEM_STATS_MS 1000
+
+// Motors the sampler can follow
+#define TELEM_LOG_MOTORS 12
+
+// Sampler runs just under the control loops, the writer at the bottom
+#define TELEM_SAMPLE_PRIORITY (TASK_PRIORITY_DEFAULT + 1)
+#define TELEM_WRITE_PRIORITY (TASK_PRIORITY_MIN + 1)
+
+static_assert((TELEM_RING_SIZE & (TELEM_RING_SIZE - 1)) == 0, "ring size is a power of two");
+
+struct TelemetryStats {
+    std::uint32_t pushed;
+    std::uint32_t dropped;
+    std::uint32_t written;
+    std::uint32_t high_water;
+    std::uint32_t blocks;
+    std::uint32_t write_errors;
+    std::uint32_t max_write_us;
+};
+
+class TelemetryLog {
+    public:
+        TelemetryLog(Odometry& odom, Localizer& loc);
+
+        /**
+         * Adds a motor (signed port) for the sampler. Only before start().
+         */
+        bool add_motor(std::int8_t port);
+        void add_motors(const pros::MotorGroup& mg);
+
+        /**
+         * Opens the next free log file and starts the sampler and writer.
+         *
+         * \return false if there is no SD card or no file could be opened
+         */
+        bool start();
+
+        /**
+         * Stops both tasks and writes out everything still in the ring.
+         */
+        void stop();
+
+        /**
+         * Asks the writer to pad out and write the current block and flush
+         * the file, e.g. when the robot is disabled. Does not wait.
+         */
+        void flush();
+
+        bool is_running() const {
+            return running;
+        }
+
+        /**
+         * Queues a record, stamping its time. Never blocks, safe from any task.
+         *
+         * \return false if the ring was full and the record was dropped
+         */
+        bool push(TelemetryRecord& r);
+
+        /**
+         * Queues a name for a loop id, so a decoder can label it.
+         */
+        void name(std::uint8_t id, const char* text);
+
+        TelemetryStats stats() const;
+
+    private:
+        struct Slot {
+            std::atomic<std::uint32_t> seq;
+            TelemetryRecord rec;
+        };
+
+        static void sample_fn(void* param);
+        static void write_fn(void* param);
+        void sample();
+        void write();
+        bool pop(TelemetryRecord& r);
+        void put(const TelemetryRecord& r);
+        void write_block();
+
+        Odometry& odom;
+        Localizer& loc;
+        std::int8_t ports[TELEM_LOG_MOTORS];
+        int n_ports = 0;
+
+        Slot ring[TELEM_RING_SIZE];
+        std::atomic<std::uint32_t> head{0};
+        std::uint32_t tail = 0;            // writer only
+
+        // Block being filled, writer only
+        TelemetryRecord block[TELEM_BLOCK_BYTES / sizeof(TelemetryRecord)];
+        int fill = 0;
+        std::FILE* file = nullptr;
+
+        std::atomic<std::uint32_t> pushed{0};
+        std::atomic<std::uint32_t> dropped{0};
+        std::atomic<std::uint32_t> written{0};
+        std::atomic<std::uint32_t> high_water{0};
+        std::atomic<std::uint32_t> blocks{0};
+        std::atomic<std::uint32_t> write_errors{0};
+        std::atomic<std::uint32_t> max_write_us{0};
+
+        std::atomic<bool> flush_pending{false};
+        std::atomic<bool> running{false};
+        std::atomic<int> alive{0};
+};
+
+/**
+ * Pushes records from several tasks at once at the given total rate for a
+ * few seconds, then prints how many were dropped and how long the SD writes
+ * took. Run it with a terminal attached and the log started.
+ */
+void bench_log(TelemetryLog& log, int rate_hz, int seconds);
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+
+// Telemetry log file format, shared by the robot and the host decoder.
+//
+// A log is a sequence of 4 KB blocks of 32 byte records, little endian as
+// written by the brain. The first record of a file is a TELEM_HEADER, and a
+// block that was written early is padded out with TELEM_PAD records, so a
+// reader can split a file on any block boundary and decode each part alone.
+
+#define TELEM_BLOCK_BYTES 4096
+#define TELEM_VERSION 1
+
+enum TelemetryType : std::uint8_t {
+    TELEM_PAD = 0,          // fills out the last block, no payload
+    TELEM_HEADER,           // first record of every file
+    TELEM_NAME,             // names a loop id for the records that follow
+    TELEM_MOTOR,            // id = signed port
+    TELEM_POSE,             // id = TelemetryPoseSource
+    TELEM_LOOP,             // id = scheduler loop index
+    TELEM_STATS,            // the log's own counters
+    TELEM_PROFILE,          // id = TickStage, latency percentiles so far
+    TELEM_SYSID,            // id = SysidMechanism, one characterization sample
+};
+
+enum TelemetryPoseSource : std::uint8_t {
+    TELEM_POSE_ODOM = 0,
+    TELEM_POSE_FUSED,
+};
+
+// Stages of a driver control tick, timed by tick_profile.h
+enum TickStage : std::uint8_t {
+    STAGE_INPUT = 0,        // read_input()
+    STAGE_DRIVE,            // drive(), including its motor writes
+    STAGE_INTAKE,           // intake()
+    STAGE_MOTOR_WRITE,      // each group of motor commands
+    STAGE_TICK,             // start of the input read to the last motor write
+    NUM_STAGES,
+};
+
+// Mechanisms and tests of the feedforward characterization, sysid.h
+enum SysidMechanism : std::uint8_t {
+    SYSID_LEFT = 0,         // drive sides, in and in/s
+    SYSID_RIGHT,
+    SYSID_INTAKE_MAIN,      // roller stages, raw counts and counts/s
+    SYSID_INTAKE_TOP,
+    SYSID_MECHANISMS,
+};
+
+enum SysidTest : std::uint8_t {
+    SYSID_QUASI_FWD = 0,    // slow voltage ramps, speed tracks voltage
+    SYSID_QUASI_REV,
+    SYSID_STEP_FWD,         // voltage steps, mostly acceleration
+    SYSID_STEP_REV,
+    SYSID_TURN_CW,          // drive sides ramped against each other
+    SYSID_TURN_CCW,
+    SYSID_TESTS,
+};
+
+inline constexpr const char* SYSID_MECHANISM_NAMES[SYSID_MECHANISMS] = {"left", "right", "intake main",
+                                                                        "intake top"};
+
+inline constexpr const char* TICK_STAGE_NAMES[NUM_STAGES] = {"input", "drive", "intake", "write", "tick"};
+
+struct TelemetryRecord {
+    std::uint8_t type;
+    std::uint8_t id;
+    std::uint16_t time_hi;          // bits 32-47 of micros()
+    std::uint32_t time_us;          // low 32 bits of micros()
+    union {
+        struct {
+            char magic[4];          // "VXTL"
+            std::uint16_t version;
+            std::uint16_t record_bytes;
+            std::uint32_t block_bytes;
+            std::uint32_t time_ms;  // millis() when the file was opened
+        } header;
+        struct {
+            char text[24];          // NUL padded
+        } name;
+        struct {
+            float position;         // degrees
+            float velocity;         // rpm
+            std::int32_t current;   // mA
+            std::int32_t voltage;   // mV
+            float temperature;      // degrees C
+            std::uint32_t flags;    // motor_flag_e bits
+        } motor;
+        struct {
+            float x;
+            float y;
+            float theta;
+            float v;
+            float omega;
+            std::uint32_t time_ms;  // when the estimate was made
+        } pose;
+        struct {
+            std::uint32_t period_us;    // start-to-start, 0 on the first run
+            std::uint32_t exec_us;
+            std::uint32_t overruns;     // running total
+        } loop;
+        struct {
+            std::uint32_t written;      // records written, counting this one
+            std::uint32_t dropped;      // records lost to a full ring
+            std::uint32_t high_water;   // most records waiting at once
+            std::uint32_t blocks;
+            std::uint32_t write_errors;
+            std::uint32_t max_write_us; // slowest block write so far
+        } stats;
+        struct {
+            std::uint32_t count;
+            std::uint32_t p50_us;
+            std::uint32_t p90_us;
+            std::uint32_t p99_us;
+            std::uint32_t p999_us;
+            std::uint32_t max_us;
+        } profile;
+        struct {
+            float voltage;          // mV applied
+            float velocity;         // per s, in the mechanism's units
+            float accel;            // per s^2
+            float omega;            // rad/s the robot turned, clockwise
+            std::uint8_t test;      // SysidTest
+        } sysid;
+    };
+};
+
+static_assert(sizeof(TelemetryRecord) == 32, "telemetry records are 32 bytes");
+static_assert(TELEM_BLOCK_BYTES % sizeof(TelemetryRecord) == 0, "blocks hold whole records");
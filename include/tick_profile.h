@@ -0,0 +1,89 @@
+#pragma once
+
+#include "main.h"
+#include "hdr_histogram.h"
+#include "telemetry.h"
+
+// Per-stage latency of the driver control tick.
+//
+// Each stage of a tick (see TickStage) is timed with pros::micros() into its
+// own HdrHistogram, so the whole profile is 10 KB however long it runs.
+// The histograms are written only from the scheduler task. Other tasks read
+// them for the screen and the log without locking, which at worst shows a
+// count or two that is one tick stale.
+
+// 3% resolution from 1 us up to about a second
+#define PROFILE_SUB_BITS 6
+#define PROFILE_MAX_BITS 20
+
+// How often the profile is written to the telemetry log
+#define PROFILE_LOG_MS 1000
+
+using LatencyHistogram = HdrHistogram<PROFILE_SUB_BITS, PROFILE_MAX_BITS>;
+
+static_assert(LatencyHistogram::index(LatencyHistogram::MAX_VALUE) == LatencyHistogram::BUCKETS - 1,
+              "top value must land in the last bucket");
+static_assert(LatencyHistogram::upper(LatencyHistogram::index(1000)) >= 1000 &&
+              LatencyHistogram::upper(LatencyHistogram::index(1000) - 1) < 1000,
+              "a value must land in the bucket that covers it");
+
+class TickProfile {
+    public:
+        /**
+         * Marks the start of a tick, called as the input read begins. Closes
+         * out the tick before it into STAGE_TICK.
+         */
+        void begin_tick();
+
+        void record(TickStage s, std::uint32_t us) {
+            hist[s].record(us);
+        }
+
+        /**
+         * Notes the end of a motor write, the tick's latency runs to the last.
+         */
+        void wrote(std::uint64_t now) {
+            last_write = now;
+        }
+
+        const LatencyHistogram& stage(TickStage s) const {
+            return hist[s];
+        }
+
+        void reset();
+
+        /**
+         * Shows one stage per line from the given LLEMU line:
+         * name, p50, p99 and max in us.
+         */
+        void print(int first_line) const;
+
+        /**
+         * Pushes a TELEM_PROFILE record per stage to the log.
+         */
+        void log(TelemetryLog& log) const;
+
+    private:
+        LatencyHistogram hist[NUM_STAGES];
+        std::uint64_t tick_start = 0;
+        std::uint64_t last_write = 0;
+};
+
+// Times the enclosing scope as one stage
+class StageTimer {
+    public:
+        StageTimer(TickProfile& p, TickStage s) : prof(p), stage(s), start(pros::micros()) {}
+
+        ~StageTimer() {
+            std::uint64_t now = pros::micros();
+            prof.record(stage, now - start);
+            if (stage == STAGE_MOTOR_WRITE) {
+                prof.wrote(now);
+            }
+        }
+
+    private:
+        TickProfile& prof;
+        TickStage stage;
+        std::uint64_t start;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+
+// Velocity and acceleration from timestamped encoder counts.
+//
+// A smart motor samples its encoder every few ms and get_raw_position()
+// returns the count with the device time it was taken. get_actual_velocity()
+// is filtered on the motor and runs tens of ms behind, which a control loop
+// reads as lag. VelocityFit keeps the last N counts with their times and fits
+// a parabola through them by least squares: its slope and curvature at the
+// newest sample are the velocity and acceleration then, and the acceleration
+// carries the velocity forward to the time it is read. Because each count has
+// its own time, a missed or doubled read doesn't skew the estimate.
+
+struct MotionState {
+    float vel;                      // units/s at time_ms
+    float acc;                      // units/s^2
+    std::uint32_t time_ms;          // device time of the estimate, 0 = none yet
+
+    /**
+     * The velocity carried forward to t_ms, at most max_lead_ms past the
+     * estimate so a motor that stopped reporting doesn't run away.
+     */
+    float vel_at(std::uint32_t t_ms, std::uint32_t max_lead_ms) const {
+        std::int32_t lead = (std::int32_t)(t_ms - time_ms);
+        if (lead < 0) lead = 0;
+        if (lead > (std::int32_t)max_lead_ms) lead = max_lead_ms;
+        return vel + acc * (lead / 1000.0f);
+    }
+};
+
+template <int N>
+class VelocityFit {
+    static_assert(N >= 3, "a parabola needs three samples");
+
+    public:
+        void reset() {
+            count = 0;
+        }
+
+        /**
+         * Adds a count taken at device time t_ms. A sample no newer than the
+         * last one is a repeat read and is ignored.
+         *
+         * \return true if the sample was added
+         */
+        bool add(std::uint32_t t_ms, std::int32_t counts) {
+            if (count && (std::int32_t)(t_ms - t[head]) <= 0) {
+                return false;
+            }
+            head = (head + 1) % N;
+            t[head] = t_ms;
+            c[head] = counts;
+            if (count < N) {
+                count++;
+            }
+            return true;
+        }
+
+        int samples() const {
+            return count;
+        }
+
+        /**
+         * Velocity and acceleration in counts/s and counts/s^2 at the newest
+         * sample. Two samples give a slope and no acceleration, fewer give
+         * no estimate (time_ms 0).
+         */
+        MotionState fit() const {
+            if (count < 2) {
+                return {0, 0, 0};
+            }
+
+            // Times and counts relative to the newest sample, times scaled
+            // to the window so the sums stay well conditioned in float
+            int oldest = (head - count + 1 + N) % N;
+            float span = (float)(t[head] - t[oldest]);
+            float s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+            float y0 = 0, y1 = 0, y2 = 0;
+            for (int k = 0; k < count; k++) {
+                int i = (head - k + N) % N;
+                float u = -(float)(t[head] - t[i]) / span;
+                float y = (float)(c[i] - c[head]);
+                float u2 = u * u;
+                s0 += 1;
+                s1 += u;
+                s2 += u2;
+                s3 += u2 * u;
+                s4 += u2 * u2;
+                y0 += y;
+                y1 += y * u;
+                y2 += y * u2;
+            }
+
+            // y = a + b u + c u^2, solved from the normal equations
+            float b, cc;
+            if (count == 2) {
+                b = y1 / s2;
+                cc = 0;
+            } else {
+                float m00 = s2 * s4 - s3 * s3;
+                float m01 = s1 * s4 - s3 * s2;
+                float m02 = s1 * s3 - s2 * s2;
+                float det = s0 * m00 - s1 * m01 + s2 * m02;
+                b = (s0 * (y1 * s4 - s3 * y2) - y0 * m01 + s2 * (s1 * y2 - y1 * s2)) / det;
+                cc = (s0 * (s2 * y2 - y1 * s3) - s1 * (s1 * y2 - y1 * s2) + y0 * m02) / det;
+            }
+
+            float sec = span / 1000.0f;
+            return {b / sec, 2 * cc / (sec * sec), t[head]};
+        }
+
+    private:
+        std::uint32_t t[N] = {};
+        std::int32_t c[N] = {};
+        int head = N - 1;
+        int count = 0;
+};
@@ -0,0 +1,545 @@
+#include "sim.h"
+#include "pros/device.hpp"
+#include "pros/distance.hpp"
+#include "pros/error.h"
+#include "pros/gps.hpp"
+#include "pros/imu.hpp"
+#include "pros/misc.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "liblvgl/llemu.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+
+// Sensors, controller and LLEMU over the World.
+//
+// Motors and rotation sensors are plugged in when the program constructs
+// them, the IMU, GPS and distance sensors when the harness places them. Readings come from
+// what the device last published, and a device that isn't there returns
+// PROS_ERR / PROS_ERR_F with errno set like the real API.
+
+using sim::world;
+
+static bool valid(int port) {
+    if (port < 1 || port > sim::NUM_PORTS) {
+        errno = ENXIO;
+        return false;
+    }
+    return true;
+}
+
+static double wrap360(double deg) {
+    deg = std::fmod(deg, 360.0);
+    return deg < 0 ? deg + 360 : deg;
+}
+
+namespace pros {
+inline namespace v5 {
+
+// DEVICE
+
+Device::Device(const std::uint8_t port) : _port(port) {}
+
+std::uint8_t Device::get_port(void) const {
+    return _port;
+}
+
+DeviceType Device::get_plugged_type(std::uint8_t port) {
+    if (!valid(port)) return DeviceType::undefined;
+    sim::World& w = world();
+    if (w.motor[port].present) return DeviceType::motor;
+    if (w.imu[port].present) return DeviceType::imu;
+    if (w.gps[port].present) return DeviceType::gps;
+    if (w.distance[port].present) return DeviceType::distance;
+    if (w.rotation[port].present) return DeviceType::rotation;
+    return DeviceType::none;
+}
+
+DeviceType Device::get_plugged_type() const {
+    return get_plugged_type(_port);
+}
+
+std::vector<Device> Device::get_all_devices(DeviceType device_type) {
+    std::vector<Device> out;
+    for (int p = 1; p <= sim::NUM_PORTS; p++) {
+        DeviceType t = get_plugged_type(p);
+        if (t != DeviceType::none && (device_type == DeviceType::undefined || t == device_type)) {
+            out.emplace_back(p);
+        }
+    }
+    return out;
+}
+
+bool Device::is_installed() {
+    return get_plugged_type(_port) == _deviceType;
+}
+
+// IMU
+
+static sim::SimImu* imu_at(std::uint8_t port) {
+    if (!valid(port)) return nullptr;
+    sim::SimImu* s = &world().imu[port];
+    if (!s->present) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    if (s->calibrating && world().millis() >= s->calibrated_ms) {
+        // Calibration ends with the rotation at 0 wherever the robot points
+        s->calibrating = false;
+        s->offset = s->seen_rotation;
+    }
+    if (s->calibrating) {
+        errno = EAGAIN;
+        return nullptr;
+    }
+    return s;
+}
+
+std::int32_t Imu::reset(bool blocking) const {
+    if (!valid(_port)) return PROS_ERR;
+    sim::SimImu& s = world().imu[_port];
+    if (!s.present) {
+        errno = ENODEV;
+        return PROS_ERR;
+    }
+    s.calibrating = true;
+    s.calibrated_ms = world().millis() + 2000;
+    if (blocking) {
+        c::delay(2000);
+        imu_at(_port);
+    }
+    return 1;
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t) const {
+    return imu_at(_port) ? 1 : PROS_ERR;
+}
+
+double Imu::get_rotation() const {
+    sim::SimImu* s = imu_at(_port);
+    return s ? s->seen_rotation - s->offset : PROS_ERR_F;
+}
+
+double Imu::get_heading() const {
+    double r = get_rotation();
+    return std::isfinite(r) ? wrap360(r) : PROS_ERR_F;
+}
+
+double Imu::get_yaw() const {
+    double h = get_heading();
+    return std::isfinite(h) ? (h > 180 ? h - 360 : h) : PROS_ERR_F;
+}
+
+double Imu::get_pitch() const {
+    return imu_at(_port) ? 0 : PROS_ERR_F;
+}
+
+double Imu::get_roll() const {
+    return imu_at(_port) ? 0 : PROS_ERR_F;
+}
+
+euler_s_t Imu::get_euler() const {
+    return {get_pitch(), get_roll(), get_yaw()};
+}
+
+quaternion_s_t Imu::get_quaternion() const {
+    double yaw = get_yaw();
+    if (!std::isfinite(yaw)) {
+        return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    }
+    double h = -yaw * M_PI / 360;
+    return {0, 0, std::sin(h), std::cos(h)};
+}
+
+imu_gyro_s_t Imu::get_gyro_rate() const {
+    sim::SimImu* s = imu_at(_port);
+    if (!s) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, s->seen_rate};
+}
+
+imu_accel_s_t Imu::get_accel() const {
+    if (!imu_at(_port)) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, 1};
+}
+
+std::int32_t Imu::set_rotation(const double target) const {
+    sim::SimImu* s = imu_at(_port);
+    if (!s) return PROS_ERR;
+    s->offset = s->seen_rotation - target;
+    return 1;
+}
+
+std::int32_t Imu::set_heading(const double target) const {
+    return set_rotation(target);
+}
+
+std::int32_t Imu::set_yaw(const double target) const {
+    return set_rotation(target);
+}
+
+std::int32_t Imu::set_pitch(const double) const {
+    return imu_at(_port) ? 1 : PROS_ERR;
+}
+
+std::int32_t Imu::set_roll(const double) const {
+    return imu_at(_port) ? 1 : PROS_ERR;
+}
+
+std::int32_t Imu::set_euler(const euler_s_t target) const {
+    return set_rotation(target.yaw);
+}
+
+std::int32_t Imu::tare_rotation() const { return set_rotation(0); }
+std::int32_t Imu::tare_heading() const { return set_rotation(0); }
+std::int32_t Imu::tare_yaw() const { return set_rotation(0); }
+std::int32_t Imu::tare_pitch() const { return set_pitch(0); }
+std::int32_t Imu::tare_roll() const { return set_roll(0); }
+std::int32_t Imu::tare_euler() const { return set_rotation(0); }
+std::int32_t Imu::tare() const { return set_rotation(0); }
+
+ImuStatus Imu::get_status() const {
+    if (!valid(_port)) return ImuStatus::error;
+    return imu_at(_port) ? ImuStatus::ready : ImuStatus::calibrating;
+}
+
+bool Imu::is_calibrating() const {
+    return get_status() == ImuStatus::calibrating;
+}
+
+imu_orientation_e_t Imu::get_physical_orientation() const {
+    return E_IMU_Z_UP;
+}
+
+// GPS
+
+static sim::SimGps* gps_at(std::uint8_t port) {
+    if (!valid(port)) return nullptr;
+    sim::SimGps* s = &world().gps[port];
+    if (!s->present) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return s;
+}
+
+std::int32_t Gps::initialize_full(double, double, double, double xOffset, double yOffset) const {
+    return set_offset(xOffset, yOffset);
+}
+
+std::int32_t Gps::set_offset(double xOffset, double yOffset) const {
+    sim::SimGps* s = gps_at(_port);
+    if (!s) return PROS_ERR;
+    s->offset_x = xOffset;
+    s->offset_y = yOffset;
+    return 1;
+}
+
+gps_position_s_t Gps::get_offset() const {
+    sim::SimGps* s = gps_at(_port);
+    if (!s) return {PROS_ERR_F, PROS_ERR_F};
+    return {s->offset_x, s->offset_y};
+}
+
+// The sensor finds itself from the field strip, the initial guess only
+// matters on the real one
+std::int32_t Gps::set_position(double, double, double) const {
+    return gps_at(_port) ? 1 : PROS_ERR;
+}
+
+std::int32_t Gps::set_data_rate(std::uint32_t) const {
+    return gps_at(_port) ? 1 : PROS_ERR;
+}
+
+double Gps::get_error() const {
+    sim::SimGps* s = gps_at(_port);
+    return s ? s->noise : PROS_ERR_F;
+}
+
+gps_status_s_t Gps::get_position_and_orientation() const {
+    sim::SimGps* s = gps_at(_port);
+    if (!s) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    double yaw = s->seen_heading > 180 ? s->seen_heading - 360 : s->seen_heading;
+    return {s->seen_x, s->seen_y, 0, 0, yaw};
+}
+
+gps_position_s_t Gps::get_position() const {
+    gps_status_s_t st = get_position_and_orientation();
+    return {st.x, st.y};
+}
+
+double Gps::get_position_x() const { return get_position().x; }
+double Gps::get_position_y() const { return get_position().y; }
+
+gps_orientation_s_t Gps::get_orientation() const {
+    gps_status_s_t st = get_position_and_orientation();
+    return {st.pitch, st.roll, st.yaw};
+}
+
+double Gps::get_pitch() const { return get_orientation().pitch; }
+double Gps::get_roll() const { return get_orientation().roll; }
+double Gps::get_yaw() const { return get_orientation().yaw; }
+
+double Gps::get_heading() const {
+    sim::SimGps* s = gps_at(_port);
+    return s ? s->seen_heading : PROS_ERR_F;
+}
+
+double Gps::get_heading_raw() const {
+    return get_heading();
+}
+
+gps_gyro_s_t Gps::get_gyro_rate() const {
+    if (!gps_at(_port)) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, world().drive.omega * 180 / M_PI};
+}
+
+double Gps::get_gyro_rate_x() const { return get_gyro_rate().x; }
+double Gps::get_gyro_rate_y() const { return get_gyro_rate().y; }
+double Gps::get_gyro_rate_z() const { return get_gyro_rate().z; }
+
+gps_accel_s_t Gps::get_accel() const {
+    if (!gps_at(_port)) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, 1};
+}
+
+double Gps::get_accel_x() const { return get_accel().x; }
+double Gps::get_accel_y() const { return get_accel().y; }
+double Gps::get_accel_z() const { return get_accel().z; }
+
+// DISTANCE
+
+Distance::Distance(const std::uint8_t port) : Device(port, DeviceType::distance) {}
+
+static sim::SimDistance* distance_at(std::uint8_t port) {
+    if (!valid(port)) return nullptr;
+    sim::SimDistance* s = &world().distance[port];
+    if (!s->present) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return s;
+}
+
+std::int32_t Distance::get() {
+    return get_distance();
+}
+
+std::int32_t Distance::get_distance() {
+    sim::SimDistance* s = distance_at(_port);
+    return s ? s->seen_mm : PROS_ERR;
+}
+
+std::int32_t Distance::get_confidence() {
+    sim::SimDistance* s = distance_at(_port);
+    return s ? s->seen_confidence : PROS_ERR;
+}
+
+// Walls fill the field of view, the largest size the sensor reports
+std::int32_t Distance::get_object_size() {
+    sim::SimDistance* s = distance_at(_port);
+    if (!s) return PROS_ERR;
+    return s->seen_mm == 9999 ? -1 : 400;
+}
+
+double Distance::get_object_velocity() {
+    return distance_at(_port) ? 0 : PROS_ERR_F;
+}
+
+// ROTATION
+
+Rotation::Rotation(const std::int8_t port) : Device(std::abs(port), DeviceType::rotation) {
+    if (valid(_port)) {
+        world().rotation[_port].present = true;
+        world().rotation[_port].reversed = port < 0;
+    }
+}
+
+static sim::SimRotation* rotation_at(std::uint8_t port) {
+    if (!valid(port)) return nullptr;
+    sim::SimRotation* s = &world().rotation[port];
+    if (!s->present) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return s;
+}
+
+// Centidegrees, in the sensor's configured direction
+static double rotation_cdeg(const sim::SimRotation& s, double turns) {
+    return (s.reversed ? -1 : 1) * turns * 36000;
+}
+
+std::int32_t Rotation::reset() {
+    return reset_position();
+}
+
+std::int32_t Rotation::set_data_rate(std::uint32_t) const {
+    return rotation_at(_port) ? 1 : PROS_ERR;
+}
+
+std::int32_t Rotation::set_position(std::int32_t position) const {
+    sim::SimRotation* s = rotation_at(_port);
+    if (!s) return PROS_ERR;
+    s->zero = s->seen_turns - (s->reversed ? -1 : 1) * position / 36000.0;
+    return 1;
+}
+
+std::int32_t Rotation::reset_position(void) const {
+    return set_position(0);
+}
+
+std::int32_t Rotation::get_position() const {
+    sim::SimRotation* s = rotation_at(_port);
+    return s ? (std::int32_t)std::lround(rotation_cdeg(*s, s->seen_turns - s->zero)) : PROS_ERR;
+}
+
+std::int32_t Rotation::get_velocity() const {
+    sim::SimRotation* s = rotation_at(_port);
+    return s ? (std::int32_t)std::lround(rotation_cdeg(*s, s->seen_rate)) : PROS_ERR;
+}
+
+std::int32_t Rotation::get_angle() const {
+    sim::SimRotation* s = rotation_at(_port);
+    if (!s) return PROS_ERR;
+    return (std::int32_t)std::lround(wrap360(rotation_cdeg(*s, s->seen_turns) / 100) * 100) % 36000;
+}
+
+std::int32_t Rotation::set_reversed(bool value) const {
+    sim::SimRotation* s = rotation_at(_port);
+    if (!s) return PROS_ERR;
+    s->reversed = value;
+    return 1;
+}
+
+std::int32_t Rotation::reverse() const {
+    sim::SimRotation* s = rotation_at(_port);
+    return s ? set_reversed(!s->reversed) : PROS_ERR;
+}
+
+std::int32_t Rotation::get_reversed() const {
+    sim::SimRotation* s = rotation_at(_port);
+    return s ? s->reversed : PROS_ERR;
+}
+
+// CONTROLLER
+
+Controller::Controller(controller_id_e_t id) : _id(id) {}
+
+std::int32_t Controller::is_connected(void) {
+    return _id == E_CONTROLLER_MASTER;
+}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) {
+    if (_id != E_CONTROLLER_MASTER || channel < 0 || channel > 3) return PROS_ERR;
+    return world().axis[channel];
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) {
+    if (_id != E_CONTROLLER_MASTER || button < E_CONTROLLER_DIGITAL_L1) return PROS_ERR;
+    return (world().buttons >> (button - E_CONTROLLER_DIGITAL_L1)) & 1;
+}
+
+// Edge state per button for the _new_ functions, like the real per-task one
+static std::uint16_t seen_down;
+static std::uint16_t seen_up;
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) {
+    std::int32_t down = get_digital(button);
+    if (down == PROS_ERR) return PROS_ERR;
+    std::uint16_t bit = 1u << (button - E_CONTROLLER_DIGITAL_L1);
+    bool edge = down && !(seen_down & bit);
+    seen_down = down ? seen_down | bit : seen_down & ~bit;
+    return edge;
+}
+
+std::int32_t Controller::get_digital_new_release(controller_digital_e_t button) {
+    std::int32_t down = get_digital(button);
+    if (down == PROS_ERR) return PROS_ERR;
+    std::uint16_t bit = 1u << (button - E_CONTROLLER_DIGITAL_L1);
+    bool edge = !down && (seen_up & bit);
+    seen_up = down ? seen_up | bit : seen_up & ~bit;
+    return edge;
+}
+
+std::int32_t Controller::get_battery_capacity(void) { return 100; }
+std::int32_t Controller::get_battery_level(void) { return 100; }
+std::int32_t Controller::set_text(std::uint8_t, std::uint8_t, const char*) { return 1; }
+std::int32_t Controller::set_text(std::uint8_t, std::uint8_t, const std::string&) { return 1; }
+std::int32_t Controller::clear_line(std::uint8_t) { return 1; }
+std::int32_t Controller::rumble(const char*) { return 1; }
+std::int32_t Controller::clear(void) { return 1; }
+
+}  // namespace v5
+
+namespace c {
+
+int32_t controller_print(controller_id_e_t, uint8_t, uint8_t, const char*, ...) {
+    return 1;
+}
+
+}  // namespace c
+
+// LLEMU, kept as text so the harness can show it
+
+namespace lcd {
+
+static bool lcd_on = false;
+
+bool is_initialized(void) { return lcd_on; }
+
+bool initialize(void) {
+    lcd_on = true;
+    return true;
+}
+
+bool shutdown(void) {
+    lcd_on = false;
+    return true;
+}
+
+bool set_text(std::int16_t line, std::string text) {
+    if (line < 0 || line > 7) return false;
+    world().lcd[line] = text;
+    return true;
+}
+
+bool clear_line(std::int16_t line) {
+    return set_text(line, "");
+}
+
+bool clear(void) {
+    for (std::string& s : world().lcd) s.clear();
+    return true;
+}
+
+void register_btn0_cb(lcd_btn_cb_fn_t cb) { world().lcd_button[0] = cb; }
+void register_btn1_cb(lcd_btn_cb_fn_t cb) { world().lcd_button[1] = cb; }
+void register_btn2_cb(lcd_btn_cb_fn_t cb) { world().lcd_button[2] = cb; }
+
+std::uint8_t read_buttons(void) { return 0; }
+
+}  // namespace lcd
+
+namespace c {
+
+bool lcd_print(int16_t line, const char* fmt, ...) {
+    char buf[128];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    return lcd::set_text(line, buf);
+}
+
+bool lcd_set_text(int16_t line, const char* text) {
+    return lcd::set_text(line, text);
+}
+
+bool lcd_clear_line(int16_t line) {
+    return lcd::clear_line(line);
+}
+
+}  // namespace c
+}  // namespace pros
@@ -0,0 +1,354 @@
+#include "sim.h"
+#include "pros/rtos.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+// Virtual-time task kernel.
+//
+// Each PROS task is a host thread, but only the one holding the baton runs.
+// When it blocks in a delay it hands the baton to the task with the earliest
+// wake time, ties going to higher priority and then round robin like the
+// FreeRTOS scheduler. If that wake time is in the future the clock jumps
+// there and the physics catches up in fixed steps first. Nothing ever sleeps
+// on the host clock, so runs go as fast as the code executes.
+
+namespace sim {
+
+struct Task {
+    std::condition_variable cv;
+    std::uint64_t wake = 0;
+    std::uint64_t turn = 0;
+    std::uint32_t prio = TASK_PRIORITY_DEFAULT;
+    std::uint32_t notify = 0;
+    bool done = false;
+    std::string name;
+    pros::task_fn_t fn = nullptr;
+    void* param = nullptr;
+};
+
+struct Mutex {
+    Task* owner = nullptr;
+    int depth = 0;
+};
+
+static std::mutex baton;
+static std::vector<Task*> tasks;
+static Task* running = nullptr;
+static std::uint64_t turns = 0;
+
+void exit(int code) {
+    std::fflush(stdout);
+    std::fflush(stderr);
+    std::_Exit(code);
+}
+
+// Gives up the baton and returns once this task has it again. Caller holds
+// the lock and has already set its wake time (or marked itself done).
+static void reschedule(Task* self, std::unique_lock<std::mutex>& lk) {
+    self->turn = ++turns;
+
+    Task* next = nullptr;
+    for (Task* t : tasks) {
+        if (t->done) {
+            continue;
+        }
+        if (!next || t->wake < next->wake ||
+            (t->wake == next->wake &&
+             (t->prio > next->prio || (t->prio == next->prio && t->turn < next->turn)))) {
+            next = t;
+        }
+    }
+    if (!next) {
+        exit(0);
+    }
+
+    if (next->wake > world().time_us) {
+        world().advance_to(next->wake);
+    }
+
+    running = next;
+    if (next != self) {
+        next->cv.notify_one();
+        self->cv.wait(lk, [self] { return running == self && !self->done; });
+    }
+}
+
+static void sleep_until(std::uint64_t us) {
+    std::unique_lock<std::mutex> lk(baton);
+    Task* self = running;
+    self->wake = us > world().time_us ? us : world().time_us;
+    reschedule(self, lk);
+}
+
+static void task_main(Task* t) {
+    {
+        std::unique_lock<std::mutex> lk(baton);
+        t->cv.wait(lk, [t] { return running == t; });
+    }
+    t->fn(t->param);
+
+    std::unique_lock<std::mutex> lk(baton);
+    t->done = true;
+    reschedule(t, lk);
+}
+
+void boot() {
+    std::lock_guard<std::mutex> lk(baton);
+    Task* t = new Task;
+    t->name = "main";
+    tasks.push_back(t);
+    running = t;
+}
+
+}  // namespace sim
+
+namespace pros {
+namespace c {
+
+using sim::running;
+
+uint32_t millis(void) {
+    return sim::world().millis();
+}
+
+uint64_t micros(void) {
+    return sim::world().time_us;
+}
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t,
+                   const char* const name) {
+    std::lock_guard<std::mutex> lk(sim::baton);
+    sim::Task* t = new sim::Task;
+    t->fn = function;
+    t->param = parameters;
+    t->prio = prio;
+    t->name = name ? name : "";
+    t->wake = sim::world().time_us;
+    t->turn = ++sim::turns;
+    sim::tasks.push_back(t);
+    std::thread(sim::task_main, t).detach();
+    return t;
+}
+
+void task_delete(task_t task) {
+    std::unique_lock<std::mutex> lk(sim::baton);
+    sim::Task* t = task ? static_cast<sim::Task*>(task) : running;
+    t->done = true;
+    if (t == running) {
+        // Never returns, the thread stays parked until the process exits
+        sim::reschedule(t, lk);
+    }
+}
+
+void task_delay(const uint32_t milliseconds) {
+    sim::sleep_until(sim::world().time_us + milliseconds * 1000ull);
+}
+
+void delay(const uint32_t milliseconds) {
+    task_delay(milliseconds);
+}
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+    *prev_time += delta;
+    // Already late: return at once like FreeRTOS, the loop catches up
+    if ((int32_t)(*prev_time - millis()) <= 0) {
+        return;
+    }
+    sim::sleep_until(*prev_time * 1000ull);
+}
+
+uint32_t task_get_priority(task_t task) {
+    return (task ? static_cast<sim::Task*>(task) : running)->prio;
+}
+
+void task_set_priority(task_t task, uint32_t prio) {
+    (task ? static_cast<sim::Task*>(task) : running)->prio = prio;
+}
+
+uint32_t task_get_count(void) {
+    uint32_t n = 0;
+    for (sim::Task* t : sim::tasks) {
+        n += !t->done;
+    }
+    return n;
+}
+
+char* task_get_name(task_t task) {
+    return (char*)(task ? static_cast<sim::Task*>(task) : running)->name.c_str();
+}
+
+task_t task_get_current() {
+    return running;
+}
+
+uint32_t task_notify(task_t task) {
+    static_cast<sim::Task*>(task)->notify++;
+    return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+    sim::Task* self = running;
+    uint32_t end = millis() + timeout;
+    while (self->notify == 0 && (int32_t)(end - millis()) > 0) {
+        task_delay(1);
+    }
+    uint32_t v = self->notify;
+    self->notify = clear_on_exit ? 0 : (v ? v - 1 : 0);
+    return v;
+}
+
+bool task_notify_clear(task_t task) {
+    sim::Task* t = static_cast<sim::Task*>(task);
+    bool was = t->notify != 0;
+    t->notify = 0;
+    return was;
+}
+
+// Only the task holding the baton runs, so a mutex is just an owner field.
+// Waiting polls once per millisecond of simulated time.
+mutex_t mutex_create(void) {
+    return new sim::Mutex;
+}
+
+mutex_t mutex_recursive_create(void) {
+    return new sim::Mutex;
+}
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+    sim::Mutex* m = static_cast<sim::Mutex*>(mutex);
+    uint32_t end = millis() + timeout;
+    while (m->owner && m->owner != running) {
+        if (timeout != TIMEOUT_MAX && (int32_t)(end - millis()) <= 0) {
+            return false;
+        }
+        task_delay(1);
+    }
+    m->owner = running;
+    m->depth++;
+    return true;
+}
+
+bool mutex_give(mutex_t mutex) {
+    sim::Mutex* m = static_cast<sim::Mutex*>(mutex);
+    if (m->owner != running) {
+        return false;
+    }
+    if (--m->depth == 0) {
+        m->owner = nullptr;
+    }
+    return true;
+}
+
+bool mutex_recursive_take(mutex_t mutex, uint32_t timeout) {
+    return mutex_take(mutex, timeout);
+}
+
+bool mutex_recursive_give(mutex_t mutex) {
+    return mutex_give(mutex);
+}
+
+void mutex_delete(mutex_t mutex) {
+    delete static_cast<sim::Mutex*>(mutex);
+}
+
+}  // namespace c
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth,
+           const char* name) {
+    task = c::task_create(function, parameters, prio, stack_depth, name);
+}
+
+Task::Task(task_fn_t function, void* parameters, const char* name)
+    : Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+Task::Task(task_t t) : task(t) {}
+
+Task Task::current() {
+    return Task(c::task_get_current());
+}
+
+void Task::remove() {
+    c::task_delete(task);
+}
+
+std::uint32_t Task::get_priority() {
+    return c::task_get_priority(task);
+}
+
+void Task::set_priority(std::uint32_t prio) {
+    c::task_set_priority(task, prio);
+}
+
+const char* Task::get_name() {
+    return c::task_get_name(task);
+}
+
+std::uint32_t Task::notify() {
+    return c::task_notify(task);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    return c::task_notify_take(clear_on_exit, timeout);
+}
+
+bool Task::notify_clear() {
+    return c::task_notify_clear(task);
+}
+
+void Task::delay(const std::uint32_t milliseconds) {
+    c::task_delay(milliseconds);
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count() {
+    return c::task_get_count();
+}
+
+Clock::time_point Clock::now() {
+    return time_point{duration{c::millis()}};
+}
+
+mutex_t Mutex::lazy_init() {
+    mutex_t m = mutex.load();
+    if (!m) {
+        m = c::mutex_create();
+        mutex.store(m);
+    }
+    return m;
+}
+
+bool Mutex::take() {
+    return c::mutex_take(lazy_init(), TIMEOUT_MAX);
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+    return c::mutex_take(lazy_init(), timeout);
+}
+
+bool Mutex::give() {
+    return c::mutex_give(lazy_init());
+}
+
+void Mutex::lock() {
+    take();
+}
+
+void Mutex::unlock() {
+    give();
+}
+
+bool Mutex::try_lock() {
+    return take(0);
+}
+
+Mutex::~Mutex() {
+    c::mutex_delete(mutex.load());
+}
+
+}  // namespace pros
@@ -0,0 +1,378 @@
+// Simulator entry point.
+//
+// Binds the program's devices from globals.cpp to the physics, runs
+// initialize() and then autonomous() or opcontrol() in a competition task,
+// and reports how the pose estimates did against the true pose. A driver
+// run replays a controller script (built in, or --input).
+//
+//   bin/robot_sim --auton --start -60,-24,90
+//   bin/robot_sim --driver --input drive.csv --trace out.csv
+//
+// The match period ends with disabled(), like on the field. /usd/ is the
+// directory given by --usd, --jam wedges the main intake rollers, --push
+// holds the robot still against something it can't move, --slip spins the
+// wheels without moving it, --unplug pulls a motor's cable for a while and
+// --drift makes the IMU drift more. --sysid picks the characterization on
+// the screen before autonomous, like a driver would on the brain.
+// --opponent puts another robot on the field partway through, handed to the
+// navigator as if the robot had seen it.
+
+#include "sim.h"
+#include "globals.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using sim::ControllerFrame;
+
+constexpr float IN_PER_M = 39.3701f;
+
+struct Options {
+    bool auton = false;
+    bool sysid = false;
+    float seconds = 0;              // 0 = the match period for the mode
+    float start[3] = {0, 0, 0};     // in, in, deg
+    const char* input = nullptr;
+    const char* trace = nullptr;
+    bool gps = true;
+    bool dist = true;
+    float drift = 0;                // extra IMU drift, deg/s
+    bool lcd = false;
+    std::uint32_t seed = 1;
+    float jam[2] = {0, 0};          // s into the match, s long
+    float push[2] = {0, 0};
+    float slip[2] = {0, 0};
+    int unplug_port = 0;
+    float unplug[2] = {0, 0};
+    float opponent[3] = {0, 0, -1}; // in, in, s into the match it shows up
+};
+
+constexpr float OPPONENT_RADIUS = 9;    // in
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: robot_sim [--auton | --driver] [--time s] [--start x,y,deg]\n"
+                 "                 [--input script.csv] [--trace out.csv] [--seed n]\n"
+                 "                 [--usd dir] [--jam start,len] [--push start,len] [--slip start,len]\n"
+                 "                 [--unplug port,start,len] [--no-gps] [--no-dist]\n"
+                 "                 [--drift deg_per_s] [--sysid] [--lcd] [--opponent x,y,start]\n"
+                 "  script lines: ms,left_x,left_y,right_x,right_y,buttons (BTN_BIT hex)\n");
+    std::exit(2);
+}
+
+static Options parse(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool more = i + 1 < argc;
+        if (!std::strcmp(a, "--auton")) o.auton = true;
+        else if (!std::strcmp(a, "--driver")) o.auton = false;
+        else if (!std::strcmp(a, "--no-gps")) o.gps = false;
+        else if (!std::strcmp(a, "--no-dist")) o.dist = false;
+        else if (!std::strcmp(a, "--drift") && more) o.drift = std::atof(argv[++i]);
+        else if (!std::strcmp(a, "--lcd")) o.lcd = true;
+        else if (!std::strcmp(a, "--sysid")) o.sysid = o.auton = true;
+        else if (!std::strcmp(a, "--time") && more) o.seconds = std::atof(argv[++i]);
+        else if (!std::strcmp(a, "--input") && more) o.input = argv[++i];
+        else if (!std::strcmp(a, "--trace") && more) o.trace = argv[++i];
+        else if (!std::strcmp(a, "--usd") && more) sim::usd_dir = argv[++i];
+        else if (!std::strcmp(a, "--seed") && more) o.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(a, "--jam") && more) {
+            if (std::sscanf(argv[++i], "%f,%f", &o.jam[0], &o.jam[1]) != 2) usage();
+        } else if (!std::strcmp(a, "--opponent") && more) {
+            if (std::sscanf(argv[++i], "%f,%f,%f", &o.opponent[0], &o.opponent[1], &o.opponent[2]) != 3) usage();
+        } else if (!std::strcmp(a, "--unplug") && more) {
+            if (std::sscanf(argv[++i], "%d,%f,%f", &o.unplug_port, &o.unplug[0], &o.unplug[1]) != 3) usage();
+            if (o.unplug_port < 1 || o.unplug_port > sim::NUM_PORTS) usage();
+        } else if (!std::strcmp(a, "--push") && more) {
+            if (std::sscanf(argv[++i], "%f,%f", &o.push[0], &o.push[1]) != 2) usage();
+        } else if (!std::strcmp(a, "--slip") && more) {
+            if (std::sscanf(argv[++i], "%f,%f", &o.slip[0], &o.slip[1]) != 2) usage();
+        } else if (!std::strcmp(a, "--start") && more) {
+            if (std::sscanf(argv[++i], "%f,%f,%f", &o.start[0], &o.start[1], &o.start[2]) != 3) usage();
+        } else usage();
+    }
+    return o;
+}
+
+// Drive forward, arc with the intake running, spin, reverse out of a jam
+static std::vector<ControllerFrame> default_script() {
+    const std::uint16_t R1 = BTN_BIT(E_CONTROLLER_DIGITAL_R1);
+    const std::uint16_t R2 = BTN_BIT(E_CONTROLLER_DIGITAL_R2);
+    return {
+        {0, {0, 0, 0, 0}, 0},
+        {500, {0, 127, 0, 0}, 0},
+        {2000, {0, 100, 40, 0}, R1},
+        {4000, {0, 0, 90, 0}, R1},
+        {5000, {0, -80, 0, 0}, R2},
+        {6500, {0, 0, 0, 0}, 0},
+    };
+}
+
+static std::vector<ControllerFrame> load_script(const char* path) {
+    std::FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::perror(path);
+        std::exit(1);
+    }
+    std::vector<ControllerFrame> out;
+    char line[256];
+    while (std::fgets(line, sizeof(line), f)) {
+        unsigned t, buttons;
+        int ax[4];
+        if (std::sscanf(line, "%u,%d,%d,%d,%d,%x", &t, &ax[0], &ax[1], &ax[2], &ax[3], &buttons) == 6) {
+            ControllerFrame fr = {t, {}, (std::uint16_t)buttons};
+            for (int i = 0; i < 4; i++) fr.axis[i] = (std::int8_t)ax[i];
+            out.push_back(fr);
+        }
+    }
+    std::fclose(f);
+    return out;
+}
+
+static void run_mode(void* param) {
+    if (*static_cast<bool*>(param)) {
+        autonomous();
+    } else {
+        opcontrol();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt = parse(argc, argv);
+    sim::World& w = sim::world();
+    w.seed = opt.seed;
+
+    // The robot as wired in globals.cpp
+    w.bind_drive(mgL.get_port_all(), sim::Load::drive_left);
+    w.bind_drive(mgR.get_port_all(), sim::Load::drive_right);
+    w.imu[imu.get_port()].present = true;
+    w.imu[imu.get_port()].drift += opt.drift;
+    w.gps[gps.get_port()].present = opt.gps;
+    for (std::size_t i = 0; i < mcl.sensor_count(); i++) {
+        const DistanceMount& m = mcl.mount(i);
+        sim::SimDistance& d = w.distance[m.port];
+        d.present = opt.dist;
+        d.forward = m.forward;
+        d.right = m.right;
+        d.angle = m.angle;
+    }
+    w.place(opt.start[0], opt.start[1], opt.start[2]);
+
+    sim::boot();
+    auto wall = std::chrono::steady_clock::now();
+
+    initialize();
+    if (opt.sysid) {
+        competition_initialize();
+        if (w.lcd_button[2]) {
+            w.lcd_button[2]();
+        }
+    }
+
+    // Script times count from the start of the match period
+    std::uint32_t t0 = pros::millis();
+    w.script = opt.input ? load_script(opt.input) : default_script();
+    for (ControllerFrame& f : w.script) f.time_ms += t0;
+
+    pros::task_t match = pros::c::task_create(run_mode, &opt.auton, TASK_PRIORITY_DEFAULT,
+                                              TASK_STACK_DEPTH_DEFAULT, "competition");
+
+    std::FILE* trace = opt.trace ? std::fopen(opt.trace, "w") : nullptr;
+    if (trace) {
+        std::fprintf(trace, "t_ms,x,y,theta,odom_x,odom_y,odom_theta,loc_x,loc_y,loc_theta,v,omega\n");
+    }
+
+    float seconds = opt.seconds > 0 ? opt.seconds : opt.sysid ? 30 : opt.auton ? 15 : 105;
+    std::uint32_t end = t0 + (std::uint32_t)(seconds * 1000);
+    float max_err = 0;
+    std::uint32_t wake = t0;
+
+    // A block wedged in the main rollers for the --jam window
+    std::vector<std::int8_t> jam_ports = mgIN.get_port_all();
+    jam_ports.push_back(mtIN3.get_port());
+    std::uint32_t jam_from = t0 + (std::uint32_t)(opt.jam[0] * 1000);
+    std::uint32_t jam_to = jam_from + (std::uint32_t)(opt.jam[1] * 1000);
+
+    // Force the drive puts into whatever it is pinned against for --push
+    std::uint32_t push_from = t0 + (std::uint32_t)(opt.push[0] * 1000);
+    std::uint32_t push_to = push_from + (std::uint32_t)(opt.push[1] * 1000);
+    double push_force = 0;
+    int push_samples = 0;
+
+    // Wheels spinning without moving the robot for --slip, what the odometry
+    // can't see and the distance sensors can
+    std::uint32_t slip_from = t0 + (std::uint32_t)(opt.slip[0] * 1000);
+    std::uint32_t slip_to = slip_from + (std::uint32_t)(opt.slip[1] * 1000);
+
+    // Left drive speed as the estimator and the motors' own reading have it,
+    // against the true speed
+    std::vector<std::int8_t> left_ports = mgL.get_port_all();
+    double est_sq = 0;
+    double actual_sq = 0;
+    int speed_samples = 0;
+
+    std::uint32_t unplug_from = t0 + (std::uint32_t)(opt.unplug[0] * 1000);
+    std::uint32_t unplug_to = unplug_from + (std::uint32_t)(opt.unplug[1] * 1000);
+
+    // How close the robot came to the opponent once it was there
+    std::uint32_t opponent_from = t0 + (std::uint32_t)(opt.opponent[2] * 1000);
+    bool opponent_in = false;
+    float opponent_first = 0;
+    float opponent_closest = INFINITY;
+
+    while ((std::int32_t)(pros::millis() - end) < 0) {
+        pros::c::task_delay_until(&wake, 10);
+
+        bool jammed = opt.jam[1] > 0 && pros::millis() >= jam_from && pros::millis() < jam_to;
+        for (std::int8_t p : jam_ports) {
+            w.motor[std::abs(p)].roller.jammed = jammed;
+        }
+
+        if (opt.unplug_port) {
+            bool out = pros::millis() >= unplug_from && pros::millis() < unplug_to;
+            w.set_plugged(opt.unplug_port, !out);
+        }
+
+        if (opt.opponent[2] >= 0 && pros::millis() >= opponent_from) {
+            float dist = std::hypot(w.drive.x * IN_PER_M - opt.opponent[0], w.drive.y * IN_PER_M - opt.opponent[1]);
+            if (!opponent_in) {
+                nav.block(0, opt.opponent[0], opt.opponent[1], OPPONENT_RADIUS);
+                opponent_in = true;
+                opponent_first = dist;
+            }
+            opponent_closest = std::fmin(opponent_closest, dist);
+        }
+
+        w.drive.slipping = opt.slip[1] > 0 && pros::millis() >= slip_from && pros::millis() < slip_to;
+        w.drive.pinned = opt.push[1] > 0 && pros::millis() >= push_from && pros::millis() < push_to;
+        if (w.drive.pinned) {
+            float torque = 0;
+            for (int p = 1; p <= sim::NUM_PORTS; p++) {
+                const sim::SimMotor& m = w.motor[p];
+                if (m.present && m.load != sim::Load::roller) {
+                    torque += m.mount * m.torque;
+                }
+            }
+            push_force += torque / w.drive.ratio / w.drive.wheel_radius;
+            push_samples++;
+        }
+
+        // All in raw counts/s, the motor's reading is per turn of the
+        // cartridge it is set to
+        float true_cps = 0;
+        float actual_cps = 0;
+        int plugged = 0;
+        for (std::int8_t p : left_ports) {
+            const sim::SimMotor& m = w.motor[std::abs(p)];
+            if (!m.present) {
+                continue;
+            }
+            plugged++;
+            float ticks = m.gearset == 0 ? 1800 : m.gearset == 1 ? 900 : 300;
+            true_cps += (p < 0 ? -1 : 1) * m.speed / (2 * (float)M_PI) * m.ticks_per_rev;
+            actual_cps += pros::c::motor_get_actual_velocity(p) * ticks / 60;
+        }
+        MotionState est = motion.group(MOTION_LEFT);
+        if (est.time_ms && plugged) {
+            true_cps /= plugged;
+            actual_cps /= plugged;
+            est_sq += (est.vel - true_cps) * (est.vel - true_cps);
+            actual_sq += (actual_cps - true_cps) * (actual_cps - true_cps);
+            speed_samples++;
+        }
+
+        float x = w.drive.x * IN_PER_M;
+        float y = w.drive.y * IN_PER_M;
+        Pose o = odom.get_pose();
+        Pose l = loc.get_pose();
+        max_err = std::fmax(max_err, std::hypot(l.x - x, l.y - y));
+
+        if (trace) {
+            std::fprintf(trace, "%u,%.3f,%.3f,%.4f,%.3f,%.3f,%.4f,%.3f,%.3f,%.4f,%.3f,%.4f\n",
+                         pros::millis() - t0, x, y, w.drive.theta, o.x, o.y, o.theta, l.x, l.y,
+                         l.theta, w.drive.v * IN_PER_M, w.drive.omega);
+        }
+    }
+
+    pros::c::task_delete(match);
+    disabled();
+
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall).count();
+    Pose l = loc.get_pose();
+    Pose o = odom.get_pose();
+
+    std::printf("%s, %.1f s simulated in %.3f s (%.0fx real time)\n", opt.auton ? "autonomous" : "driver",
+                seconds, wall_s, (seconds + 2) / wall_s);
+    std::printf("true   x %7.2f y %7.2f th %7.2f\n", w.drive.x * IN_PER_M, w.drive.y * IN_PER_M,
+                w.drive.theta * 180 / M_PI);
+    std::printf("odom   x %7.2f y %7.2f th %7.2f\n", o.x, o.y, o.theta * 180 / M_PI);
+    std::printf("fused  x %7.2f y %7.2f th %7.2f  max error %.2f in\n", l.x, l.y, l.theta * 180 / M_PI,
+                max_err);
+
+    float hottest = 0;
+    int hot_port = 0;
+    for (int p = 1; p <= sim::NUM_PORTS; p++) {
+        if (w.motor[p].present && w.motor[p].temp > hottest) {
+            hottest = w.motor[p].temp;
+            hot_port = p;
+        }
+    }
+    std::printf("hottest motor: port %d at %.1f C\n", hot_port, hottest);
+    std::printf("supply: peak %.1f A, held at %.0f A for %.2f s\n", w.peak_supply_amps, sim::SUPPLY_LIMIT_A,
+                w.over_supply_s);
+    if (push_samples) {
+        std::printf("pushing: %.1f N average\n", push_force / push_samples);
+    }
+
+    if (speed_samples) {
+        std::printf("left drive speed: rms error %.2f in/s estimated, %.2f in/s from get_actual_velocity\n",
+                    std::sqrt(est_sq / speed_samples) * INCHES_PER_TICK,
+                    std::sqrt(actual_sq / speed_samples) * INCHES_PER_TICK);
+    }
+
+    DeviceStats ds = devices.stats();
+    if (ds.disconnects || ds.reconnects) {
+        std::printf("devices: %u disconnects, %u reconnects, last at %.2f s\n", ds.disconnects,
+                    ds.reconnects, (ds.last_change_ms - t0) / 1000.0);
+    }
+
+    IntakeStats js = rollers.stats(INTAKE_MAIN);
+    if (js.jams) {
+        std::printf("intake: %u jams, %u rests, last at %.2f s\n", js.jams, js.rests, (js.last_jam_ms - t0) / 1000.0);
+    }
+
+    MclStats ms = mcl.stats();
+    if (ms.updates) {
+        std::printf("mcl: %u updates, %u resamples, %u recovery particles, %u particles, %u us max\n",
+                    ms.updates, ms.resamples, ms.injected, ms.particles, ms.max_us);
+    }
+
+    if (opponent_in) {
+        std::printf("opponent: %.1f in away when it showed up, closest %.1f in center to center\n", opponent_first,
+                    opponent_closest);
+    }
+
+    if (opt.auton) {
+        NavStats ns = nav.stats();
+        std::printf("nav: %u baked legs, %u plans, %u replans, %u failed\n", ns.baked, ns.plans, ns.replans,
+                    ns.failures);
+
+        CommandStats cs = commands.stats();
+        std::printf("commands: %u B of arena used, %u frames live, %u failed\n", cs.arena_used, cs.frames,
+                    cs.alloc_failures);
+    }
+
+    if (opt.lcd) {
+        for (int i = 0; i < 8; i++) {
+            std::printf("lcd %d | %s\n", i, w.lcd[i].c_str());
+        }
+    }
+
+    if (trace) {
+        std::fclose(trace);
+    }
+    sim::exit(0);
+}
@@ -0,0 +1,577 @@
+#include "sim.h"
+#include "pros/error.h"
+#include "pros/motors.hpp"
+#include "pros/motor_group.hpp"
+#include <cerrno>
+#include <cmath>
+
+// Motor API over the simulated motors.
+//
+// Commands and readings go through the C functions like they do in PROS,
+// with a negative port reversing both. Readings come from the last values
+// the motor published, so they are up to MOTOR_PERIOD_MS old.
+
+using sim::Command;
+using sim::SimMotor;
+
+static SimMotor* lookup(std::int8_t port) {
+    int p = std::abs(port);
+    if (p < 1 || p > sim::NUM_PORTS) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    SimMotor* m = &sim::world().motor[p];
+    if (!m->present) {
+        errno = ENODEV;
+        return nullptr;
+    }
+    return m;
+}
+
+static void plug_motor(std::int8_t port) {
+    int p = std::abs(port);
+    if (p >= 1 && p <= sim::NUM_PORTS && !sim::world().motor[p].present) {
+        sim::world().motor[p].present = true;
+        sim::world().set_cartridge(p, 600);
+    }
+}
+
+// Raw counts per output turn for the gearset the program configured
+static double cfg_ticks(const SimMotor& m) {
+    return m.gearset == 0 ? 1800 : m.gearset == 1 ? 900 : 300;
+}
+
+static double counts_to_units(const SimMotor& m, double counts) {
+    switch (m.units) {
+        case 0: return counts / cfg_ticks(m) * 360;
+        case 1: return counts / cfg_ticks(m);
+        default: return counts;
+    }
+}
+
+static double units_to_counts(const SimMotor& m, double v) {
+    switch (m.units) {
+        case 0: return v / 360 * cfg_ticks(m);
+        case 1: return v * cfg_ticks(m);
+        default: return v;
+    }
+}
+
+static int sgn(std::int8_t port) {
+    return port < 0 ? -1 : 1;
+}
+
+static void stop(SimMotor& m) {
+    m.cmd = Command::stop;
+    m.hold = m.counts;
+}
+
+namespace pros {
+namespace c {
+
+int32_t motor_move_voltage(int8_t port, const int32_t voltage) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    if (voltage == 0) {
+        stop(*m);
+        return 1;
+    }
+    int32_t v = voltage > 12000 ? 12000 : voltage < -12000 ? -12000 : voltage;
+    m->cmd = Command::voltage;
+    m->target = sgn(port) * v;
+    return 1;
+}
+
+int32_t motor_move(int8_t port, int32_t voltage) {
+    if (voltage > 127) voltage = 127;
+    if (voltage < -127) voltage = -127;
+    return motor_move_voltage(port, voltage * 12000 / 127);
+}
+
+int32_t motor_brake(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    stop(*m);
+    return 1;
+}
+
+int32_t motor_move_velocity(int8_t port, const int32_t velocity) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->cmd = Command::velocity;
+    m->target = (float)(sgn(port) * velocity * cfg_ticks(*m));
+    return 1;
+}
+
+int32_t motor_move_absolute(int8_t port, double position, const int32_t velocity) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->cmd = Command::position;
+    m->target = (float)(m->zero + sgn(port) * units_to_counts(*m, position));
+    m->max_counts_pm = (float)(std::abs(velocity) * cfg_ticks(*m));
+    return 1;
+}
+
+int32_t motor_move_relative(int8_t port, double position, const int32_t velocity) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    double from = m->cmd == Command::position ? m->target : m->counts;
+    m->cmd = Command::position;
+    m->target = (float)(from + sgn(port) * units_to_counts(*m, position));
+    m->max_counts_pm = (float)(std::abs(velocity) * cfg_ticks(*m));
+    return 1;
+}
+
+int32_t motor_modify_profiled_velocity(int8_t port, const int32_t velocity) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->max_counts_pm = (float)(std::abs(velocity) * cfg_ticks(*m));
+    return 1;
+}
+
+double motor_get_target_position(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return sgn(port) * counts_to_units(*m, m->target - m->zero);
+}
+
+int32_t motor_get_target_velocity(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return m->cmd == Command::velocity ? (int32_t)(sgn(port) * m->target / cfg_ticks(*m)) : 0;
+}
+
+double motor_get_actual_velocity(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return sgn(port) * m->seen.counts_pm / cfg_ticks(*m);
+}
+
+int32_t motor_get_current_draw(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return (int32_t)(std::fabs(m->seen.amps) * 1000);
+}
+
+int32_t motor_get_direction(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return sgn(port) * m->seen.counts_pm < 0 ? -1 : 1;
+}
+
+double motor_get_efficiency(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    double in = m->seen.volts * m->seen.amps;
+    double out = m->seen.torque * m->seen.counts_pm / m->ticks_per_rev / 60 * 2 * M_PI;
+    return in > 1e-3 && out > 0 ? 100 * out / in : 0;
+}
+
+int32_t motor_is_over_current(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return std::fabs(m->seen.amps) * 1000 >= m->current_limit * 0.99f;
+}
+
+int32_t motor_is_over_temp(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return m->seen.temp >= 55;
+}
+
+uint32_t motor_get_faults(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    uint32_t f = 0;
+    if (motor_is_over_temp(port)) f |= E_MOTOR_FAULT_MOTOR_OVER_TEMP;
+    if (motor_is_over_current(port)) f |= E_MOTOR_FAULT_OVER_CURRENT;
+    return f;
+}
+
+uint32_t motor_get_flags(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    uint32_t f = 0;
+    if (std::fabs(m->seen.counts_pm) < m->ticks_per_rev) f |= E_MOTOR_FLAGS_ZERO_VELOCITY;
+    if (m->cmd == Command::position && std::fabs(m->target - m->seen.counts) > 5) f |= E_MOTOR_FLAGS_BUSY;
+    return f;
+}
+
+int32_t motor_get_raw_position(int8_t port, uint32_t* const timestamp) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    if (timestamp) *timestamp = m->seen.time_ms;
+    return (int32_t)std::lround(sgn(port) * m->seen.counts);
+}
+
+double motor_get_position(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return sgn(port) * counts_to_units(*m, m->seen.counts - m->zero);
+}
+
+double motor_get_power(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return std::fabs(m->seen.volts * m->seen.amps);
+}
+
+// Reported in 5 C steps like the real firmware
+double motor_get_temperature(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return std::floor(m->seen.temp / 5) * 5;
+}
+
+double motor_get_torque(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR_F;
+    return sgn(port) * m->seen.torque;
+}
+
+int32_t motor_get_voltage(int8_t port) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    return (int32_t)(sgn(port) * m->seen.volts * 1000);
+}
+
+int32_t motor_set_zero_position(int8_t port, const double position) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->zero = m->counts - sgn(port) * units_to_counts(*m, position);
+    return 1;
+}
+
+int32_t motor_tare_position(int8_t port) {
+    return motor_set_zero_position(port, 0);
+}
+
+int32_t motor_set_brake_mode(int8_t port, const motor_brake_mode_e_t mode) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->brake_mode = mode;
+    return 1;
+}
+
+int32_t motor_set_current_limit(int8_t port, const int32_t limit) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->current_limit = limit < 0 ? 0 : limit > 2500 ? 2500 : limit;
+    return 1;
+}
+
+int32_t motor_set_encoder_units(int8_t port, const motor_encoder_units_e_t units) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->units = units;
+    return 1;
+}
+
+int32_t motor_set_gearing(int8_t port, const motor_gearset_e_t gearset) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->gearset = gearset;
+    return 1;
+}
+
+int32_t motor_set_voltage_limit(int8_t port, const int32_t limit) {
+    SimMotor* m = lookup(port);
+    if (!m) return PROS_ERR;
+    m->voltage_limit = limit;
+    return 1;
+}
+
+motor_brake_mode_e_t motor_get_brake_mode(int8_t port) {
+    SimMotor* m = lookup(port);
+    return m ? (motor_brake_mode_e_t)m->brake_mode : E_MOTOR_BRAKE_INVALID;
+}
+
+int32_t motor_get_current_limit(int8_t port) {
+    SimMotor* m = lookup(port);
+    return m ? m->current_limit : PROS_ERR;
+}
+
+motor_encoder_units_e_t motor_get_encoder_units(int8_t port) {
+    SimMotor* m = lookup(port);
+    return m ? (motor_encoder_units_e_t)m->units : E_MOTOR_ENCODER_INVALID;
+}
+
+motor_gearset_e_t motor_get_gearing(int8_t port) {
+    SimMotor* m = lookup(port);
+    return m ? (motor_gearset_e_t)m->gearset : E_MOTOR_GEARSET_INVALID;
+}
+
+int32_t motor_get_voltage_limit(int8_t port) {
+    SimMotor* m = lookup(port);
+    return m ? m->voltage_limit : PROS_ERR;
+}
+
+motor_type_e_t motor_get_type(int8_t port) {
+    return lookup(port) ? E_MOTOR_TYPE_V5 : E_MOTOR_TYPE_INVALID;
+}
+
+}  // namespace c
+
+namespace v5 {
+
+// MOTOR
+
+Motor::Motor(const std::int8_t port, const MotorGears gearset, const MotorUnits encoder_units)
+    : Device(std::abs(port), DeviceType::motor), _port(port) {
+    plug_motor(port);
+    if (gearset != MotorGears::invalid) set_gearing(gearset);
+    if (encoder_units != MotorUnits::invalid) set_encoder_units(encoder_units);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const { return c::motor_move(_port, voltage); }
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const { return c::motor_move_absolute(_port, position, velocity); }
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const { return c::motor_move_relative(_port, position, velocity); }
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const { return c::motor_move_velocity(_port, velocity); }
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const { return c::motor_move_voltage(_port, voltage); }
+std::int32_t Motor::brake(void) const { return c::motor_brake(_port); }
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const { return c::motor_modify_profiled_velocity(_port, velocity); }
+
+double Motor::get_target_position(const std::uint8_t) const { return c::motor_get_target_position(_port); }
+std::int32_t Motor::get_target_velocity(const std::uint8_t) const { return c::motor_get_target_velocity(_port); }
+double Motor::get_actual_velocity(const std::uint8_t) const { return c::motor_get_actual_velocity(_port); }
+std::int32_t Motor::get_current_draw(const std::uint8_t) const { return c::motor_get_current_draw(_port); }
+std::int32_t Motor::get_direction(const std::uint8_t) const { return c::motor_get_direction(_port); }
+double Motor::get_efficiency(const std::uint8_t) const { return c::motor_get_efficiency(_port); }
+std::uint32_t Motor::get_faults(const std::uint8_t) const { return c::motor_get_faults(_port); }
+std::uint32_t Motor::get_flags(const std::uint8_t) const { return c::motor_get_flags(_port); }
+double Motor::get_position(const std::uint8_t) const { return c::motor_get_position(_port); }
+double Motor::get_power(const std::uint8_t) const { return c::motor_get_power(_port); }
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t) const { return c::motor_get_raw_position(_port, timestamp); }
+double Motor::get_temperature(const std::uint8_t) const { return c::motor_get_temperature(_port); }
+double Motor::get_torque(const std::uint8_t) const { return c::motor_get_torque(_port); }
+std::int32_t Motor::get_voltage(const std::uint8_t) const { return c::motor_get_voltage(_port); }
+std::int32_t Motor::is_over_current(const std::uint8_t) const { return c::motor_is_over_current(_port); }
+std::int32_t Motor::is_over_temp(const std::uint8_t) const { return c::motor_is_over_temp(_port); }
+MotorBrake Motor::get_brake_mode(const std::uint8_t) const { return (MotorBrake)c::motor_get_brake_mode(_port); }
+std::int32_t Motor::get_current_limit(const std::uint8_t) const { return c::motor_get_current_limit(_port); }
+MotorUnits Motor::get_encoder_units(const std::uint8_t) const { return (MotorUnits)c::motor_get_encoder_units(_port); }
+MotorGears Motor::get_gearing(const std::uint8_t) const { return (MotorGears)c::motor_get_gearing(_port); }
+std::int32_t Motor::get_voltage_limit(const std::uint8_t) const { return c::motor_get_voltage_limit(_port); }
+std::int32_t Motor::is_reversed(const std::uint8_t) const { return _port < 0; }
+MotorType Motor::get_type(const std::uint8_t) const { return (MotorType)c::motor_get_type(_port); }
+
+std::int32_t Motor::set_brake_mode(const MotorBrake mode, const std::uint8_t) const { return c::motor_set_brake_mode(_port, (motor_brake_mode_e_t)mode); }
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode, const std::uint8_t) const { return c::motor_set_brake_mode(_port, mode); }
+std::int32_t Motor::set_current_limit(const std::int32_t limit, const std::uint8_t) const { return c::motor_set_current_limit(_port, limit); }
+std::int32_t Motor::set_encoder_units(const MotorUnits units, const std::uint8_t) const { return c::motor_set_encoder_units(_port, (motor_encoder_units_e_t)units); }
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units, const std::uint8_t) const { return c::motor_set_encoder_units(_port, units); }
+std::int32_t Motor::set_gearing(const MotorGears gearset, const std::uint8_t) const { return c::motor_set_gearing(_port, (motor_gearset_e_t)gearset); }
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset, const std::uint8_t) const { return c::motor_set_gearing(_port, gearset); }
+std::int32_t Motor::set_reversed(const bool reverse, const std::uint8_t) { _port = reverse ? -std::abs(_port) : std::abs(_port); return 1; }
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit, const std::uint8_t) const { return c::motor_set_voltage_limit(_port, limit); }
+std::int32_t Motor::set_zero_position(const double position, const std::uint8_t) const { return c::motor_set_zero_position(_port, position); }
+std::int32_t Motor::tare_position(const std::uint8_t) const { return c::motor_tare_position(_port); }
+
+std::int8_t Motor::size(void) const { return 1; }
+std::int8_t Motor::get_port(const std::uint8_t) const { return _port; }
+
+std::vector<double> Motor::get_target_position_all(void) const { return {get_target_position()}; }
+std::vector<std::int32_t> Motor::get_target_velocity_all(void) const { return {get_target_velocity()}; }
+std::vector<double> Motor::get_actual_velocity_all(void) const { return {get_actual_velocity()}; }
+std::vector<std::int32_t> Motor::get_current_draw_all(void) const { return {get_current_draw()}; }
+std::vector<std::int32_t> Motor::get_direction_all(void) const { return {get_direction()}; }
+std::vector<double> Motor::get_efficiency_all(void) const { return {get_efficiency()}; }
+std::vector<std::uint32_t> Motor::get_faults_all(void) const { return {get_faults()}; }
+std::vector<std::uint32_t> Motor::get_flags_all(void) const { return {get_flags()}; }
+std::vector<double> Motor::get_position_all(void) const { return {get_position()}; }
+std::vector<double> Motor::get_power_all(void) const { return {get_power()}; }
+std::vector<std::int32_t> Motor::get_raw_position_all(std::uint32_t* const timestamp) const { return {get_raw_position(timestamp)}; }
+std::vector<double> Motor::get_temperature_all(void) const { return {get_temperature()}; }
+std::vector<double> Motor::get_torque_all(void) const { return {get_torque()}; }
+std::vector<std::int32_t> Motor::get_voltage_all(void) const { return {get_voltage()}; }
+std::vector<std::int32_t> Motor::is_over_current_all(void) const { return {is_over_current()}; }
+std::vector<std::int32_t> Motor::is_over_temp_all(void) const { return {is_over_temp()}; }
+std::vector<MotorBrake> Motor::get_brake_mode_all(void) const { return {get_brake_mode()}; }
+std::vector<std::int32_t> Motor::get_current_limit_all(void) const { return {get_current_limit()}; }
+std::vector<MotorUnits> Motor::get_encoder_units_all(void) const { return {get_encoder_units()}; }
+std::vector<MotorGears> Motor::get_gearing_all(void) const { return {get_gearing()}; }
+std::vector<std::int8_t> Motor::get_port_all(void) const { return {_port}; }
+std::vector<std::int32_t> Motor::get_voltage_limit_all(void) const { return {get_voltage_limit()}; }
+std::vector<std::int32_t> Motor::is_reversed_all(void) const { return {is_reversed()}; }
+std::vector<MotorType> Motor::get_type_all(void) const { return {get_type()}; }
+
+std::int32_t Motor::set_brake_mode_all(const MotorBrake mode) const { return set_brake_mode(mode); }
+std::int32_t Motor::set_brake_mode_all(const motor_brake_mode_e_t mode) const { return set_brake_mode(mode); }
+std::int32_t Motor::set_current_limit_all(const std::int32_t limit) const { return set_current_limit(limit); }
+std::int32_t Motor::set_encoder_units_all(const MotorUnits units) const { return set_encoder_units(units); }
+std::int32_t Motor::set_encoder_units_all(const motor_encoder_units_e_t units) const { return set_encoder_units(units); }
+std::int32_t Motor::set_gearing_all(const MotorGears gearset) const { return set_gearing(gearset); }
+std::int32_t Motor::set_gearing_all(const motor_gearset_e_t gearset) const { return set_gearing(gearset); }
+std::int32_t Motor::set_reversed_all(const bool reverse) { return set_reversed(reverse); }
+std::int32_t Motor::set_voltage_limit_all(const std::int32_t limit) const { return set_voltage_limit(limit); }
+std::int32_t Motor::set_zero_position_all(const double position) const { return set_zero_position(position); }
+std::int32_t Motor::tare_position_all(void) const { return tare_position(); }
+
+// MOTOR GROUP
+
+MotorGroup::MotorGroup(const std::initializer_list<std::int8_t> ports, const MotorGears gearset,
+                       const MotorUnits encoder_units)
+    : MotorGroup(std::vector<std::int8_t>(ports), gearset, encoder_units) {}
+
+MotorGroup::MotorGroup(const std::vector<std::int8_t>& ports, const MotorGears gearset,
+                       const MotorUnits encoder_units)
+    : _ports(ports) {
+    for (std::int8_t p : _ports) {
+        plug_motor(p);
+    }
+    if (gearset != MotorGears::invalid) set_gearing_all(gearset);
+    if (encoder_units != MotorUnits::invalid) set_encoder_units_all(encoder_units);
+}
+
+MotorGroup::MotorGroup(AbstractMotor& motor_group) : MotorGroup(motor_group.get_port_all()) {}
+
+// Runs a command on every motor, PROS_ERR if any of them failed
+template <typename F>
+static std::int32_t each(const std::vector<std::int8_t>& ports, F f) {
+    std::int32_t r = ports.empty() ? PROS_ERR : 1;
+    for (std::int8_t p : ports) {
+        if (f(p) == PROS_ERR) r = PROS_ERR;
+    }
+    return r;
+}
+
+// One reading per motor
+template <typename T, typename F>
+static std::vector<T> all(const std::vector<std::int8_t>& ports, F f) {
+    std::vector<T> out;
+    out.reserve(ports.size());
+    for (std::int8_t p : ports) {
+        out.push_back((T)f(p));
+    }
+    return out;
+}
+
+// Port at an index, 0 (no device) if out of range
+static std::int8_t at(const std::vector<std::int8_t>& ports, std::uint8_t i) {
+    if (i >= ports.size()) {
+        errno = EOVERFLOW;
+        return 0;
+    }
+    return ports[i];
+}
+
+std::int32_t MotorGroup::move(std::int32_t voltage) const { return each(_ports, [&](std::int8_t p) { return c::motor_move(p, voltage); }); }
+std::int32_t MotorGroup::move_absolute(const double position, const std::int32_t velocity) const { return each(_ports, [&](std::int8_t p) { return c::motor_move_absolute(p, position, velocity); }); }
+std::int32_t MotorGroup::move_relative(const double position, const std::int32_t velocity) const { return each(_ports, [&](std::int8_t p) { return c::motor_move_relative(p, position, velocity); }); }
+std::int32_t MotorGroup::move_velocity(const std::int32_t velocity) const { return each(_ports, [&](std::int8_t p) { return c::motor_move_velocity(p, velocity); }); }
+std::int32_t MotorGroup::move_voltage(const std::int32_t voltage) const { return each(_ports, [&](std::int8_t p) { return c::motor_move_voltage(p, voltage); }); }
+std::int32_t MotorGroup::brake(void) const { return each(_ports, c::motor_brake); }
+std::int32_t MotorGroup::modify_profiled_velocity(const std::int32_t velocity) const { return each(_ports, [&](std::int8_t p) { return c::motor_modify_profiled_velocity(p, velocity); }); }
+
+double MotorGroup::get_target_position(const std::uint8_t i) const { return c::motor_get_target_position(at(_ports, i)); }
+std::int32_t MotorGroup::get_target_velocity(const std::uint8_t i) const { return c::motor_get_target_velocity(at(_ports, i)); }
+double MotorGroup::get_actual_velocity(const std::uint8_t i) const { return c::motor_get_actual_velocity(at(_ports, i)); }
+std::int32_t MotorGroup::get_current_draw(const std::uint8_t i) const { return c::motor_get_current_draw(at(_ports, i)); }
+std::int32_t MotorGroup::get_direction(const std::uint8_t i) const { return c::motor_get_direction(at(_ports, i)); }
+double MotorGroup::get_efficiency(const std::uint8_t i) const { return c::motor_get_efficiency(at(_ports, i)); }
+std::uint32_t MotorGroup::get_faults(const std::uint8_t i) const { return c::motor_get_faults(at(_ports, i)); }
+std::uint32_t MotorGroup::get_flags(const std::uint8_t i) const { return c::motor_get_flags(at(_ports, i)); }
+double MotorGroup::get_position(const std::uint8_t i) const { return c::motor_get_position(at(_ports, i)); }
+double MotorGroup::get_power(const std::uint8_t i) const { return c::motor_get_power(at(_ports, i)); }
+std::int32_t MotorGroup::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t i) const { return c::motor_get_raw_position(at(_ports, i), timestamp); }
+double MotorGroup::get_temperature(const std::uint8_t i) const { return c::motor_get_temperature(at(_ports, i)); }
+double MotorGroup::get_torque(const std::uint8_t i) const { return c::motor_get_torque(at(_ports, i)); }
+std::int32_t MotorGroup::get_voltage(const std::uint8_t i) const { return c::motor_get_voltage(at(_ports, i)); }
+std::int32_t MotorGroup::is_over_current(const std::uint8_t i) const { return c::motor_is_over_current(at(_ports, i)); }
+std::int32_t MotorGroup::is_over_temp(const std::uint8_t i) const { return c::motor_is_over_temp(at(_ports, i)); }
+MotorBrake MotorGroup::get_brake_mode(const std::uint8_t i) const { return (MotorBrake)c::motor_get_brake_mode(at(_ports, i)); }
+std::int32_t MotorGroup::get_current_limit(const std::uint8_t i) const { return c::motor_get_current_limit(at(_ports, i)); }
+MotorUnits MotorGroup::get_encoder_units(const std::uint8_t i) const { return (MotorUnits)c::motor_get_encoder_units(at(_ports, i)); }
+MotorGears MotorGroup::get_gearing(const std::uint8_t i) const { return (MotorGears)c::motor_get_gearing(at(_ports, i)); }
+std::int32_t MotorGroup::get_voltage_limit(const std::uint8_t i) const { return c::motor_get_voltage_limit(at(_ports, i)); }
+std::int32_t MotorGroup::is_reversed(const std::uint8_t i) const { return at(_ports, i) < 0; }
+MotorType MotorGroup::get_type(const std::uint8_t i) const { return (MotorType)c::motor_get_type(at(_ports, i)); }
+
+std::int32_t MotorGroup::set_brake_mode(const MotorBrake mode, const std::uint8_t i) const { return c::motor_set_brake_mode(at(_ports, i), (motor_brake_mode_e_t)mode); }
+std::int32_t MotorGroup::set_brake_mode(const motor_brake_mode_e_t mode, const std::uint8_t i) const { return c::motor_set_brake_mode(at(_ports, i), mode); }
+std::int32_t MotorGroup::set_current_limit(const std::int32_t limit, const std::uint8_t i) const { return c::motor_set_current_limit(at(_ports, i), limit); }
+std::int32_t MotorGroup::set_encoder_units(const MotorUnits units, const std::uint8_t i) const { return c::motor_set_encoder_units(at(_ports, i), (motor_encoder_units_e_t)units); }
+std::int32_t MotorGroup::set_encoder_units(const motor_encoder_units_e_t units, const std::uint8_t i) const { return c::motor_set_encoder_units(at(_ports, i), units); }
+std::int32_t MotorGroup::set_gearing(const MotorGears gearset, const std::uint8_t i) const { return c::motor_set_gearing(at(_ports, i), (motor_gearset_e_t)gearset); }
+std::int32_t MotorGroup::set_gearing(const motor_gearset_e_t gearset, const std::uint8_t i) const { return c::motor_set_gearing(at(_ports, i), gearset); }
+std::int32_t MotorGroup::set_voltage_limit(const std::int32_t limit, const std::uint8_t i) const { return c::motor_set_voltage_limit(at(_ports, i), limit); }
+std::int32_t MotorGroup::set_zero_position(const double position, const std::uint8_t i) const { return c::motor_set_zero_position(at(_ports, i), position); }
+std::int32_t MotorGroup::tare_position(const std::uint8_t i) const { return c::motor_tare_position(at(_ports, i)); }
+
+std::int32_t MotorGroup::set_gearing(std::vector<motor_gearset_e_t> gearsets) const {
+    for (std::size_t i = 0; i < gearsets.size() && i < _ports.size(); i++) c::motor_set_gearing(_ports[i], gearsets[i]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_gearing(std::vector<MotorGears> gearsets) const {
+    for (std::size_t i = 0; i < gearsets.size() && i < _ports.size(); i++) c::motor_set_gearing(_ports[i], (motor_gearset_e_t)gearsets[i]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_reversed(const bool reverse, const std::uint8_t i) {
+    if (i >= _ports.size()) return PROS_ERR;
+    _ports[i] = reverse ? -std::abs(_ports[i]) : std::abs(_ports[i]);
+    return 1;
+}
+
+std::int32_t MotorGroup::set_reversed_all(const bool reverse) {
+    for (std::size_t i = 0; i < _ports.size(); i++) set_reversed(reverse, i);
+    return 1;
+}
+
+std::vector<double> MotorGroup::get_target_position_all(void) const { return all<double>(_ports, c::motor_get_target_position); }
+std::vector<std::int32_t> MotorGroup::get_target_velocity_all(void) const { return all<std::int32_t>(_ports, c::motor_get_target_velocity); }
+std::vector<double> MotorGroup::get_actual_velocity_all(void) const { return all<double>(_ports, c::motor_get_actual_velocity); }
+std::vector<std::int32_t> MotorGroup::get_current_draw_all(void) const { return all<std::int32_t>(_ports, c::motor_get_current_draw); }
+std::vector<std::int32_t> MotorGroup::get_direction_all(void) const { return all<std::int32_t>(_ports, c::motor_get_direction); }
+std::vector<double> MotorGroup::get_efficiency_all(void) const { return all<double>(_ports, c::motor_get_efficiency); }
+std::vector<std::uint32_t> MotorGroup::get_faults_all(void) const { return all<std::uint32_t>(_ports, c::motor_get_faults); }
+std::vector<std::uint32_t> MotorGroup::get_flags_all(void) const { return all<std::uint32_t>(_ports, c::motor_get_flags); }
+std::vector<double> MotorGroup::get_position_all(void) const { return all<double>(_ports, c::motor_get_position); }
+std::vector<double> MotorGroup::get_power_all(void) const { return all<double>(_ports, c::motor_get_power); }
+std::vector<std::int32_t> MotorGroup::get_raw_position_all(std::uint32_t* const timestamp) const { return all<std::int32_t>(_ports, [&](std::int8_t p) { return c::motor_get_raw_position(p, timestamp); }); }
+std::vector<double> MotorGroup::get_temperature_all(void) const { return all<double>(_ports, c::motor_get_temperature); }
+std::vector<double> MotorGroup::get_torque_all(void) const { return all<double>(_ports, c::motor_get_torque); }
+std::vector<std::int32_t> MotorGroup::get_voltage_all(void) const { return all<std::int32_t>(_ports, c::motor_get_voltage); }
+std::vector<std::int32_t> MotorGroup::is_over_current_all(void) const { return all<std::int32_t>(_ports, c::motor_is_over_current); }
+std::vector<std::int32_t> MotorGroup::is_over_temp_all(void) const { return all<std::int32_t>(_ports, c::motor_is_over_temp); }
+std::vector<MotorBrake> MotorGroup::get_brake_mode_all(void) const { return all<MotorBrake>(_ports, c::motor_get_brake_mode); }
+std::vector<std::int32_t> MotorGroup::get_current_limit_all(void) const { return all<std::int32_t>(_ports, c::motor_get_current_limit); }
+std::vector<MotorUnits> MotorGroup::get_encoder_units_all(void) const { return all<MotorUnits>(_ports, c::motor_get_encoder_units); }
+std::vector<MotorGears> MotorGroup::get_gearing_all(void) const { return all<MotorGears>(_ports, c::motor_get_gearing); }
+std::vector<std::int8_t> MotorGroup::get_port_all(void) const { return _ports; }
+std::vector<std::int32_t> MotorGroup::get_voltage_limit_all(void) const { return all<std::int32_t>(_ports, c::motor_get_voltage_limit); }
+std::vector<std::int32_t> MotorGroup::is_reversed_all(void) const { return all<std::int32_t>(_ports, [](std::int8_t p) { return p < 0; }); }
+std::vector<MotorType> MotorGroup::get_type_all(void) const { return all<MotorType>(_ports, c::motor_get_type); }
+
+std::int32_t MotorGroup::set_brake_mode_all(const MotorBrake mode) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_brake_mode(p, (motor_brake_mode_e_t)mode); }); }
+std::int32_t MotorGroup::set_brake_mode_all(const motor_brake_mode_e_t mode) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_brake_mode(p, mode); }); }
+std::int32_t MotorGroup::set_current_limit_all(const std::int32_t limit) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_current_limit(p, limit); }); }
+std::int32_t MotorGroup::set_encoder_units_all(const MotorUnits units) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_encoder_units(p, (motor_encoder_units_e_t)units); }); }
+std::int32_t MotorGroup::set_encoder_units_all(const motor_encoder_units_e_t units) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_encoder_units(p, units); }); }
+std::int32_t MotorGroup::set_gearing_all(const MotorGears gearset) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_gearing(p, (motor_gearset_e_t)gearset); }); }
+std::int32_t MotorGroup::set_gearing_all(const motor_gearset_e_t gearset) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_gearing(p, gearset); }); }
+std::int32_t MotorGroup::set_voltage_limit_all(const std::int32_t limit) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_voltage_limit(p, limit); }); }
+std::int32_t MotorGroup::set_zero_position_all(const double position) const { return each(_ports, [&](std::int8_t p) { return c::motor_set_zero_position(p, position); }); }
+std::int32_t MotorGroup::tare_position_all(void) const { return each(_ports, c::motor_tare_position); }
+
+std::int8_t MotorGroup::size(void) const { return (std::int8_t)_ports.size(); }
+std::int8_t MotorGroup::get_port(const std::uint8_t i) const { return at(_ports, i); }
+
+void MotorGroup::operator+=(AbstractMotor& other) { append(other); }
+
+void MotorGroup::append(AbstractMotor& other) {
+    for (std::int8_t p : other.get_port_all()) _ports.push_back(p);
+}
+
+void MotorGroup::erase_port(std::int8_t port) {
+    for (std::size_t i = 0; i < _ports.size(); i++) {
+        if (std::abs(_ports[i]) == std::abs(port)) {
+            _ports.erase(_ports.begin() + i);
+            return;
+        }
+    }
+}
+
+}  // namespace v5
+}  // namespace pros
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cmath>
+
+// Physics models for the host simulator.
+//
+// Plain SI units throughout. Everything is an instance with no globals, so
+// the optimizer tools can run many independent models in parallel threads.
+
+namespace sim {
+
+// V5 smart motor seen at the cartridge output shaft
+struct DcMotor {
+    float free_rpm = 600;           // 100 / 200 / 600 by cartridge
+    float stall_torque = 0.35f;     // N m, 2.1 / 1.05 / 0.35 by cartridge
+    float stall_current = 2.5f;     // A
+    float free_current = 0.1f;      // A
+    float nominal_v = 12.0f;
+
+    // Thermal: heat capacity J/C, resistance to ambient C/W
+    float heat_cap = 60;
+    float heat_res = 2;
+    float ambient = 25;
+
+    static DcMotor cartridge(float rpm) {
+        DcMotor m;
+        m.free_rpm = rpm;
+        m.stall_torque = 2.1f * 100 / rpm;
+        return m;
+    }
+
+    float resistance() const {
+        return nominal_v / stall_current;
+    }
+
+    float free_speed() const {
+        return free_rpm * 2 * (float)M_PI / 60;
+    }
+
+    float kt() const {
+        return stall_torque / (stall_current - free_current);
+    }
+
+    float kv() const {
+        return (nominal_v - free_current * resistance()) / free_speed();
+    }
+
+    // Winding current for a terminal voltage at a shaft speed (rad/s),
+    // clamped to the current limit
+    float current(float volts, float speed, float limit) const {
+        float i = (volts - kv() * speed) / resistance();
+        if (i > limit) i = limit;
+        if (i < -limit) i = -limit;
+        return i;
+    }
+
+    // Output torque for a winding current, minus the no-load friction
+    float torque(float amps, float speed) const {
+        float t = kt() * amps;
+        float f = kt() * free_current;
+        if (speed > 1e-3f) t -= f;
+        else if (speed < -1e-3f) t += f;
+        return t;
+    }
+
+    // Advances a winding temperature by dt seconds
+    float heat(float temp, float amps, float dt) const {
+        float p = amps * amps * resistance();
+        return temp + (p - (temp - ambient) / heat_res) / heat_cap * dt;
+    }
+};
+
+// Differential drive on flat carpet
+struct DriveModel {
+    float mass = 6.8f;              // kg
+    float inertia = 0.25f;          // kg m^2 about the center
+    float wheel_radius = 0.0413f;   // m, 3.25 in omni
+    float ratio = 0.75f;            // wheel turns per motor turn
+    float track = 0.305f;           // m
+    float roll_drag = 6.0f;         // N per m/s
+    float turn_drag = 0.6f;         // N m per rad/s
+    float static_friction = 4.0f;   // N, coulomb rolling friction
+    bool pinned = false;            // against a wall or a robot it can't move
+    bool slipping = false;          // wheels spin free on the carpet, the robot stays put
+
+    // State: field position (m), heading (rad clockwise from +y), speeds
+    float x = 0, y = 0, theta = 0;
+    float v = 0, omega = 0;
+
+    // Wheel surface speed of each side, m/s
+    float left_speed() const {
+        return v + omega * track / 2;
+    }
+
+    float right_speed() const {
+        return v - omega * track / 2;
+    }
+
+    // Motor shaft speed (rad/s) for a side's surface speed
+    float motor_speed(float side_speed) const {
+        return side_speed / wheel_radius / ratio;
+    }
+
+    /**
+     * Steps the chassis by dt under the summed motor torque on each side
+     * (N m at the motor shafts, positive drives that side forward).
+     */
+    void step(float torque_left, float torque_right, float dt) {
+        if (pinned) {
+            v = 0;
+            omega = 0;
+            return;
+        }
+
+        float fl = torque_left / ratio / wheel_radius;
+        float fr = torque_right / ratio / wheel_radius;
+
+        float f = fl + fr - roll_drag * v;
+        if (std::fabs(v) > 1e-3f) {
+            f -= v > 0 ? static_friction : -static_friction;
+        } else if (std::fabs(f) < static_friction) {
+            f = 0;
+            v = 0;
+        }
+
+        float tq = (fl - fr) * track / 2 - turn_drag * omega;
+
+        v += f / mass * dt;
+        omega += tq / inertia * dt;
+        if (slipping) {
+            return;
+        }
+
+        float mid = theta + omega * dt / 2;
+        x += v * dt * std::sin(mid);
+        y += v * dt * std::cos(mid);
+        theta += omega * dt;
+    }
+};
+
+// One intake roller stage on its own motor
+struct RollerModel {
+    float inertia = 2e-4f;          // kg m^2 at the motor shaft
+    float drag = 2e-4f;             // N m per rad/s
+    float load = 0.02f;             // N m of friction from game elements
+    bool jammed = false;            // a block wedged in, the roller can't turn
+
+    float speed = 0;                // rad/s at the motor shaft
+
+    void step(float torque, float dt) {
+        if (jammed) {
+            speed = 0;
+            return;
+        }
+
+        float t = torque - drag * speed;
+        if (std::fabs(speed) > 1e-3f) {
+            t -= speed > 0 ? load : -load;
+        } else if (std::fabs(t) < load) {
+            return;
+        }
+        speed += t / inertia * dt;
+    }
+};
+
+}  // namespace sim
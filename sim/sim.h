@@ -0,0 +1,221 @@
+#pragma once
+
+#include "physics.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Host simulator for the robot program.
+//
+// The project's src/ is compiled unchanged against sim/, which provides the
+// subset of the PROS API it uses (tasks, motors, IMU, GPS, distance and
+// rotation sensors, controller, LLEMU). Devices read and write a World with
+// the physics models behind them, and tasks run on a virtual clock that only
+// moves when every task is blocked, so a two minute match runs in well under
+// a second and every run with the same inputs is identical.
+
+namespace sim {
+
+constexpr int NUM_PORTS = 21;
+
+// Physics step, and how often smart devices publish new readings
+constexpr std::uint32_t STEP_US = 1000;
+constexpr std::uint32_t MOTOR_PERIOD_MS = 10;
+constexpr std::uint32_t IMU_PERIOD_MS = 10;
+constexpr std::uint32_t GPS_PERIOD_MS = 20;
+constexpr std::uint32_t DISTANCE_PERIOD_MS = 33;
+
+// Current the brain shares between all motors. Past it every motor gets the
+// same fraction of what it asked for.
+constexpr float SUPPLY_LIMIT_A = 20;
+
+// What a motor is connected to
+enum class Load : std::uint8_t {
+    roller,         // its own RollerModel, the default for any motor
+    drive_left,
+    drive_right,
+};
+
+enum class Command : std::uint8_t {
+    voltage,        // target in mV
+    velocity,       // target in raw counts per minute
+    position,       // target in raw counts
+    stop,           // move_voltage(0) / brake(), behaves per brake mode
+};
+
+struct SimMotor {
+    bool present = false;
+    Load load = Load::roller;
+    std::int8_t mount = 1;          // -1 if the motor drives its load backwards
+    DcMotor model;                  // the cartridge physically installed
+    float ticks_per_rev = 300;      // raw counts per output turn of that cartridge
+    RollerModel roller;
+
+    // Settings, as set through the API
+    Command cmd = Command::stop;
+    float target = 0;
+    float max_counts_pm = 0;        // profile speed for position moves
+    int brake_mode = 0;
+    int units = 0;
+    int gearset = 1;                // motors power up as green
+    std::int32_t current_limit = 2500;
+    std::int32_t voltage_limit = 0; // 0 = none
+    double zero = 0;                // raw counts at position 0
+    double hold = 0;                // raw counts held in hold mode
+
+    // Physical state, in the motor's own direction
+    double counts = 0;
+    float speed = 0;                // rad/s
+    float amps = 0;
+    float volts = 0;
+    float torque = 0;
+    float temp = 25;
+
+    // Last reading the motor published
+    struct {
+        double counts;
+        float counts_pm;
+        float amps;
+        float volts;
+        float torque;
+        float temp;
+        std::uint32_t time_ms;
+    } seen = {};
+};
+
+struct SimImu {
+    bool present = false;
+    float drift = 0.0005f;          // deg/s
+    float noise = 0.02f;            // deg, per reading
+    std::uint32_t calibrated_ms = 0;
+    bool calibrating = false;
+    double offset = 0;              // true rotation (deg) at which it reads 0
+    double seen_rotation = 0;
+    float seen_rate = 0;
+};
+
+struct SimGps {
+    bool present = false;
+    float noise = 0.015f;           // m, per axis
+    float heading_noise = 0.3f;     // deg
+    double seen_x = 0;
+    double seen_y = 0;
+    double seen_heading = 0;
+    double offset_x = 0;
+    double offset_y = 0;
+};
+
+struct SimDistance {
+    bool present = false;
+    float forward = 0;              // in, mount from the tracking center
+    float right = 0;
+    float angle = 0;                // deg, beam clockwise from straight ahead
+    float noise_near = 15;          // mm sd, under 200 mm
+    float noise_fraction = 0.05f;   // of the reading past it
+    std::int32_t seen_mm = 9999;    // 9999 when nothing is in range
+    std::int32_t seen_confidence = 0;
+};
+
+struct SimRotation {
+    bool present = false;
+    Load side = Load::roller;       // roller = not bound, reads 0
+    float ratio = 1;                // sensor turns per wheel turn
+    bool reversed = false;
+    double turns = 0;               // true sensor turns
+    double zero = 0;
+    double seen_turns = 0;
+    float seen_rate = 0;            // turns/s
+};
+
+// Controller state at one instant, buttons use the BTN_BIT layout
+struct ControllerFrame {
+    std::uint32_t time_ms;
+    std::int8_t axis[4];
+    std::uint16_t buttons;
+};
+
+struct World {
+    SimMotor motor[NUM_PORTS + 1];  // by port number
+    SimImu imu[NUM_PORTS + 1];
+    SimGps gps[NUM_PORTS + 1];
+    SimDistance distance[NUM_PORTS + 1];
+    SimRotation rotation[NUM_PORTS + 1];
+    DriveModel drive;
+
+    // Controller, scripted inputs are applied at their times
+    std::int8_t axis[4] = {};
+    std::uint16_t buttons = 0;
+    std::vector<ControllerFrame> script;
+    std::size_t next_frame = 0;
+
+    std::string lcd[8];
+    void (*lcd_button[3])() = {};   // callbacks the program registered, left to right
+
+    std::uint64_t time_us = 0;
+    std::uint32_t seed = 1;
+
+    // Battery side current, and how long it was held to the supply limit
+    float supply_amps = 0;
+    float peak_supply_amps = 0;
+    float over_supply_s = 0;
+
+    /**
+     * Binds motors (signed PROS ports, as passed to the MotorGroup) to a side
+     * of the drive. The port's sign is the direction the motor drives it.
+     */
+    void bind_drive(const std::vector<std::int8_t>& ports, Load side);
+
+    /**
+     * Sets the cartridge physically installed in a motor.
+     */
+    void set_cartridge(int port, float rpm);
+
+    /**
+     * Places the robot, inches from the field center and degrees clockwise
+     * from +y like the program's poses.
+     */
+    void place(float x, float y, float heading);
+
+    /**
+     * Pulls the cable on a motor port or plugs it back in. A motor that comes
+     * back has restarted: its count is 0 and it has forgotten its command and
+     * limits, like a real one.
+     */
+    void set_plugged(int port, bool plugged);
+
+    /**
+     * Steps the physics and the sensor updates up to a time.
+     */
+    void advance_to(std::uint64_t us);
+
+    std::uint32_t millis() const {
+        return (std::uint32_t)(time_us / 1000);
+    }
+
+    private:
+        void step(float dt);
+        void publish(std::uint32_t ms);
+        float motor_voltage(SimMotor& m);
+        float noise(float sd);
+        std::uint32_t rng = 0;
+};
+
+World& world();
+
+// Kernel
+
+/**
+ * Makes the calling thread the first task. Call once before anything in
+ * src/ creates a task.
+ */
+void boot();
+
+/**
+ * Ends the run from any task, flushing output.
+ */
+[[noreturn]] void exit(int code);
+
+// Host directory standing in for the SD card's /usd/
+extern std::string usd_dir;
+
+}  // namespace sim
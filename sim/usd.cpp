@@ -0,0 +1,40 @@
+#include "sim.h"
+#include "pros/misc.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+
+// SD card.
+//
+// The program's fopen() calls are wrapped at link time (-Wl,--wrap=fopen),
+// and paths under /usd/ are opened from a host directory instead.
+
+namespace sim {
+
+std::string usd_dir = "usd";
+
+}  // namespace sim
+
+extern "C" FILE* __real_fopen(const char* path, const char* mode);
+
+extern "C" FILE* __wrap_fopen(const char* path, const char* mode) {
+    if (std::strncmp(path, "/usd/", 5) != 0) {
+        return __real_fopen(path, mode);
+    }
+    std::string host = sim::usd_dir + "/" + (path + 5);
+    if (mode[0] != 'r') {
+        mkdir(sim::usd_dir.c_str(), 0755);
+    }
+    return __real_fopen(host.c_str(), mode);
+}
+
+namespace pros {
+namespace usd {
+
+std::int32_t is_installed(void) {
+    return 1;
+}
+
+}  // namespace usd
+}  // namespace pros
@@ -0,0 +1,269 @@
+#include "sim.h"
+#include "field_map.h"
+#include <cmath>
+
+namespace sim {
+
+constexpr float TWO_PI = 2 * (float)M_PI;
+constexpr float METERS_PER_INCH = 0.0254f;
+
+World& world() {
+    static World w;
+    return w;
+}
+
+void World::bind_drive(const std::vector<std::int8_t>& ports, Load side) {
+    for (std::int8_t p : ports) {
+        int i = std::abs(p);
+        if (i < 1 || i > NUM_PORTS) {
+            continue;
+        }
+        motor[i].load = side;
+        motor[i].mount = p < 0 ? -1 : 1;
+    }
+}
+
+void World::set_cartridge(int port, float rpm) {
+    motor[port].model = DcMotor::cartridge(rpm);
+    motor[port].ticks_per_rev = 300 * 600 / rpm;
+}
+
+void World::set_plugged(int port, bool plugged) {
+    SimMotor& m = motor[port];
+    if (m.present == plugged) {
+        return;
+    }
+    m.present = plugged;
+    if (plugged) {
+        SimMotor fresh;
+        m.cmd = fresh.cmd;
+        m.target = fresh.target;
+        m.current_limit = fresh.current_limit;
+        m.voltage_limit = fresh.voltage_limit;
+        m.counts = 0;
+        m.zero = 0;
+        m.hold = 0;
+        m.seen = {};
+    } else {
+        m.amps = 0;
+        m.torque = 0;
+    }
+}
+
+void World::place(float x, float y, float heading) {
+    drive.x = x * METERS_PER_INCH;
+    drive.y = y * METERS_PER_INCH;
+    drive.theta = heading * (float)(M_PI / 180.0);
+    drive.v = 0;
+    drive.omega = 0;
+}
+
+// Gaussian noise from a small xorshift generator, seeded per run
+float World::noise(float sd) {
+    if (sd <= 0) {
+        return 0;
+    }
+    if (rng == 0) {
+        rng = seed * 2654435761u + 1;
+    }
+    float u[2];
+    for (float& v : u) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        v = (rng + 1.0f) / 4294967296.0f;
+    }
+    return sd * std::sqrt(-2 * std::log(u[0])) * std::cos(TWO_PI * u[1]);
+}
+
+// Terminal voltage the motor's controller applies this step
+float World::motor_voltage(SimMotor& m) {
+    float max_v = m.voltage_limit > 0 ? m.voltage_limit / 1000.0f : 12.0f;
+    if (max_v > 12) max_v = 12;
+
+    // counts per minute at full speed, for the velocity loop gains
+    float free_cpm = m.model.free_rpm * m.ticks_per_rev;
+    float cpm = m.speed / TWO_PI * 60 * m.ticks_per_rev;
+    float v = 0;
+
+    switch (m.cmd) {
+        case Command::voltage:
+            v = m.target / 1000;
+            break;
+        case Command::velocity:
+            v = 12 * (m.target / free_cpm) + 24 * (m.target - cpm) / free_cpm;
+            break;
+        case Command::position: {
+            float err = (float)(m.target - m.counts);
+            float want = err * 60 * 8;  // settle in about an eighth of a second
+            if (want > m.max_counts_pm) want = m.max_counts_pm;
+            if (want < -m.max_counts_pm) want = -m.max_counts_pm;
+            v = 12 * (want / free_cpm) + 24 * (want - cpm) / free_cpm;
+            break;
+        }
+        case Command::stop:
+            if (m.brake_mode == 2) {
+                float err = (float)(m.hold - m.counts);
+                v = 12 * err * 60 * 8 / free_cpm - 24 * cpm / free_cpm;
+            }
+            break;
+    }
+
+    if (v > max_v) v = max_v;
+    if (v < -max_v) v = -max_v;
+    return v;
+}
+
+void World::step(float dt) {
+    float wl = drive.motor_speed(drive.left_speed());
+    float wr = drive.motor_speed(drive.right_speed());
+    float tl = 0;
+    float tr = 0;
+    float supply = 0;
+
+    for (int p = 1; p <= NUM_PORTS; p++) {
+        SimMotor& m = motor[p];
+        if (!m.present) {
+            continue;
+        }
+
+        switch (m.load) {
+            case Load::drive_left: m.speed = m.mount * wl; break;
+            case Load::drive_right: m.speed = m.mount * wr; break;
+            case Load::roller: m.speed = m.roller.speed; break;
+        }
+
+        // The firmware derates the current limit as the motor heats up
+        float limit = m.current_limit / 1000.0f;
+        if (m.temp >= 65) limit = 0;
+        else if (m.temp >= 60) limit *= 0.25f;
+        else if (m.temp >= 55) limit *= 0.5f;
+
+        m.volts = motor_voltage(m);
+        if (m.cmd == Command::stop && m.brake_mode == 0) {
+            m.amps = 0;     // coast, the bridge is open
+        } else {
+            m.amps = m.model.current(m.volts, m.speed, limit);
+        }
+        supply += std::fabs(m.amps * m.volts) / m.model.nominal_v;
+    }
+
+    // Over the brain's limit every motor is cut back by the same fraction
+    float share = 1;
+    if (supply > SUPPLY_LIMIT_A) {
+        share = SUPPLY_LIMIT_A / supply;
+        supply = SUPPLY_LIMIT_A;
+        over_supply_s += dt;
+    }
+    supply_amps = supply;
+    if (supply > peak_supply_amps) {
+        peak_supply_amps = supply;
+    }
+
+    for (int p = 1; p <= NUM_PORTS; p++) {
+        SimMotor& m = motor[p];
+        if (!m.present) {
+            continue;
+        }
+
+        m.amps *= share;
+        m.torque = m.model.torque(m.amps, m.speed);
+        m.temp = m.model.heat(m.temp, m.amps, dt);
+        m.counts += m.speed * dt / TWO_PI * m.ticks_per_rev;
+
+        switch (m.load) {
+            case Load::drive_left: tl += m.mount * m.torque; break;
+            case Load::drive_right: tr += m.mount * m.torque; break;
+            case Load::roller: m.roller.step(m.torque, dt); break;
+        }
+    }
+
+    drive.step(tl, tr, dt);
+
+    float wheel_turns_l = drive.left_speed() / drive.wheel_radius / TWO_PI * dt;
+    float wheel_turns_r = drive.right_speed() / drive.wheel_radius / TWO_PI * dt;
+    for (int p = 1; p <= NUM_PORTS; p++) {
+        SimRotation& r = rotation[p];
+        if (r.side == Load::drive_left) r.turns += wheel_turns_l * r.ratio;
+        if (r.side == Load::drive_right) r.turns += wheel_turns_r * r.ratio;
+    }
+}
+
+// Devices publish on their own periods, staggered by port like real ones
+void World::publish(std::uint32_t ms) {
+    for (int p = 1; p <= NUM_PORTS; p++) {
+        SimMotor& m = motor[p];
+        if (m.present && (ms + p) % MOTOR_PERIOD_MS == 0) {
+            float cpm = m.speed / TWO_PI * 60 * m.ticks_per_rev;
+            m.seen.counts = m.counts;
+            m.seen.counts_pm += 0.5f * (cpm - m.seen.counts_pm);
+            m.seen.amps = m.amps;
+            m.seen.volts = m.volts;
+            m.seen.torque = m.torque;
+            m.seen.temp = m.temp;
+            m.seen.time_ms = ms;
+        }
+
+        SimImu& imu = this->imu[p];
+        if (imu.present && (ms + p) % IMU_PERIOD_MS == 0) {
+            double deg = drive.theta * (180.0 / M_PI);
+            imu.seen_rotation = deg + imu.drift * ms / 1000.0 + noise(imu.noise);
+            imu.seen_rate = drive.omega * (float)(180.0 / M_PI);
+        }
+
+        SimGps& gps = this->gps[p];
+        if (gps.present && (ms + p) % GPS_PERIOD_MS == 0) {
+            double h = drive.theta * (180.0 / M_PI) + noise(gps.heading_noise);
+            gps.seen_x = drive.x + noise(gps.noise);
+            gps.seen_y = drive.y + noise(gps.noise);
+            gps.seen_heading = std::fmod(std::fmod(h, 360.0) + 360.0, 360.0);
+        }
+
+        SimDistance& d = distance[p];
+        if (d.present && (ms + p) % DISTANCE_PERIOD_MS == 0) {
+            // Cast the beam from the sensor against the field map
+            float x = drive.x / METERS_PER_INCH;
+            float y = drive.y / METERS_PER_INCH;
+            float sh = std::sin(drive.theta);
+            float ch = std::cos(drive.theta);
+            float beam = drive.theta + d.angle * (float)(M_PI / 180.0);
+            float sx = x + d.forward * sh + d.right * ch;
+            float sy = y + d.forward * ch - d.right * sh;
+            float in = field_raycast(sx, sy, std::sin(beam), std::cos(beam), 2000 / 25.4f);
+
+            float mm = in * 25.4f;
+            if (mm >= 2000) {
+                d.seen_mm = 9999;
+                d.seen_confidence = 0;
+            } else {
+                mm += noise(mm < 200 ? d.noise_near : d.noise_fraction * mm);
+                d.seen_mm = mm < 0 ? 0 : (std::int32_t)mm;
+                d.seen_confidence = 63;
+            }
+        }
+
+        SimRotation& r = rotation[p];
+        if (r.present && (ms + p) % MOTOR_PERIOD_MS == 0) {
+            r.seen_rate = (float)(r.turns - r.seen_turns) * 1000 / MOTOR_PERIOD_MS;
+            r.seen_turns = r.turns;
+        }
+    }
+}
+
+void World::advance_to(std::uint64_t us) {
+    while (time_us + STEP_US <= us) {
+        step(STEP_US / 1e6f);
+        time_us += STEP_US;
+
+        std::uint32_t ms = millis();
+        while (next_frame < script.size() && script[next_frame].time_ms <= ms) {
+            const ControllerFrame& f = script[next_frame++];
+            for (int i = 0; i < 4; i++) axis[i] = f.axis[i];
+            buttons = f.buttons;
+        }
+        publish(ms);
+    }
+    time_us = us;
+}
+
+}  // namespace sim
@@ -1,7 +1,42 @@
 #include "globals.h"
+#include "routes_baked.h"
 
 using namespace pros;
 
+// Turns a stage off however the command running it ends
+struct IntakeOffOnExit {
+    IntakeStage s;
+
+    ~IntakeOffOnExit() {
+        rollers.set(s, INTAKE_OFF);
+    }
+};
+
+/**
+ * Runs an intake stage until cancelled, for the tail of a deadline group.
+ */
+Command spin_intake(IntakeStage s, IntakeMode m) {
+    IntakeOffOnExit guard{s};
+    rollers.set(s, m);
+    while (true) {
+        co_await next_tick();
+    }
+}
+
+Command routine() {
+    // Intake runs for as long as the drive to the goal takes
+    co_await deadline(nav.go_to(TO_GOAL), spin_intake(INTAKE_MAIN, INTAKE_FWD));
+    co_await chassis.turn(GOAL_TURN);
+    // Don't let a blocked path eat the rest of the period
+    co_await race(nav.go_to(TO_LOADER), wait(4000));
+    co_await chassis.move(-6);
+}
+
 void movement() {
-    
-}
\ No newline at end of file
+    loc.set_pose(START_X, START_Y, START_HEADING * M_PI / 180);
+    // Let the odometry and localizer tasks pick up the reset
+    delay(2 * LOC_PERIOD_MS);
+
+    commands.run(routine());
+    commands.wait();
+}
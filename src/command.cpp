@@ -0,0 +1,272 @@
+#include "command.h"
+#include <mutex>
+
+using namespace pros;
+
+// FRAME ARENA
+//
+// Blocks are carved from the arena on first use of their size class and go
+// onto that class's free list when their frame is destroyed. Commands are
+// created from both the scheduler task and the one that calls run(), so the
+// lists are behind a mutex; it is only taken when a frame is made or freed.
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+alignas(8) unsigned char arena[COMMAND_ARENA_BYTES];
+std::size_t arena_top = 0;
+FreeBlock* free_lists[COMMAND_CLASSES] = {};
+Mutex arena_lock;
+
+std::atomic<std::uint32_t> frames_live{0};
+std::atomic<std::uint32_t> alloc_failures{0};
+
+int size_class(std::size_t size) {
+    for (int c = 0; c < COMMAND_CLASSES; c++) {
+        if (size <= (std::size_t)64 << c) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+void* command_frame_alloc(std::size_t size) noexcept {
+    int c = size_class(size);
+    if (c < 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<Mutex> lock(arena_lock);
+    void* p = nullptr;
+    if (free_lists[c]) {
+        p = free_lists[c];
+        free_lists[c] = free_lists[c]->next;
+    } else if (arena_top + ((std::size_t)64 << c) <= COMMAND_ARENA_BYTES) {
+        p = arena + arena_top;
+        arena_top += (std::size_t)64 << c;
+    }
+    if (p) {
+        frames_live++;
+    }
+    return p;
+}
+
+void command_frame_free(void* p, std::size_t size) noexcept {
+    int c = size_class(size);
+    std::lock_guard<Mutex> lock(arena_lock);
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    b->next = free_lists[c];
+    free_lists[c] = b;
+    frames_live--;
+}
+
+void command_alloc_failed() noexcept {
+    alloc_failures++;
+}
+
+// WAITERS
+
+Waiter::~Waiter() {
+    if (sched) {
+        sched->unlink(*this);
+    }
+}
+
+void CommandScheduler::link(Waiter& w) {
+    w.sched = this;
+    w.added_tick = ticks;
+    w.prev = tail;
+    w.next = nullptr;
+    if (tail) {
+        tail->next = &w;
+    } else {
+        head = &w;
+    }
+    tail = &w;
+}
+
+void CommandScheduler::unlink(Waiter& w) {
+    // Keep a walk of the list valid when its next stop goes away
+    if (visit_next == &w) {
+        visit_next = w.next;
+    }
+    if (w.prev) {
+        w.prev->next = w.next;
+    } else {
+        head = w.next;
+    }
+    if (w.next) {
+        w.next->prev = w.prev;
+    } else {
+        tail = w.prev;
+    }
+    w.prev = nullptr;
+    w.next = nullptr;
+    w.sched = nullptr;
+}
+
+// SCHEDULER
+
+CommandScheduler* CommandScheduler::running_now = nullptr;
+
+void CommandScheduler::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    alive = true;
+    task = c::task_create(task_fn, this, COMMAND_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "commands");
+}
+
+void CommandScheduler::stop() {
+    // From a command the loop can't end while this waits, so it cancels on
+    // its way out instead
+    if (c::task_get_current() == task) {
+        cancel_pending = true;
+        running = false;
+        return;
+    }
+    cancel_all();
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+bool CommandScheduler::run(Command cmd) {
+    std::lock_guard<Mutex> lock(incoming_lock);
+    if (roots_live >= COMMAND_MAX_ROOTS) {
+        return false;
+    }
+    for (Command& slot : incoming) {
+        if (!slot.handle()) {
+            slot = std::move(cmd);
+            roots_live++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommandScheduler::cancel_all() {
+    if (!alive) {
+        cancel_roots();
+        return;
+    }
+    cancel_pending = true;
+    // Only this task's next tick clears the flag, and cancelling here would
+    // destroy the command that is calling
+    if (c::task_get_current() == task) {
+        return;
+    }
+    while (cancel_pending) {
+        delay(1);
+    }
+}
+
+void CommandScheduler::wait() const {
+    while (busy()) {
+        delay(COMMAND_PERIOD_MS);
+    }
+}
+
+CommandStats CommandScheduler::stats() const {
+    return {frames_live, (std::uint32_t)arena_top, alloc_failures, ticks};
+}
+
+void CommandScheduler::task_fn(void* param) {
+    static_cast<CommandScheduler*>(param)->run_loop();
+}
+
+void CommandScheduler::run_loop() {
+    std::uint32_t wake = millis();
+
+    while (running) {
+        running_now = this;
+        tick();
+        running_now = nullptr;
+        c::task_delay_until(&wake, COMMAND_PERIOD_MS);
+    }
+
+    if (cancel_pending) {
+        cancel_roots();
+        cancel_pending = false;
+    }
+    alive = false;
+}
+
+void CommandScheduler::cancel_roots() {
+    std::lock_guard<Mutex> lock(incoming_lock);
+    for (int i = 0; i < COMMAND_MAX_ROOTS; i++) {
+        roots[i].cancel();
+        incoming[i].cancel();
+        started[i] = false;
+    }
+    roots_live = 0;
+}
+
+void CommandScheduler::tick() {
+    ticks++;
+
+    if (cancel_pending) {
+        cancel_roots();
+        cancel_pending = false;
+    }
+
+    // New top level commands take a free root slot and run to their first
+    // suspension
+    {
+        std::lock_guard<Mutex> lock(incoming_lock);
+        for (Command& cmd : incoming) {
+            if (!cmd.handle()) {
+                continue;
+            }
+            for (int i = 0; i < COMMAND_MAX_ROOTS; i++) {
+                if (!roots[i].handle()) {
+                    roots[i] = std::move(cmd);
+                    started[i] = false;
+                    break;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < COMMAND_MAX_ROOTS; i++) {
+        if (roots[i].handle() && !started[i]) {
+            started[i] = true;
+            roots[i].handle().resume();
+        }
+    }
+
+    // Resume everything that is due. Resuming can link new waiters (they
+    // wait for the next tick) and unlink ones further on (a race cancelling
+    // its other children), which visit_next follows.
+    std::uint32_t now = millis();
+    visit_next = head;
+    while (visit_next) {
+        Waiter* w = visit_next;
+        visit_next = w->next;
+        if (w->added_tick == ticks || (std::int32_t)(now - w->wake_ms) < 0) {
+            continue;
+        }
+        unlink(*w);
+        w->handle.resume();
+    }
+
+    // Finished top level commands free their frames and slots
+    for (int i = 0; i < COMMAND_MAX_ROOTS; i++) {
+        if (roots[i].handle() && roots[i].done()) {
+            roots[i].cancel();
+            started[i] = false;
+            roots_live--;
+        }
+    }
+}
+
+Command wait(std::uint32_t ms) {
+    co_await sleep_ms(ms);
+}
@@ -0,0 +1,153 @@
+#include "devices.h"
+#include <cstdio>
+
+using namespace pros;
+
+static const char* type_name(DeviceType t) {
+    switch (t) {
+        case DeviceType::none: return "nothing";
+        case DeviceType::motor: return "motor";
+        case DeviceType::rotation: return "rotation";
+        case DeviceType::imu: return "imu";
+        case DeviceType::distance: return "distance";
+        case DeviceType::radio: return "radio";
+        case DeviceType::vision: return "vision";
+        case DeviceType::adi: return "adi";
+        case DeviceType::optical: return "optical";
+        case DeviceType::gps: return "gps";
+        case DeviceType::aivision: return "ai vision";
+        case DeviceType::serial: return "serial";
+        default: return "unknown";
+    }
+}
+
+int DeviceRegistry::scan() {
+    // One pass over every port, then the map is checked against it
+    DeviceType plugged[DEVICE_PORTS + 1];
+    for (DeviceType& t : plugged) {
+        t = DeviceType::none;
+    }
+    for (Device& d : Device::get_all_devices()) {
+        if (d.get_port() >= 1 && d.get_port() <= DEVICE_PORTS) {
+            plugged[d.get_port()] = d.get_plugged_type();
+        }
+    }
+
+    std::uint32_t mask = 0;
+    int missing = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        int p = port_number(map[i].port);
+        if (plugged[p] == map[i].type) {
+            mask |= 1u << p;
+        } else {
+            std::printf("devices: %s on port %d is missing, found %s\n", map[i].name, p,
+                        type_name(plugged[p]));
+            missing++;
+        }
+    }
+
+    std::uint32_t exp = expected();
+    for (int p = 1; p <= DEVICE_PORTS; p++) {
+        if (!(exp & (1u << p)) && plugged[p] != DeviceType::none) {
+            std::printf("devices: unmapped %s on port %d\n", type_name(plugged[p]), p);
+        }
+    }
+
+    healthy = mask;
+    return missing;
+}
+
+void DeviceRegistry::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, DEVICE_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "devices");
+}
+
+void DeviceRegistry::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+std::uint32_t DeviceRegistry::expected() const {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        mask |= 1u << port_number(map[i].port);
+    }
+    return mask;
+}
+
+const char* DeviceRegistry::first_missing() const {
+    std::uint32_t h = healthy;
+    for (std::size_t i = 0; i < n; i++) {
+        if (!(h & (1u << port_number(map[i].port)))) {
+            return map[i].name;
+        }
+    }
+    return nullptr;
+}
+
+void DeviceRegistry::task_fn(void* param) {
+    static_cast<DeviceRegistry*>(param)->run();
+}
+
+bool DeviceRegistry::present(const PortEntry& e) const {
+    return Device::get_plugged_type(port_number(e.port)) == e.type;
+}
+
+void DeviceRegistry::report(const PortEntry& e, bool up) const {
+    std::printf("devices: %s on port %d %s at %lu ms\n", e.name, port_number(e.port),
+                up ? "reconnected" : "disconnected", (unsigned long)millis());
+}
+
+void DeviceRegistry::run() {
+    std::uint32_t wake = millis();
+
+    while (running) {
+        std::uint32_t h = healthy;
+
+        // A port has to read the other way DEVICE_DEBOUNCE times running
+        // before it flips, so a cable flickering once doesn't count
+        for (std::size_t i = 0; i < n; i++) {
+            const PortEntry& e = map[i];
+            int p = port_number(e.port);
+            bool was = h & (1u << p);
+
+            if (present(e) == was) {
+                pending[i] = 0;
+                continue;
+            }
+            if (++pending[i] < DEVICE_DEBOUNCE) {
+                continue;
+            }
+
+            pending[i] = 0;
+            h ^= 1u << p;
+            epochs[p]++;
+            last_change_ms = millis();
+            if (was) {
+                disconnects++;
+            } else {
+                reconnects++;
+            }
+            report(e, !was);
+        }
+
+        healthy = h;
+        c::task_delay_until(&wake, DEVICE_SCAN_MS);
+    }
+
+    alive = false;
+}
+
+std::uint32_t port_mask(const MotorGroup& mg) {
+    std::uint32_t mask = 0;
+    for (int i = 0; i < (int)mg.size(); i++) {
+        mask |= 1u << port_number(mg.get_port(i));
+    }
+    return mask;
+}
@@ -0,0 +1,106 @@
+#include "drivetrain.h"
+#include <cmath>
+
+using namespace pros;
+
+static std::int32_t clamp_mv(float mv) {
+    if (mv > 12000) return 12000;
+    if (mv < -12000) return -12000;
+    return (std::int32_t)mv;
+}
+
+drivetrain::drivetrain(MotorGroup& left, MotorGroup& right, Odometry& odom, Localizer& loc,
+                       MotionEstimator& motion)
+    : groupLeft(left), groupRight(right), odom(odom), loc(loc), motion(motion) {}
+
+void drivetrain::drive_ff(float vl, float al, float fbl, float vr, float ar, float fbr) {
+    groupLeft.move_voltage(clamp_mv(Feedforward<DRIVE_FF>::calc(vl, al) + fbl));
+    groupRight.move_voltage(clamp_mv(Feedforward<DRIVE_FF>::calc(vr, ar) + fbr));
+}
+
+void drivetrain::stop() {
+    groupLeft.move_voltage(0);
+    groupRight.move_voltage(0);
+}
+
+// Stops the drive however a command ends, including being cancelled by a
+// group while it is suspended
+struct StopOnExit {
+    drivetrain& d;
+
+    ~StopOnExit() {
+        d.stop();
+    }
+};
+
+Command drivetrain::move(float inches) {
+    Profile prof = Profile::s_curve(inches, DRIVE_MAX_VEL, DRIVE_MAX_ACCEL, DRIVE_MAX_JERK);
+    MoveControl ctl(prof, odom.get_pose(), Pid<DRIVE_PID>{}, Pid<HEADING_PID>{});
+
+    StopOnExit guard{*this};
+
+    std::uint32_t t0 = millis();
+    std::uint32_t end = t0 + ctl.timeout_ms();
+
+    while ((std::int32_t)(millis() - end) < 0) {
+        DriveCommand o = ctl.update((millis() - t0) / 1000.0f, odom.get_pose());
+        if (o.done) {
+            break;
+        }
+        drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+
+        co_await next_tick();
+    }
+}
+
+Command drivetrain::turn(float degrees) {
+    float angle = degrees * (float)(M_PI / 180.0);
+    Profile prof = Profile::s_curve(angle, TURN_MAX_VEL, TURN_MAX_ACCEL, TURN_MAX_JERK);
+    TurnControl ctl(prof, odom.get_pose().theta, TRACK_WIDTH / 2, Pid<TURN_PID>{});
+
+    StopOnExit guard{*this};
+
+    std::uint32_t t0 = millis();
+    std::uint32_t end = t0 + ctl.timeout_ms();
+
+    while ((std::int32_t)(millis() - end) < 0) {
+        DriveCommand o = ctl.update((millis() - t0) / 1000.0f, odom.get_pose().theta);
+        if (o.done) {
+            break;
+        }
+        drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+
+        co_await next_tick();
+    }
+}
+
+Command drivetrain::follow(const Path& path) {
+    if (path.size < 2) {
+        co_return;
+    }
+
+    const float half = TRACK_WIDTH / 2;
+    FollowControl ctl(path, half, Pid<PURSUIT_VEL_PID>{}, Pid<PURSUIT_VEL_PID>{});
+
+    StopOnExit guard{*this};
+
+    std::uint32_t end = millis() + ctl.timeout_ms();
+
+    while ((std::int32_t)(millis() - end) < 0) {
+        Pose p = loc.get_pose();
+
+        // Measured from the motors now, or the pose's if they have no estimate
+        MotionState sl = motion.group(MOTION_LEFT);
+        MotionState sr = motion.group(MOTION_RIGHT);
+        float ml = sl.time_ms ? sl.vel * (float)INCHES_PER_TICK : p.v + p.omega * half;
+        float mr = sr.time_ms ? sr.vel * (float)INCHES_PER_TICK : p.v - p.omega * half;
+
+        DriveCommand o = ctl.update(p, ml, mr);
+        if (o.done) {
+            break;
+        }
+        drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+
+        co_await next_tick();
+    }
+}
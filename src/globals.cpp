@@ -22,52 +22,122 @@ using namespace std;
 #define IN3 -13
 #define IN4 -5
 
+// SENSOR PORTS
+#define IMU_PORT 11
+#define GPS_PORT 12
+#define DIST_LEFT_PORT 1
+#define DIST_RIGHT_PORT 2
+#define DIST_BACK_PORT 3
+
+// PORT MAP, every device on the robot
+constexpr PortEntry PORT_MAP[] = {
+    {L1, DeviceType::motor, "L1"},
+    {L2, DeviceType::motor, "L2"},
+    {L3, DeviceType::motor, "L3"},
+    {R1, DeviceType::motor, "R1"},
+    {R2, DeviceType::motor, "R2"},
+    {R3, DeviceType::motor, "R3"},
+    {IN1, DeviceType::motor, "IN1"},
+    {IN2, DeviceType::motor, "IN2"},
+    {IN3, DeviceType::motor, "IN3"},
+    {IN4, DeviceType::motor, "IN4"},
+    {IMU_PORT, DeviceType::imu, "IMU"},
+    {GPS_PORT, DeviceType::gps, "GPS"},
+    {DIST_LEFT_PORT, DeviceType::distance, "DL"},
+    {DIST_RIGHT_PORT, DeviceType::distance, "DR"},
+    {DIST_BACK_PORT, DeviceType::distance, "DB"},
+};
+
+static_assert(ports_in_range(PORT_MAP), "a port in the map is outside 1..21");
+static_assert(ports_unique(PORT_MAP), "two devices in the map share a port");
+
+// Devices take their ports through the map, so one built on a port mapped
+// as another kind of device doesn't compile
+consteval std::int8_t motor_port(std::int8_t p) {
+    return port_of(PORT_MAP, p, DeviceType::motor);
+}
+
 // Set the master controller
 Controller ct(pros::E_CONTROLLER_MASTER);
 
+// Controller state for the current tick, refreshed by read_input()
+ControllerSnapshot ctIn;
+
 // LEFT MOTORS
-Motor mtL1(L1);
-Motor mtL2(L2);
-Motor mtL3(L3);
+Motor mtL1(motor_port(L1));
+Motor mtL2(motor_port(L2));
+Motor mtL3(motor_port(L3));
 
 // RIGHT MOTORS
-Motor mtR1(R1);
-Motor mtR2(R2);
-Motor mtR3(R3);
+Motor mtR1(motor_port(R1));
+Motor mtR2(motor_port(R2));
+Motor mtR3(motor_port(R3));
 
 // INTAKE MOTORS
-Motor mtIN1(IN1);
-Motor mtIN2(IN2);
-Motor mtIN3(IN3);
-Motor mtIN4(IN4);
+Motor mtIN1(motor_port(IN1));
+Motor mtIN2(motor_port(IN2));
+Motor mtIN3(motor_port(IN3));
+Motor mtIN4(motor_port(IN4));
+
+// SENSORS
+Imu imu(port_of(PORT_MAP, IMU_PORT, DeviceType::imu));
+Gps gps(port_of(PORT_MAP, GPS_PORT, DeviceType::gps));
 
 // MOTOR GROUPS
 // Setup vector for ports & then initialize
-std::vector<std::int8_t> portsL = {L1, L2, L3};
+std::vector<std::int8_t> portsL = {motor_port(L1), motor_port(L2), motor_port(L3)};
 MotorGroup mgL (portsL);
 
-vector<std::int8_t> portsR = {R1, R2, R3};
+vector<std::int8_t> portsR = {motor_port(R1), motor_port(R2), motor_port(R3)};
 MotorGroup mgR (portsR);
 
-vector<std::int8_t> portsIN = {IN1, IN2};
+vector<std::int8_t> portsIN = {motor_port(IN1), motor_port(IN2)};
 MotorGroup mgIN (portsIN);
 
-// test for classes
-class drivetrain {
-    public:
-        MotorGroup groupLeft;
-        MotorGroup groupRight;
+// DEVICE REGISTRY (port map and hot-plug health)
+DeviceRegistry devices(PORT_MAP);
+
+// INTAKE (jam detecting roller stages)
+Intake rollers;
 
-        void move() {
+// POWER (shared current and thermal budget)
+PowerBudget power(rollers);
 
-        }
+// CONTROL LOOP SCHEDULER
+Scheduler sched;
 
-        void turn() {
+// MOTOR VELOCITY (timestamped encoder fits)
+MotionEstimator motion;
 
-        }
+// ODOMETRY
+Odometry odom(mgL, mgR, imu);
+
+// PARTICLE FILTER (distance sensors against the field map)
+// Mounts from the tracking center, measure these on the robot
+constexpr DistanceMount MCL_SENSORS[] = {
+    {port_of(PORT_MAP, DIST_LEFT_PORT, DeviceType::distance), 0, -6.5f, -90},
+    {port_of(PORT_MAP, DIST_RIGHT_PORT, DeviceType::distance), 0, 6.5f, 90},
+    {port_of(PORT_MAP, DIST_BACK_PORT, DeviceType::distance), -7.0f, 0, 180},
 };
+ParticleLocalizer mcl(odom, MCL_SENSORS);
+
+// FUSED POSE (odometry + GPS + particle filter)
+Localizer loc(odom, gps);
+
+// DRIVETRAIN (profiled moves and path following)
+drivetrain chassis(mgL, mgR, odom, loc, motion);
+
+// PATH PLANNING (occupancy grid and any-angle planner)
+Navigator nav(chassis, loc);
+
+// AUTONOMOUS COMMANDS (coroutine scheduler)
+CommandScheduler commands;
+
+// DRIVER INPUT RECORDING / REPLAY
+InputRecorder recorder;
+
+// TELEMETRY LOG (SD card)
+TelemetryLog telem(odom, loc);
 
-class intake {
-    public:
-        Motor mt1;
-};
\ No newline at end of file
+// CONTROL TICK STAGE LATENCY
+TickProfile tick_prof;
@@ -0,0 +1,41 @@
+#include "globals.h"
+
+void ControllerSnapshot::update(Controller& c) {
+    std::int8_t axes[NUM_AXES];
+    for (int i = 0; i < NUM_AXES; i++) {
+        axes[i] = c.get_analog((controller_analog_e_t)i);
+    }
+
+    std::uint16_t buttons = 0;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        controller_digital_e_t btn = (controller_digital_e_t)(E_CONTROLLER_DIGITAL_L1 + i);
+        if (c.get_digital(btn)) {
+            buttons |= BTN_BIT(btn);
+        }
+    }
+
+    apply(axes, buttons, millis());
+}
+
+void ControllerSnapshot::apply(const std::int8_t* axes, std::uint16_t buttons, std::uint32_t time) {
+    for (int i = 0; i < NUM_AXES; i++) {
+        axis[i] = axes[i];
+    }
+
+    pressed = buttons & ~held;
+    released = held & ~buttons;
+    held = buttons;
+    time_ms = time;
+}
+
+void read_input() {
+    tick_prof.begin_tick();
+    StageTimer t(tick_prof, STAGE_INPUT);
+
+    if (recorder.replaying()) {
+        recorder.replay(ctIn);
+        return;
+    }
+    ctIn.update(ct);
+    recorder.append(ctIn);
+}
@@ -0,0 +1,227 @@
+#include "intake.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace pros;
+
+bool Intake::add(IntakeStage s, std::int8_t port, int dir) {
+    Stage& st = stages[s];
+    if (running || st.count >= INTAKE_STAGE_MOTORS) {
+        return false;
+    }
+    st.port[st.count] = port;
+    st.dir[st.count] = dir < 0 ? -1 : 1;
+    st.count++;
+    return true;
+}
+
+void Intake::add(IntakeStage s, const MotorGroup& mg, int dir) {
+    for (int i = 0; i < (int)mg.size(); i++) {
+        add(s, mg.get_port(i), dir);
+    }
+}
+
+int Intake::motors(IntakeStage s, std::int8_t* port, std::int8_t* dir) const {
+    const Stage& st = stages[s];
+    for (int i = 0; i < st.count; i++) {
+        port[i] = st.port[i];
+        dir[i] = st.dir[i];
+    }
+    return st.count;
+}
+
+void Intake::start() {
+    if (running) {
+        return;
+    }
+
+    // The motor's own velocity reads in rpm of the cartridge it is set to
+    for (Stage& s : stages) {
+        for (int i = 0; i < s.count; i++) {
+            motor_gearset_e_t g = c::motor_get_gearing(s.port[i]);
+            s.counts_per_rev[i] = g == E_MOTOR_GEAR_RED ? 1800 : g == E_MOTOR_GEAR_BLUE ? 300 : 900;
+        }
+    }
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, INTAKE_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "intake");
+}
+
+void Intake::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+
+    // Stopping doesn't wait on the slew
+    for (Stage& s : stages) {
+        s.want = INTAKE_OFF;
+        s.mode = INTAKE_OFF;
+        s.state = ROLLER_IDLE;
+        s.timed = false;
+        aim(s, 0);
+        s.written = 0;
+        for (int i = 0; i < s.count; i++) {
+            c::motor_move_voltage(s.port[i], 0);
+        }
+    }
+    slew.reset();
+}
+
+void Intake::off() {
+    for (int i = 0; i < INTAKE_STAGES; i++) {
+        set((IntakeStage)i, INTAKE_OFF);
+    }
+}
+
+void Intake::task_fn(void* param) {
+    static_cast<Intake*>(param)->run();
+}
+
+void Intake::run() {
+    std::uint32_t wake = millis();
+
+    while (running) {
+        std::uint32_t now = millis();
+        for (Stage& s : stages) {
+            // Keep handling until the stage settles, so a mode change and a
+            // timeout landing together are both seen this sample
+            for (Event e = poll(s, now); e != EV_NONE; e = poll(s, now)) {
+                handle(s, e, now);
+            }
+        }
+        write_outputs();
+        c::task_delay_until(&wake, INTAKE_PERIOD_MS);
+    }
+
+    alive = false;
+}
+
+Intake::Event Intake::poll(Stage& s, std::uint32_t now) {
+    if (s.want != s.mode) {
+        return EV_MODE;
+    }
+    if (s.timed && (std::int32_t)(now - s.deadline) >= 0) {
+        s.timed = false;
+        return EV_TIMEOUT;
+    }
+    if (s.state != ROLLER_RUNNING) {
+        return EV_NONE;
+    }
+
+    // Any one motor pulling hard while barely turning stalls the whole stage,
+    // they share the same game elements. Hard is measured against the motor's
+    // current limit too, the power budget may have it below STALL_CURRENT_MA.
+    bool stalled = false;
+    for (int i = 0; i < s.count; i++) {
+        std::int32_t ma = c::motor_get_current_draw(s.port[i]);
+        MotionState m = motion ? motion->motor(s.port[i]) : MotionState{0, 0, 0};
+        float speed = m.time_ms ? m.vel : c::motor_get_actual_velocity(s.port[i]) * s.counts_per_rev[i] / 60;
+        std::int32_t hard = std::min(STALL_CURRENT_MA, c::motor_get_current_limit(s.port[i]) * 9 / 10);
+        if (std::abs(ma) >= hard && std::fabs(speed) < FREE_COUNTS_S * STALL_SPEED_PCT / 100) {
+            stalled = true;
+        }
+    }
+
+    if (!stalled) {
+        s.stall_since = 0;
+        return EV_NONE;
+    }
+    if (s.stall_since == 0) {
+        s.stall_since = now ? now : 1;
+        return EV_NONE;
+    }
+    return now - s.stall_since >= STALL_MS ? EV_STALL : EV_NONE;
+}
+
+void Intake::handle(Stage& s, Event e, std::uint32_t now) {
+    int sign = s.mode == INTAKE_FWD ? 1 : s.mode == INTAKE_REV ? -1 : 0;
+
+    switch (e) {
+        case EV_MODE:
+            s.mode = s.want;
+            sign = s.mode == INTAKE_FWD ? 1 : s.mode == INTAKE_REV ? -1 : 0;
+            if (s.mode == INTAKE_OFF) {
+                aim(s, 0);
+                enter(s, ROLLER_IDLE, now, 0);
+            } else if (s.state != ROLLER_REST) {
+                // A new command from the driver starts the jam count over.
+                // Resting stages wait out the rest and then run the new mode.
+                s.tries = 0;
+                aim(s, sign);
+                enter(s, ROLLER_SPINUP, now, SPINUP_MS);
+            }
+            break;
+
+        case EV_TIMEOUT:
+            if (s.state == ROLLER_SPINUP) {
+                enter(s, ROLLER_RUNNING, now, 0);
+            } else if (s.state == ROLLER_UNJAM) {
+                aim(s, sign);
+                enter(s, ROLLER_SPINUP, now, SPINUP_MS);
+            } else if (s.state == ROLLER_REST) {
+                s.tries = 0;
+                aim(s, sign);
+                enter(s, sign ? ROLLER_SPINUP : ROLLER_IDLE, now, sign ? SPINUP_MS : 0);
+            }
+            break;
+
+        case EV_STALL:
+            s.jams++;
+            s.last_jam_ms = now;
+            if (now - s.window_start > UNJAM_WINDOW_MS) {
+                s.window_start = now;
+                s.tries = 0;
+            }
+
+            if (++s.tries > UNJAM_TRIES) {
+                // Not clearing, stop rather than cook the motors
+                s.rests++;
+                s.tries = 0;
+                aim(s, 0);
+                enter(s, ROLLER_REST, now, JAM_REST_MS);
+            } else {
+                aim(s, -sign);
+                enter(s, ROLLER_UNJAM, now, UNJAM_REVERSE_MS);
+            }
+            break;
+
+        case EV_NONE:
+            break;
+    }
+}
+
+void Intake::aim(Stage& s, int sign) {
+    s.sign = sign;
+}
+
+// Every stage's voltage through the slew limiter in one pass, then only the
+// stages whose output changed are written
+void Intake::write_outputs() {
+    float out[INTAKE_STAGES];
+    for (int i = 0; i < INTAKE_STAGES; i++) {
+        out[i] = stages[i].sign * INTAKE_VOLTAGE;
+    }
+    slew.apply(out);
+
+    for (int i = 0; i < INTAKE_STAGES; i++) {
+        Stage& s = stages[i];
+        std::int32_t mv = std::lround(out[i]);
+        if (mv == s.written) {
+            continue;
+        }
+        for (int j = 0; j < s.count; j++) {
+            c::motor_move_voltage(s.port[j], s.dir[j] * mv);
+        }
+        s.written = mv;
+    }
+}
+
+void Intake::enter(Stage& s, IntakeState st, std::uint32_t now, std::uint32_t timeout_ms) {
+    s.state = st;
+    s.stall_since = 0;
+    s.timed = timeout_ms != 0;
+    s.deadline = now + timeout_ms;
+}
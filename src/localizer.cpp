@@ -0,0 +1,184 @@
+#include "localizer.h"
+#include <cmath>
+
+using namespace pros;
+
+Localizer::Localizer(Odometry& odom, Gps& gps) : odom(odom), gps(gps) {}
+
+void Localizer::start() {
+    if (running) {
+        return;
+    }
+
+    Pose p = odom.get_pose();
+    ekf.reset(p.x, p.y, p.theta, 2.0f, 0.05f);
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, LOC_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "localizer");
+}
+
+void Localizer::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+void Localizer::set_pose(float x, float y, float theta) {
+    std::uint32_t seq = odom.set_pose(x, y, theta);
+    if (mcl) {
+        mcl->set_pose(x, y, seq);
+    }
+
+    Pose p = {};
+    p.x = x;
+    p.y = y;
+    p.theta = theta;
+    p.time_ms = millis();
+    p.reset_seq = seq;
+
+    if (!alive) {
+        ekf.reset(x, y, theta, 0.5f, 0.02f);
+        pose.write(p);
+        return;
+    }
+    reset_to.write(p);
+    reset_pending = true;
+}
+
+void Localizer::task_fn(void* param) {
+    static_cast<Localizer*>(param)->run();
+}
+
+// Latest GPS fix in the pose convention, false if there is no new usable fix
+bool Localizer::read_gps(float& x, float& y, float& theta, float& sd) {
+    double err = gps.get_error();
+    if (!std::isfinite(err) || err > GPS_MAX_ERROR) {
+        return false;
+    }
+
+    gps_status_s_t s = gps.get_position_and_orientation();
+    double heading = gps.get_heading();
+    if (!std::isfinite(s.x) || !std::isfinite(heading)) {
+        return false;
+    }
+
+    // The sensor reports slower than we poll, skip repeats
+    if (s.x == last_gps_x && s.y == last_gps_y) {
+        return false;
+    }
+    last_gps_x = s.x;
+    last_gps_y = s.y;
+
+    x = s.x * METERS_TO_INCHES;
+    y = s.y * METERS_TO_INCHES;
+    theta = heading * (float)(M_PI / 180.0);
+    sd = std::fmax(err, 0.005) * METERS_TO_INCHES;
+    return true;
+}
+
+// Latest particle filter fix, false if there is no new one tight enough to use
+bool Localizer::read_mcl(MclFix& f) {
+    if (!mcl) {
+        return false;
+    }
+    f = mcl->fix();
+    if (f.time_ms == 0 || (std::int32_t)(f.time_ms - last_mcl_ms) <= 0) {
+        return false;
+    }
+    last_mcl_ms = f.time_ms;
+    return f.sd_xy <= MCL_MAX_SD;
+}
+
+void Localizer::run() {
+    Pose prev = odom.get_pose();
+    std::uint32_t seen = 0;
+    std::uint32_t resync_seq = 0;
+    bool resync = false;
+    std::uint32_t wake = millis();
+
+    while (running) {
+        std::uint64_t start = micros();
+
+        if (reset_pending.exchange(false)) {
+            Pose r = reset_to.read();
+            ekf.reset(r.x, r.y, r.theta, 0.5f, 0.02f);
+            // The odometry applies the same reset on its next step, don't
+            // difference across it. Its poses can lag the reset by a step, so
+            // wait for one numbered with it rather than one newer than it.
+            resync = true;
+            resync_seq = r.reset_seq;
+            // and fixes from before the reset are for the old pose
+            last_mcl_ms = r.time_ms;
+        }
+
+        Pose cur = odom.get_pose();
+        if (resync && (std::int32_t)(cur.reset_seq - resync_seq) >= 0) {
+            resync = false;
+            prev = cur;
+            seen = cur.time_ms;
+        }
+
+        if (!resync && cur.time_ms != seen) {
+            seen = cur.time_ms;
+
+            // Odometry step expressed as distance along the mid-step heading
+            float dtheta = cur.theta - prev.theta;
+            float mid = prev.theta + dtheta / 2;
+            float dx = cur.x - prev.x;
+            float dy = cur.y - prev.y;
+            float ds = dx * std::sin(mid) + dy * std::cos(mid);
+            float dt = (cur.time_ms - prev.time_ms) / 1000.0f;
+
+            ekf.predict(ds, dtheta, dt);
+            prev = cur;
+        }
+
+        float gx, gy, gt, sd;
+        if (read_gps(gx, gy, gt, sd)) {
+            if (ekf.update(gx, gy, gt, sd, GPS_THETA_SD)) {
+                st.updates++;
+                last_gps_ok_ms = millis();
+            } else {
+                st.rejected++;
+            }
+        }
+
+        // The fix is for an odometry pose a period or so back, carry it
+        // forward by what the odometry has moved since
+        MclFix mf;
+        if (read_mcl(mf)) {
+            float fx = mf.x + cur.x - mf.odom_x;
+            float fy = mf.y + cur.y - mf.odom_y;
+            float ft = mf.theta + cur.theta - mf.odom_theta;
+            if (ekf.update(fx, fy, ft, mf.sd_xy, mf.sd_theta)) {
+                st.updates++;
+                mcl_rejects = 0;
+            } else {
+                st.rejected++;
+                if (++mcl_rejects >= MCL_MAX_REJECTS && millis() - last_gps_ok_ms >= LOC_GPS_QUIET_MS) {
+                    ekf.reset(fx, fy, ft, mf.sd_xy, mf.sd_theta);
+                    mcl_rejects = 0;
+                    st.relocalized++;
+                }
+            }
+        }
+
+        Pose out = cur;
+        out.x = ekf.x(0, 0);
+        out.y = ekf.x(1, 0);
+        out.theta = ekf.x(2, 0);
+        out.time_ms = millis();
+        pose.write(out);
+
+        st.last_us = micros() - start;
+        if (st.last_us > st.max_us) {
+            st.max_us = st.last_us;
+        }
+
+        c::task_delay_until(&wake, LOC_PERIOD_MS);
+    }
+
+    alive = false;
+}
@@ -1,5 +1,6 @@
 #include "main.h"
 #include "globals.h"
+#include <bit>
 
 /**
  * A callback function for LLEMU's center button.
@@ -17,6 +18,29 @@ void on_center_button() {
 	}
 }
 
+// Which opcontrol() screen is showing, 0 loop periods, 1 tick stage latency,
+// 2 power budget and devices
+static std::atomic<int> lcd_page{0};
+
+/**
+ * Steps the opcontrol() screen to the next page.
+ */
+void on_left_button() {
+	lcd_page = (lcd_page + 1) % 3;
+}
+
+// What autonomous() runs, switched on the screen in competition_initialize()
+static std::atomic<bool> run_sysid{false};
+
+/**
+ * Switches autonomous() between the match routine and feedforward
+ * characterization.
+ */
+void on_right_button() {
+	run_sysid = !run_sysid;
+	pros::lcd::set_text(2, run_sysid ? "auton: sysid" : "auton: routine");
+}
+
 /**
  * Runs initialization code. This occurs as soon as the program is started.
  *
@@ -28,6 +52,68 @@ void initialize() {
 	pros::lcd::set_text(1, "Hello Falcons from PROS V5");
 
 	pros::lcd::register_btn1_cb(on_center_button);
+	pros::lcd::register_btn0_cb(on_left_button);
+
+	// Check the port map against what is plugged in, then keep watching
+	if (devices.scan()) {
+		pros::lcd::print(2, "missing %s", devices.first_missing());
+	}
+	devices.start();
+
+	// Velocity from every drive and intake motor's timestamped counts, for
+	// the path follower and the intake's jam detection
+	motion.use_devices(devices);
+	motion.add(MOTION_LEFT, mgL);
+	motion.add(MOTION_RIGHT, mgR);
+	motion.add(MOTION_INTAKE, mgIN);
+	motion.add(MOTION_INTAKE, mtIN3.get_port());
+	motion.add(MOTION_INTAKE, mtIN4.get_port());
+	motion.start();
+
+	// Odometry needs a calibrated IMU, this blocks for about two seconds
+	imu.reset(true);
+	odom.use_devices(devices);
+	odom.start();
+	mcl.start();
+	loc.use_mcl(mcl);
+	loc.start();
+
+	// The field's planning grid, baked into flash
+	nav.init();
+
+	// Autonomous routines run as commands in their own task
+	commands.start();
+
+	// Main rollers pull in with mgIN reversed against mtIN3, the top roller
+	// on its own. The intake task owns these motors from here on.
+	rollers.add(INTAKE_MAIN, mgIN, -1);
+	rollers.add(INTAKE_MAIN, mtIN3.get_port(), 1);
+	rollers.add(INTAKE_TOP, mtIN4.get_port(), 1);
+	rollers.use_motion(motion);
+	rollers.start();
+
+	// All ten motors share the brain's current, drive first when pushing
+	// and intake first when cycling
+	power.add(POWER_DRIVE, mgL);
+	power.add(POWER_DRIVE, mgR);
+	power.add(POWER_INTAKE, mgIN);
+	power.add(POWER_INTAKE, mtIN3.get_port());
+	power.add(POWER_INTAKE, mtIN4.get_port());
+	power.start();
+
+	// Driver control loops, run in this order every tick by the scheduler
+	sched.add("input", read_input, 10);
+	sched.add("drive", drive, DRIVE_PERIOD_MS);
+	sched.add("intake", intake, 10);
+
+	// Log every motor, both poses and the loop timing for the whole session
+	telem.add_motors(mgL);
+	telem.add_motors(mgR);
+	telem.add_motors(mgIN);
+	telem.add_motor(mtIN3.get_port());
+	telem.add_motor(mtIN4.get_port());
+	sched.set_log(&telem);
+	telem.start();
 }
 
 /**
@@ -35,7 +121,21 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+	// The auton task is killed on disable, the commands it started are not
+	commands.cancel_all();
+	sched.stop();
+	rollers.off();
+
+	// Keep the driver period that just ended, it can be replayed as an auton
+	if (recorder.recording()) {
+		recorder.stop();
+		recorder.save(RECORD_PATH);
+	}
+
+	// Get the period that just ended onto the card
+	telem.flush();
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -46,7 +146,10 @@ void disabled() {}
  * This task will exit when the robot is enabled and autonomous or opcontrol
  * starts.
  */
-void competition_initialize() {}
+void competition_initialize() {
+	pros::lcd::register_btn2_cb(on_right_button);
+	pros::lcd::set_text(2, run_sysid ? "auton: sysid" : "auton: routine");
+}
 
 /**
  * Runs the user autonomous code. This function will be started in its own task
@@ -59,7 +162,19 @@ void competition_initialize() {}
  * will be stopped. Re-enabling the robot will restart the task, not re-start it
  * from where it left off.
  */
-void autonomous() {}
+void autonomous() {
+	sched.stop();
+
+	// Characterization picked on the screen, then a recorded driver run on
+	// the SD card, take the place of the routine
+	if (run_sysid) {
+		sysid();
+	} else if (recorder.load(REPLAY_PATH)) {
+		replay_recording();
+	} else {
+		movement();
+	}
+}
 
 /**
  * Runs the operator control code. This function will be started in its own task
@@ -75,9 +190,52 @@ void autonomous() {}
  * task, not resume it from where it left off.
  */
 void opcontrol() {
+	commands.cancel_all();
+	recorder.start();
+	sched.reset_stats();
+	tick_prof.reset();
+	reset_drive();
+	sched.start();
+
+	// The control loops run in the scheduler task, this task only reports
+	// how well they are keeping to their periods and how long each stage of
+	// a tick takes, on the screen and once a second to the log
+	std::uint32_t next_log = pros::millis() + PROFILE_LOG_MS;
 	while (true) {
-		drive();
-		intake();
-		//pros::delay(20);
+		if (lcd_page == 0) {
+			for (int i = 0; i < 4; i++) {
+				if (i < sched.count()) {
+					LoopStats s = sched.stats(i);
+					pros::lcd::print(3 + i, "%s %luus max %luus ovr %lu", sched.name(i),
+					                 s.avg_period_us, s.max_period_us, s.overruns);
+				} else {
+					pros::lcd::clear_line(3 + i);
+				}
+			}
+			Pose p = loc.get_pose();
+			pros::lcd::print(7, "x %.1f y %.1f th %.1f", p.x, p.y, p.theta * 180 / M_PI);
+		} else if (lcd_page == 1) {
+			tick_prof.print(3);
+		} else {
+			static const char* const modes[] = {"balanced", "pushing", "cycling"};
+			PowerStats ps = power.stats();
+			pros::lcd::print(3, "power %s", modes[ps.mode]);
+			pros::lcd::print(4, "draw %ld mA peak %ld mA", (long)ps.draw_ma, (long)ps.peak_ma);
+			pros::lcd::print(5, "short %lu samples", (unsigned long)ps.short_samples);
+			pros::lcd::print(6, "hottest %.1f C", ps.hottest_c);
+
+			int missing = std::popcount(devices.expected() & ~devices.health());
+			if (missing) {
+				pros::lcd::print(7, "missing %s (%d total)", devices.first_missing(), missing);
+			} else {
+				pros::lcd::set_text(7, "all devices connected");
+			}
+		}
+
+		if ((std::int32_t)(pros::millis() - next_log) >= 0) {
+			next_log += PROFILE_LOG_MS;
+			tick_prof.log(telem);
+		}
+		pros::delay(100);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,436 @@
+#include "mcl.h"
+#include <bit>
+#include <cmath>
+
+// The loops over particles are written to run on NEON. The project builds at
+// -Os, which doesn't vectorize, and NEON floats flush denormals to zero so
+// GCC only uses them for float math when allowed to be inexact. Set here for
+// this file's functions: common.mk bakes EXTRA_CXXFLAGS into its rules
+// before a per-target value could take effect. Not yet timed on the brain.
+#pragma GCC optimize("O2", "tree-vectorize", "unsafe-math-optimizations")
+
+using namespace pros;
+
+// Squared distance to the nearest wall for each half inch of the field
+static FieldGrid field_grid;
+static bool grid_built = false;
+
+// Integer hash, so each particle's noise is a function of its index and the
+// step and the noise loop has no dependency from one particle to the next
+static inline std::uint32_t mix(std::uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// Noise with sd 1 from one hash: the difference of two uniforms is
+// triangular with variance 1/6, close enough to normal for motion noise
+static inline float tri(std::uint32_t h) {
+    return ((float)(h & 0xffff) - (float)(h >> 16)) * (2.449f / 65536);
+}
+
+// sin and cos of base + d from those of base, for the small d a particle's
+// heading is off the odometry's
+static inline void rotate(float so, float co, float d, float& s, float& c) {
+    float d2 = d * d;
+    float cd = 1 - d2 * 0.5f;
+    float sd = d - d * d2 * (1.0f / 6);
+    s = so * cd + co * sd;
+    c = co * cd - so * sd;
+}
+
+void ParticleLocalizer::add_sensor(const DistanceMount& m) {
+    mounts[sensors.size()] = m;
+    sensors.emplace_back(m.port);
+}
+
+void ParticleLocalizer::start() {
+    if (running) {
+        return;
+    }
+    if (!grid_built) {
+        build_field_grid(field_grid);
+        grid_built = true;
+    }
+
+    Pose p = odom.get_pose();
+    seed(p.x, p.y, 2.0f, 0.02f);
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, MCL_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "mcl");
+}
+
+void ParticleLocalizer::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+void ParticleLocalizer::set_pose(float x, float y, std::uint32_t reset_seq) {
+    if (!alive) {
+        seed(x, y, 0.5f, 0.01f);
+        return;
+    }
+    Pose p = {};
+    p.x = x;
+    p.y = y;
+    p.time_ms = millis();
+    p.reset_seq = reset_seq;
+    reset_to.write(p);
+    reset_pending = true;
+}
+
+void ParticleLocalizer::task_fn(void* param) {
+    static_cast<ParticleLocalizer*>(param)->run();
+}
+
+void ParticleLocalizer::seed(float x, float y, float sd_xy, float sd_theta) {
+    cur = 0;
+    n = MCL_MAX_PARTICLES;
+    fit_slow = 0;
+    fit_fast = 0;
+    std::uint32_t base = rng;
+    rng = mix(rng + 1);
+
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint32_t h = base + 3 * (std::uint32_t)i;
+        px[0][i] = x + sd_xy * tri(mix(h));
+        py[0][i] = y + sd_xy * tri(mix(h + 1));
+        pt[0][i] = sd_theta * tri(mix(h + 2));
+        w[i] = 1.0f / n;
+    }
+}
+
+void ParticleLocalizer::motion(float ds, float dtheta, float odom_mid) {
+    float so = std::sin(odom_mid);
+    float co = std::cos(odom_mid);
+    float sd_d = MCL_NOISE_DIST * std::fabs(ds) + MCL_NOISE_XY;
+    float sd_t = MCL_NOISE_TURN * std::fabs(dtheta) + MCL_NOISE_THETA;
+
+    std::uint32_t base = rng;
+    rng = mix(rng + 1);
+
+    float* x = px[cur];
+    float* y = py[cur];
+    float* t = pt[cur];
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint32_t h = base + 3 * (std::uint32_t)i;
+        float d = ds + sd_d * tri(mix(h));
+        float side = MCL_NOISE_XY * tri(mix(h + 1));
+        t[i] += sd_t * tri(mix(h + 2));
+
+        float s, c;
+        rotate(so, co, t[i], s, c);
+        x[i] += d * s + side * c;
+        y[i] += d * c - side * s;
+    }
+}
+
+int ParticleLocalizer::read_sensors(Reading* r, float speed) {
+    int k = 0;
+    for (std::size_t i = 0; i < sensors.size(); i++) {
+        std::int32_t mm = sensors[i].get_distance();
+        if (mm == PROS_ERR || mm < MCL_RANGE_MIN_MM || mm > MCL_RANGE_MAX_MM) {
+            continue;
+        }
+        if (mm > MCL_CONFIDENCE_MM && sensors[i].get_confidence() < MCL_MIN_CONFIDENCE) {
+            continue;
+        }
+
+        float z = mm / 25.4f;
+        float sd = mm > MCL_CONFIDENCE_MM ? MCL_SD_FRACTION * z : MCL_SD_NEAR;
+        float a = mounts[i].angle * (float)(M_PI / 180.0);
+
+        // The reading is from a little while ago, by up to this much along
+        // the beam at the current speed
+        float lag = speed * MCL_READING_AGE * std::cos(a);
+        float var = sd * sd + MCL_SD_MAP * MCL_SD_MAP + lag * lag;
+        r[k++] = {mounts[i].forward + z * std::cos(a), mounts[i].right + z * std::sin(a), 0.5f / var};
+    }
+    return k;
+}
+
+float ParticleLocalizer::score(const Reading* r, int count, float odom_theta) {
+    constexpr float inv_cell = 1 / FIELD_GRID_CELL;
+    constexpr float top = FIELD_GRID_N - 1;
+
+    const float* x = px[cur];
+    const float* y = py[cur];
+    const float* t = pt[cur];
+
+    float so = std::sin(odom_theta);
+    float co = std::cos(odom_theta);
+    for (std::size_t i = 0; i < n; i++) {
+        rotate(so, co, t[i], sn[i], cs[i]);
+        ll[i] = 0;
+    }
+
+    for (int j = 0; j < count; j++) {
+        float ahead = r[j].ahead;
+        float right = r[j].right;
+        float k = r[j].inv_2var / FIELD_GRID_D2_SCALE;
+
+        // Where the reading ends for each particle, as a grid cell
+        for (std::size_t i = 0; i < n; i++) {
+            float ex = x[i] + ahead * sn[i] + right * cs[i];
+            float ey = y[i] + ahead * cs[i] - right * sn[i];
+            float fx = (ex - FIELD_GRID_ORIGIN) * inv_cell;
+            float fy = (ey - FIELD_GRID_ORIGIN) * inv_cell;
+            fx = fx < 0 ? 0 : fx > top ? top : fx;
+            fy = fy < 0 ? 0 : fy > top ? top : fy;
+            cell[i] = (std::uint32_t)fy * FIELD_GRID_N + (std::uint32_t)fx;
+        }
+
+        // Gaussian in the distance to the nearest wall, which the grid clamps
+        // so one reading off an unmapped robot can only cost so much
+        for (std::size_t i = 0; i < n; i++) {
+            ll[i] -= field_grid.d2[cell[i]] * k;
+        }
+    }
+
+    // Weights carry over from the last scoring until a resample evens them
+    float best = ll[0];
+    for (std::size_t i = 1; i < n; i++) {
+        best = ll[i] > best ? ll[i] : best;
+    }
+    float sum = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        w[i] *= std::exp(ll[i] - best);
+        sum += w[i];
+    }
+
+    // How well the readings fit the set as a whole, as a per reading
+    // likelihood so it compares between scorings with different counts
+    fit = std::exp((std::log(sum) + best) / count);
+
+    // Every particle that the readings liked had next to no weight left, start
+    // the weights over and let the caller resample
+    if (!(sum > 1e-30f)) {
+        for (std::size_t i = 0; i < n; i++) {
+            w[i] = 1.0f / n;
+        }
+        return 0;
+    }
+
+    // Normalize, and how many particles are really carrying the estimate
+    float inv = 1 / sum;
+    float sq = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        w[i] *= inv;
+        sq += w[i] * w[i];
+    }
+    return 1 / sq;
+}
+
+void ParticleLocalizer::estimate(const Pose& at) {
+    const float* x = px[cur];
+    const float* y = py[cur];
+    const float* t = pt[cur];
+
+    float mx = 0, my = 0, mt = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        mx += w[i] * x[i];
+        my += w[i] * y[i];
+        mt += w[i] * t[i];
+    }
+    float vx = 0, vy = 0, vt = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        float dx = x[i] - mx;
+        float dy = y[i] - my;
+        float dt = t[i] - mt;
+        vx += w[i] * dx * dx;
+        vy += w[i] * dy * dy;
+        vt += w[i] * dt * dt;
+    }
+
+    MclFix f;
+    f.x = mx;
+    f.y = my;
+    f.theta = at.theta + mt;
+    f.sd_xy = std::fmax(std::sqrt((vx + vy) / 2), MCL_FIX_SD_MIN);
+    f.sd_theta = std::fmax(std::sqrt(vt), MCL_FIX_THETA_SD_MIN);
+    est_x = mx;
+    est_y = my;
+    est_t = mt;
+
+    f.odom_x = at.x;
+    f.odom_y = at.y;
+    f.odom_theta = at.theta;
+    f.time_ms = millis();
+    out.write(f);
+}
+
+// Particles for the spread of the current set, from how many KLD bins the
+// particles that still carry weight fall in
+std::size_t ParticleLocalizer::kld_count() const {
+    constexpr int BITS = 4096;
+    std::uint32_t bins[BITS / 32] = {};
+    float floor = 0.1f / n;
+
+    for (std::size_t i = 0; i < n; i++) {
+        if (w[i] < floor) {
+            continue;
+        }
+        std::int32_t bx = (std::int32_t)std::floor(px[cur][i] / MCL_KLD_BIN_XY);
+        std::int32_t by = (std::int32_t)std::floor(py[cur][i] / MCL_KLD_BIN_XY);
+        std::int32_t bt = (std::int32_t)std::floor(pt[cur][i] / MCL_KLD_BIN_THETA);
+        std::uint32_t h = mix((std::uint32_t)bx * 73856093u ^ (std::uint32_t)by * 19349663u ^
+                              (std::uint32_t)bt * 83492791u) % BITS;
+        bins[h / 32] |= 1u << (h % 32);
+    }
+
+    int k = 0;
+    for (std::uint32_t b : bins) {
+        k += std::popcount(b);
+    }
+    if (k < 2) {
+        return MCL_MIN_PARTICLES;
+    }
+
+    // Samples for the KL distance to the true posterior to stay under
+    // epsilon with probability 1 - delta (Fox, 2003)
+    float a = 2.0f / (9 * (k - 1));
+    float c = 1 - a + std::sqrt(a) * MCL_KLD_Z;
+    float want = (k - 1) / (2 * MCL_KLD_EPSILON) * c * c * c;
+    if (want < MCL_MIN_PARTICLES) return MCL_MIN_PARTICLES;
+    if (want > MCL_MAX_PARTICLES) return MCL_MAX_PARTICLES;
+    return (std::size_t)want;
+}
+
+// Low variance resampling into the other set, with a fraction of it
+// replaced by recovery particles
+void ParticleLocalizer::resample(float inject) {
+    std::size_t m = kld_count();
+    int next = 1 - cur;
+
+    float step = 1.0f / m;
+    float u = step * (mix(rng) & 0xffffff) / 16777216.0f;
+    rng = mix(rng + 1);
+
+    float c = w[0];
+    std::size_t j = 0;
+    for (std::size_t k = 0; k < m; k++) {
+        float target = u + k * step;
+        while (target > c && j < n - 1) {
+            c += w[++j];
+        }
+        px[next][k] = px[cur][j];
+        py[next][k] = py[cur][j];
+        pt[next][k] = pt[cur][j];
+    }
+
+    std::size_t fresh = (std::size_t)(inject * m);
+    std::uint32_t base = rng;
+    rng = mix(rng + 1);
+    for (std::size_t k = m - fresh; k < m; k++) {
+        std::uint32_t h = base + 3 * (std::uint32_t)k;
+        px[next][k] = est_x + MCL_RECOVER_SD * tri(mix(h));
+        py[next][k] = est_y + MCL_RECOVER_SD * tri(mix(h + 1));
+        pt[next][k] = est_t + MCL_RECOVER_THETA_SD * tri(mix(h + 2));
+    }
+
+    cur = next;
+    n = m;
+    for (std::size_t i = 0; i < n; i++) {
+        w[i] = 1.0f / n;
+    }
+    st.resamples++;
+    st.injected += fresh;
+}
+
+void ParticleLocalizer::run() {
+    Pose prev = odom.get_pose();
+    std::uint32_t seen = prev.time_ms;
+    std::uint32_t resync_seq = 0;
+    bool resync = false;
+    float moved = 0;
+    float turned = 0;
+    float speed = 0;
+    std::uint32_t last_score = millis();
+    std::uint32_t wake = millis();
+
+    while (running) {
+        std::uint64_t start = micros();
+
+        if (reset_pending.exchange(false)) {
+            Pose r = reset_to.read();
+            seed(r.x, r.y, 0.5f, 0.01f);
+            // The odometry is reset along with us, don't difference across
+            // it. Its poses can lag the reset, so wait for one numbered with it.
+            resync = true;
+            resync_seq = r.reset_seq;
+            moved = 0;
+            turned = 0;
+        }
+
+        Pose cur_pose = odom.get_pose();
+        if (resync && (std::int32_t)(cur_pose.reset_seq - resync_seq) >= 0) {
+            resync = false;
+            prev = cur_pose;
+            seen = cur_pose.time_ms;
+        }
+
+        if (!resync && cur_pose.time_ms != seen) {
+            seen = cur_pose.time_ms;
+
+            float dtheta = cur_pose.theta - prev.theta;
+            float mid = prev.theta + dtheta / 2;
+            float ds = (cur_pose.x - prev.x) * std::sin(mid) + (cur_pose.y - prev.y) * std::cos(mid);
+            motion(ds, dtheta, mid);
+
+            float dt = (cur_pose.time_ms - prev.time_ms) / 1000.0f;
+            speed = dt > 0 ? std::fabs(ds) / dt : 0;
+
+            moved += std::fabs(ds);
+            turned += std::fabs(dtheta);
+            prev = cur_pose;
+        }
+
+        bool due = moved >= MCL_UPDATE_DIST || turned >= MCL_UPDATE_TURN ||
+                   millis() - last_score >= MCL_UPDATE_MS;
+        if (!resync && due) {
+            Reading r[MCL_MAX_SENSORS];
+            int k = read_sensors(r, speed);
+            if (k) {
+                float neff = score(r, k, prev.theta);
+                estimate(prev);
+
+                if (fit_slow == 0) {
+                    fit_slow = fit;
+                    fit_fast = fit;
+                }
+                fit_slow += MCL_ALPHA_SLOW * (fit - fit_slow);
+                fit_fast += MCL_ALPHA_FAST * (fit - fit_fast);
+                float inject = 1 - fit_fast / fit_slow;
+                inject = inject > MCL_MAX_INJECT ? MCL_MAX_INJECT : inject;
+
+                if (inject < MCL_MIN_INJECT) {
+                    inject = 0;
+                }
+                if (neff < n / 2.0f || inject > 0) {
+                    resample(inject);
+                }
+                st.updates++;
+            }
+            st.readings = k;
+            st.particles = n;
+            moved = 0;
+            turned = 0;
+            last_score = millis();
+        }
+
+        st.last_us = micros() - start;
+        if (st.last_us > st.max_us) {
+            st.max_us = st.last_us;
+        }
+
+        c::task_delay_until(&wake, MCL_PERIOD_MS);
+    }
+
+    alive = false;
+}
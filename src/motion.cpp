@@ -0,0 +1,120 @@
+#include "motion.h"
+
+using namespace pros;
+
+bool MotionEstimator::add(MotionGroup g, std::int8_t port) {
+    if (running || n >= MOTION_MAX_MOTORS) {
+        return false;
+    }
+    channels[n].port = port;
+    channels[n].group = g;
+    n++;
+    return true;
+}
+
+void MotionEstimator::add(MotionGroup g, const MotorGroup& mg) {
+    for (int i = 0; i < (int)mg.size(); i++) {
+        add(g, mg.get_port(i));
+    }
+}
+
+void MotionEstimator::start() {
+    if (running) {
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        channels[i].epoch = RESEED;
+        channels[i].fit.reset();
+    }
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, MOTION_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "motion");
+}
+
+void MotionEstimator::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+void MotionEstimator::task_fn(void* param) {
+    static_cast<MotionEstimator*>(param)->run();
+}
+
+void MotionEstimator::run() {
+    std::uint32_t wake = millis();
+
+    while (running) {
+        for (int i = 0; i < n; i++) {
+            Channel& ch = channels[i];
+
+            // A motor that went away may come back with its count restarted,
+            // its old samples would read as a jump
+            std::int32_t counts = PROS_ERR;
+            std::uint32_t ts = 0;
+            if (!devices || devices->ok(ch.port)) {
+                counts = c::motor_get_raw_position(ch.port, &ts);
+            }
+            std::uint32_t e = devices ? devices->epoch(ch.port) : 0;
+            if (counts == PROS_ERR || ch.epoch != e) {
+                ch.epoch = counts == PROS_ERR ? RESEED : e;
+                ch.fit.reset();
+                ch.out.write({0, 0, 0});
+                if (counts == PROS_ERR) {
+                    continue;
+                }
+            }
+
+            // Motors report every few ms, a read in between repeats the last
+            if (ch.fit.add(ts, counts)) {
+                ch.out.write(ch.fit.fit());
+            }
+        }
+
+        c::task_delay_until(&wake, MOTION_PERIOD_MS);
+    }
+
+    alive = false;
+}
+
+MotionState MotionEstimator::now(const Channel& ch, std::uint32_t t) const {
+    MotionState s = ch.out.read();
+    if (s.time_ms == 0) {
+        return s;
+    }
+    return {s.vel_at(t, MOTION_MAX_LEAD_MS), s.acc, t};
+}
+
+MotionState MotionEstimator::motor(std::int8_t port) const {
+    for (int i = 0; i < n; i++) {
+        if (channels[i].port == port) {
+            return now(channels[i], millis());
+        }
+    }
+    return {0, 0, 0};
+}
+
+MotionState MotionEstimator::group(MotionGroup g) const {
+    std::uint32_t t = millis();
+    float vel = 0;
+    float acc = 0;
+    int used = 0;
+    for (int i = 0; i < n; i++) {
+        if (channels[i].group != g) {
+            continue;
+        }
+        MotionState s = now(channels[i], t);
+        if (s.time_ms) {
+            vel += s.vel;
+            acc += s.acc;
+            used++;
+        }
+    }
+    if (!used) {
+        return {0, 0, 0};
+    }
+    return {vel / used, acc / used, t};
+}
@@ -0,0 +1,75 @@
+#include "motor_telemetry.h"
+#include <cstdio>
+
+using namespace pros;
+
+int telemetry_ports(const MotorGroup& mg, std::int8_t* ports) {
+    int n = mg.size();
+    if (n > TELEM_MAX_MOTORS) {
+        n = TELEM_MAX_MOTORS;
+    }
+
+    for (int i = 0; i < n; i++) {
+        ports[i] = mg.get_port(i);
+    }
+    return n;
+}
+
+void read_telemetry(const std::int8_t* ports, int count, MotorTelemetry& out) {
+    if (count > TELEM_MAX_MOTORS) {
+        count = TELEM_MAX_MOTORS;
+    }
+
+    out.count = count;
+    out.time_ms = millis();
+
+    // The C API takes the signed port, so reversed motors come back negated
+    // exactly like the MotorGroup getters
+    for (int i = 0; i < count; i++) {
+        std::int8_t p = ports[i];
+        out.port[i] = p;
+        out.position[i] = c::motor_get_position(p);
+        out.velocity[i] = c::motor_get_actual_velocity(p);
+        out.current[i] = c::motor_get_current_draw(p);
+        out.voltage[i] = c::motor_get_voltage(p);
+        out.temperature[i] = c::motor_get_temperature(p);
+        out.flags[i] = c::motor_get_flags(p);
+    }
+}
+
+void read_telemetry(const MotorGroup& mg, MotorTelemetry& out) {
+    std::int8_t ports[TELEM_MAX_MOTORS];
+    int n = telemetry_ports(mg, ports);
+    read_telemetry(ports, n, out);
+}
+
+void bench_telemetry(const MotorGroup& mg, int iterations) {
+    std::int8_t ports[TELEM_MAX_MOTORS];
+    int n = telemetry_ports(mg, ports);
+    MotorTelemetry t;
+
+    // Keeps the vector results alive so the reads cannot be optimized out
+    volatile double sink = 0;
+
+    std::uint64_t start = micros();
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + mg.get_position_all()[0];
+        sink = sink + mg.get_actual_velocity_all()[0];
+        sink = sink + mg.get_current_draw_all()[0];
+        sink = sink + mg.get_voltage_all()[0];
+        sink = sink + mg.get_temperature_all()[0];
+        sink = sink + mg.get_flags_all()[0];
+    }
+    std::uint64_t vec_us = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < iterations; i++) {
+        read_telemetry(ports, n, t);
+        sink = sink + t.position[0];
+    }
+    std::uint64_t batch_us = micros() - start;
+
+    printf("telemetry bench: %d motors, %d iterations\n", n, iterations);
+    printf("  *_all() getters: %.1f us/read (6 vectors allocated)\n", (double)vec_us / iterations);
+    printf("  read_telemetry:  %.1f us/read (no allocation)\n", (double)batch_us / iterations);
+}
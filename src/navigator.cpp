@@ -0,0 +1,161 @@
+#include "navigator.h"
+
+using namespace pros;
+
+Navigator::Navigator(drivetrain& chassis, Localizer& loc) : chassis(chassis), loc(loc) {}
+
+void Navigator::init() {
+    field.load(FIELD_OCCUPANCY);
+    grid = field;
+}
+
+void Navigator::block(int id, float x, float y, float radius) {
+    if (id < 0 || id >= NAV_MAX_OBSTACLES) {
+        return;
+    }
+    staged.x[id] = x;
+    staged.y[id] = y;
+    staged.r[id] = radius;
+    publish();
+}
+
+void Navigator::unblock(int id) {
+    if (id < 0 || id >= NAV_MAX_OBSTACLES) {
+        return;
+    }
+    staged.r[id] = 0;
+    publish();
+}
+
+void Navigator::publish() {
+    obstacles.write(staged);
+    version.fetch_add(1, std::memory_order_release);
+}
+
+// A disc grown by the robot is just a bigger disc, so obstacles go straight
+// into a copy of the inflated field. They get more room than the field's
+// fixed geometry, they move and are only roughly where they were seen.
+void Navigator::build_grid() {
+    Obstacles obs = obstacles.read();
+    grid = field;
+    for (int i = 0; i < NAV_MAX_OBSTACLES; i++) {
+        if (obs.r[i] > 0) {
+            grid.fill_disc(obs.x[i], obs.y[i], obs.r[i] + PLAN_ROBOT_RADIUS + PLAN_MARGIN + NAV_CLEARANCE);
+        }
+    }
+}
+
+// Sets turn to how far the robot should turn in place before following, 0
+// if it can carry on from how it is moving
+bool Navigator::plan(const Pose& from, float x, float y, float heading, float& turn) {
+    std::uint64_t start = micros();
+
+    build_grid();
+    int n = planner.plan(grid, from.x, from.y, x, y, heading, wps, PLAN_MAX_WAYPOINTS);
+    PathLimits lim = {DRIVE_MAX_VEL, DRIVE_MAX_ACCEL, PLAN_TURN_K};
+    turn = 0;
+    if (n >= 2) {
+        float facing = from.theta * (float)(180 / M_PI);
+        turn = std::remainder(wps[0].heading - facing, 360.0f);
+        if (std::fabs(turn) <= NAV_TURN_FIRST) {
+            turn = 0;
+            wps[0].heading = facing;
+            lim.start_vel = std::fabs(from.v);
+        }
+    }
+    bool ok = n >= 2 && path.generate(wps, n, lim);
+
+    st.plans++;
+    if (!ok) {
+        st.failures++;
+    }
+    st.last_us = micros() - start;
+    if (st.last_us > st.max_us) {
+        st.max_us = st.last_us;
+    }
+    return ok;
+}
+
+// Whether an obstacle now lies on the path past its closest point to the
+// robot. A robot already inside an obstacle's margin counts too, the planner
+// backs it out to the nearest free cell. The field itself doesn't, goals by
+// a wall sit on the edge of its margin and the splines graze it.
+bool Navigator::blocked_ahead(const Pose& p) {
+    build_grid();
+
+    int from = 0;
+    float best = INFINITY;
+    for (int i = 0; i < path.size; i++) {
+        float dx = path.x[i] - p.x;
+        float dy = path.y[i] - p.y;
+        if (dx * dx + dy * dy < best) {
+            best = dx * dx + dy * dy;
+            from = i;
+        }
+    }
+
+    for (int i = from; i < path.size; i++) {
+        int cx = OccupancyGrid::cell(path.x[i]);
+        int cy = OccupancyGrid::cell(path.y[i]);
+        if (grid.occupied(cx, cy) && !field.occupied(cx, cy)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Command Navigator::go_to(float x, float y, float heading) {
+    return drive(nullptr, x, y, heading);
+}
+
+Command Navigator::go_to(const BakedLeg& leg) {
+    return drive(&leg, leg.goal_x, leg.goal_y, leg.goal_heading);
+}
+
+// Puts the baked path in place if the robot is at the leg's start and it is
+// clear of obstacles
+bool Navigator::load_baked(const BakedLeg& leg, const Pose& p) {
+    float off = std::remainder(p.theta * (float)(180 / M_PI) - leg.start_heading, 360.0f);
+    if (std::hypot(p.x - leg.start_x, p.y - leg.start_y) > NAV_BAKED_SLACK || std::fabs(off) > NAV_BAKED_SLACK_DEG) {
+        return false;
+    }
+    path.load(leg.samples, leg.size);
+    return !blocked_ahead(p);
+}
+
+Command Navigator::drive(const BakedLeg* leg, float x, float y, float heading) {
+    for (int i = 0; i <= NAV_MAX_REPLANS; i++) {
+        std::uint32_t seen = version.load(std::memory_order_acquire);
+        if (i == 0 && leg && load_baked(*leg, loc.get_pose())) {
+            st.baked++;
+        } else {
+            float turn;
+            if (!plan(loc.get_pose(), x, y, heading, turn)) {
+                co_return;
+            }
+            if (turn != 0) {
+                co_await chassis.turn(turn);
+                if (!plan(loc.get_pose(), x, y, heading, turn)) {
+                    co_return;
+                }
+            }
+        }
+
+        // Obstacles are only looked at again when one has changed
+        bool blocked = false;
+        co_await race(chassis.follow(path), wait_until([&] {
+            std::uint32_t v = version.load(std::memory_order_acquire);
+            if (v == seen) {
+                return false;
+            }
+            seen = v;
+            blocked = blocked_ahead(loc.get_pose());
+            return blocked;
+        }));
+
+        if (!blocked) {
+            co_return;
+        }
+        st.replans++;
+    }
+}
@@ -0,0 +1,182 @@
+#include "odom.h"
+#include <cmath>
+
+using namespace pros;
+
+Odometry::Odometry(MotorGroup& left, MotorGroup& right, Imu& imu)
+    : left(left), right(right), imu(imu) {}
+
+void Odometry::start() {
+    if (running) {
+        return;
+    }
+
+    nL = telemetry_ports(left, portsL);
+    nR = telemetry_ports(right, portsR);
+    for (int i = 0; i < TELEM_MAX_MOTORS; i++) {
+        epochL[i] = RESEED;
+        epochR[i] = RESEED;
+    }
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, ODOM_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "odometry");
+}
+
+void Odometry::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+std::uint32_t Odometry::set_pose(float x, float y, float theta) {
+    Pose p = {};
+    p.x = x;
+    p.y = y;
+    p.theta = theta;
+    p.time_ms = millis();
+    p.reset_seq = ++resets;
+
+    if (!alive) {
+        pose.write(p);
+        return p.reset_seq;
+    }
+    reset_to.write(p);
+    reset_pending = true;
+    return p.reset_seq;
+}
+
+void Odometry::task_fn(void* param) {
+    static_cast<Odometry*>(param)->run();
+}
+
+// Raw counts of every drive motor, PROS_ERR for any that isn't there, with
+// the device-side timestamp of the first one read. ts is left alone if no
+// motor could be read.
+void Odometry::read_raw(std::int32_t* now_l, std::int32_t* now_r, std::uint32_t& ts) {
+    bool stamped = false;
+    std::uint32_t t = 0;
+
+    auto read = [&](const std::int8_t* ports, std::int32_t* now, int n) {
+        for (int i = 0; i < n; i++) {
+            if (devices && !devices->ok(ports[i])) {
+                now[i] = PROS_ERR;
+                continue;
+            }
+            now[i] = c::motor_get_raw_position(ports[i], &t);
+            if (now[i] != PROS_ERR && !stamped) {
+                ts = t;
+                stamped = true;
+            }
+        }
+    };
+    read(portsL, now_l, nL);
+    read(portsR, now_r, nR);
+}
+
+// Average inches a side's motors moved since the last step, over the ones
+// that were read both times. used is how many that was.
+float Odometry::side_delta(const std::int8_t* ports, const std::int32_t* now, std::int32_t* last,
+                           std::uint32_t* epoch, int n, int& used) {
+    std::int32_t sum = 0;
+    used = 0;
+    for (int i = 0; i < n; i++) {
+        // Gone, even for a moment, means its count may restart from 0
+        if (now[i] == PROS_ERR) {
+            epoch[i] = RESEED;
+            continue;
+        }
+
+        std::uint32_t e = devices ? devices->epoch(ports[i]) : 0;
+        if (epoch[i] != e) {
+            epoch[i] = e;
+            last[i] = now[i];
+            continue;
+        }
+
+        sum += now[i] - last[i];
+        last[i] = now[i];
+        used++;
+    }
+    return used ? sum * (float)INCHES_PER_TICK / used : 0;
+}
+
+// Heading change since the last step. Uses the IMU while it reports, and the
+// wheel difference if it drops out so the pose keeps going through a bad cable
+float Odometry::heading_change(float dl, float dr) {
+    double rot = imu.get_rotation();
+
+    if (!std::isfinite(rot)) {
+        imu_ok = false;
+        return (dl - dr) / (float)TRACK_WIDTH;
+    }
+
+    float now = rot * (float)(M_PI / 180.0);
+    float d = imu_ok ? now - last_imu : (dl - dr) / (float)TRACK_WIDTH;
+    last_imu = now;
+    imu_ok = true;
+    return d;
+}
+
+void Odometry::run() {
+    std::int32_t nowL[TELEM_MAX_MOTORS];
+    std::int32_t nowR[TELEM_MAX_MOTORS];
+    std::uint32_t prevTs = 0;
+    int usedL, usedR;
+    read_raw(nowL, nowR, prevTs);
+    side_delta(portsL, nowL, lastL, epochL, nL, usedL);
+    side_delta(portsR, nowR, lastR, epochR, nR, usedR);
+    heading_change(0, 0);
+
+    Pose p = pose.read();
+    std::uint32_t wake = millis();
+
+    while (running) {
+        if (reset_pending.exchange(false)) {
+            p = reset_to.read();
+        }
+
+        std::uint32_t ts = prevTs;
+        read_raw(nowL, nowR, ts);
+
+        // Motors update every few ms, nothing to integrate until they do
+        if (ts == prevTs) {
+            c::task_delay_until(&wake, ODOM_PERIOD_MS);
+            continue;
+        }
+
+        float dl = side_delta(portsL, nowL, lastL, epochL, nL, usedL);
+        float dr = side_delta(portsR, nowR, lastR, epochR, nR, usedR);
+        float dt = (ts - prevTs) / 1000.0f;
+        prevTs = ts;
+
+        // A side with no motor left to read is taken to match the other
+        if (!usedL) dl = dr;
+        if (!usedR) dr = dl;
+
+        float dtheta = heading_change(dl, dr);
+        float d = (dl + dr) / 2;
+
+        // Travel along the chord of the arc, at the mid-step heading
+        float chord = d;
+        if (std::fabs(dtheta) > 1e-6f) {
+            chord = d * std::sin(dtheta / 2) / (dtheta / 2);
+        }
+        float mid = p.theta + dtheta / 2;
+
+        p.x += chord * std::sin(mid);
+        p.y += chord * std::cos(mid);
+        p.theta += dtheta;
+        p.v = d / dt;
+        p.omega = dtheta / dt;
+        p.time_ms = millis();
+
+        pose.write(p);
+        step_out.write({dl, dr, dtheta, dt});
+
+        c::task_delay_until(&wake, ODOM_PERIOD_MS);
+    }
+
+    alive = false;
+}
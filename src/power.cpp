@@ -0,0 +1,248 @@
+#include "power.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace pros;
+
+PowerBudget::PowerBudget(Intake& rollers) : rollers(rollers) {}
+
+bool PowerBudget::add(PowerGroup g, std::int8_t port) {
+    if (running || n >= POWER_MAX_MOTORS) {
+        return false;
+    }
+    motors[n].port = port;
+    motors[n].group = g;
+    n++;
+    return true;
+}
+
+void PowerBudget::add(PowerGroup g, const MotorGroup& mg) {
+    for (int i = 0; i < (int)mg.size(); i++) {
+        add(g, mg.get_port(i));
+    }
+}
+
+void PowerBudget::start() {
+    if (running) {
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        Budgeted& m = motors[i];
+        motor_gearset_e_t g = c::motor_get_gearing(m.port);
+        m.free_rpm = g == E_MOTOR_GEAR_RED ? 100 : g == E_MOTOR_GEAR_BLUE ? 600 : 200;
+        m.old_current_limit = c::motor_get_current_limit(m.port);
+        m.old_voltage_limit = c::motor_get_voltage_limit(m.port);
+        m.limit = m.old_current_limit;
+        m.voltage = m.old_voltage_limit;
+        m.voltage_set = m.old_voltage_limit;
+        m.filt_ma = 0;
+        // Unplugged at boot reads PROS_ERR_F, assumed until it reports
+        double t = c::motor_get_temperature(m.port);
+        m.ambient_read = std::isfinite(t);
+        m.ambient = m.ambient_read ? (float)t : POWER_AMBIENT_C;
+        m.temp_est = m.ambient;
+    }
+    mode = POWER_BALANCED;
+    mode_since = millis();
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, POWER_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "power");
+}
+
+void PowerBudget::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+
+    for (int i = 0; i < n; i++) {
+        c::motor_set_current_limit(motors[i].port, motors[i].old_current_limit);
+        c::motor_set_voltage_limit(motors[i].port, motors[i].old_voltage_limit);
+    }
+}
+
+PowerStats PowerBudget::stats() const {
+    float hottest = 0;
+    for (int i = 0; i < n; i++) {
+        hottest = std::max(hottest, motors[i].temp_est.load());
+    }
+    return {seen_mode, draw_ma, peak_ma, short_samples, hottest};
+}
+
+void PowerBudget::task_fn(void* param) {
+    static_cast<PowerBudget*>(param)->run();
+}
+
+void PowerBudget::run() {
+    std::uint32_t wake = millis();
+
+    while (running) {
+        std::int32_t total = 0;
+        for (int i = 0; i < n; i++) {
+            sample(motors[i], POWER_PERIOD_MS / 1000.0f);
+            total += (std::int32_t)motors[i].filt_ma;
+        }
+        draw_ma = total;
+        if (total > peak_ma) {
+            peak_ma = total;
+        }
+
+        mode = pick_mode(millis());
+        seen_mode = mode;
+        allocate();
+        for (int i = 0; i < n; i++) {
+            write(motors[i]);
+        }
+
+        c::task_delay_until(&wake, POWER_PERIOD_MS);
+    }
+
+    alive = false;
+}
+
+void PowerBudget::sample(Budgeted& m, float dt) {
+    std::int32_t ma = c::motor_get_current_draw(m.port);
+    double rpm = c::motor_get_actual_velocity(m.port);
+    double reported = c::motor_get_temperature(m.port);
+
+    // An unplugged motor draws nothing and isn't heating
+    if (ma == PROS_ERR || !std::isfinite(reported)) {
+        ma = 0;
+        rpm = 0;
+        reported = m.temp_est;
+    } else if (!m.ambient_read) {
+        m.ambient = (float)reported;
+        m.temp_est = m.ambient;
+        m.ambient_read = true;
+    }
+
+    float prev = m.filt_ma;
+    m.filt_ma += POWER_FILTER * (std::abs(ma) - m.filt_ma);
+    m.rpm = std::fabs(rpm);
+
+    // Only a rising draw is run ahead, a falling one is met next sample
+    float rise = std::max(0.0f, m.filt_ma - prev);
+    float predicted = m.filt_ma + rise * POWER_HORIZON_MS / POWER_PERIOD_MS;
+
+    // I^2 R heating against loss to the air, held inside the reported step
+    float amps = m.filt_ma / 1000;
+    float t = m.temp_est;
+    t += (amps * amps * POWER_WINDING_OHM - (t - m.ambient) / POWER_HEAT_RES) / POWER_HEAT_CAP * dt;
+    t = std::clamp(t, (float)reported, (float)reported + POWER_TEMP_STEP);
+    m.temp_est = t;
+
+    float frac = 1;
+    if (t >= POWER_HARD_C) {
+        frac = POWER_HOT_PCT / 100.0f;
+    } else if (t > POWER_SOFT_C) {
+        frac = 1 - (1 - POWER_HOT_PCT / 100.0f) * (t - POWER_SOFT_C) / (POWER_HARD_C - POWER_SOFT_C);
+    }
+
+    m.cap = POWER_MOTOR_MAX_MA * frac;
+    m.demand = std::clamp(predicted + POWER_HEADROOM_MA, std::min((float)POWER_MIN_MA, m.cap), m.cap);
+
+    // A hot motor also slows down, what heats a free spinning one is speed
+    m.voltage = frac < 1 ? (std::int32_t)(12000 * std::max(frac, 0.5f)) : m.old_voltage_limit;
+}
+
+PowerMode PowerBudget::pick_mode(std::uint32_t now) {
+    float drive_ma = 0;
+    float drive_speed = 0;
+    int drive_n = 0;
+    for (int i = 0; i < n; i++) {
+        if (motors[i].group == POWER_DRIVE) {
+            drive_ma += motors[i].filt_ma;
+            drive_speed += motors[i].rpm / motors[i].free_rpm;
+            drive_n++;
+        }
+    }
+
+    bool cycling = false;
+    for (int s = 0; s < INTAKE_STAGES; s++) {
+        IntakeState st = rollers.state((IntakeStage)s);
+        if (st != ROLLER_IDLE && st != ROLLER_REST) {
+            cycling = true;
+        }
+    }
+
+    PowerMode want = POWER_BALANCED;
+    if (drive_n && drive_ma / drive_n >= PUSH_CURRENT_MA && drive_speed / drive_n * 100 < PUSH_SPEED_PCT) {
+        want = POWER_PUSHING;
+    } else if (cycling) {
+        want = POWER_CYCLING;
+    }
+
+    if (want == mode || now - mode_since < POWER_MODE_HOLD_MS) {
+        return mode;
+    }
+    mode_since = now;
+    return want;
+}
+
+// Raises the motors in the tier toward their demand with what is left of the
+// budget, all by the same fraction if there isn't enough
+float PowerBudget::fill(int tier_mask, float left) {
+    float want = 0;
+    for (int i = 0; i < n; i++) {
+        if (tier_mask & (1 << motors[i].group)) {
+            want += std::max(0.0f, motors[i].demand - motors[i].alloc);
+        }
+    }
+    if (want <= 0) {
+        return left;
+    }
+
+    float share = std::min(1.0f, left / want);
+    for (int i = 0; i < n; i++) {
+        if (tier_mask & (1 << motors[i].group)) {
+            motors[i].alloc += std::max(0.0f, motors[i].demand - motors[i].alloc) * share;
+        }
+    }
+    return left - want * share;
+}
+
+void PowerBudget::allocate() {
+    float left = POWER_BUDGET_MA;
+    float demand = 0;
+    for (int i = 0; i < n; i++) {
+        motors[i].alloc = std::min((float)POWER_MIN_MA, motors[i].cap);
+        left -= motors[i].alloc;
+        demand += motors[i].demand;
+    }
+    if (demand > POWER_BUDGET_MA) {
+        short_samples++;
+    }
+
+    const int drive = 1 << POWER_DRIVE;
+    const int intake = 1 << POWER_INTAKE;
+    if (mode == POWER_PUSHING) {
+        left = fill(intake, fill(drive, left));
+    } else if (mode == POWER_CYCLING) {
+        left = fill(drive, fill(intake, left));
+    } else {
+        left = fill(drive | intake, left);
+    }
+
+    // Whatever is spare is spread evenly, room for a sudden rise
+    if (left > 0 && n) {
+        for (int i = 0; i < n; i++) {
+            motors[i].alloc = std::min(motors[i].cap, motors[i].alloc + left / n);
+        }
+    }
+}
+
+void PowerBudget::write(Budgeted& m) {
+    // Rounded down to whole steps, so the limits written never add up to
+    // more than the budget
+    std::int32_t want = (std::int32_t)m.alloc / POWER_WRITE_STEP_MA * POWER_WRITE_STEP_MA;
+    if (want != m.limit) {
+        c::motor_set_current_limit(m.port, want);
+        m.limit = want;
+    }
+    if (m.voltage != m.voltage_set) {
+        c::motor_set_voltage_limit(m.port, m.voltage);
+        m.voltage_set = m.voltage;
+    }
+}
@@ -0,0 +1,215 @@
+#include "globals.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace pros;
+
+// Flag byte: bit i set if axis i changed, this bit if the buttons did
+#define FLAG_BUTTONS (1u << NUM_AXES)
+
+#define RECORD_VERSION 1
+#define PERIOD_US (RECORD_PERIOD_MS * 1000)
+
+// Signed values as unsigned LEB128, small magnitudes of either sign in 1 byte
+static std::uint8_t* put_varint(std::uint8_t* p, std::int64_t v) {
+    std::uint64_t z = ((std::uint64_t)v << 1) ^ (std::uint64_t)(v >> 63);
+    while (z >= 0x80) {
+        *p++ = (std::uint8_t)(z | 0x80);
+        z >>= 7;
+    }
+    *p++ = (std::uint8_t)z;
+    return p;
+}
+
+static const std::uint8_t* get_varint(const std::uint8_t* p, const std::uint8_t* end, std::int64_t& v) {
+    std::uint64_t z = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        std::uint8_t b = *p++;
+        z |= (std::uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            v = (std::int64_t)(z >> 1) ^ -(std::int64_t)(z & 1);
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+void InputRecorder::start() {
+    len = 0;
+    n = 0;
+    last = {};
+    start_us = micros();
+    prev_us = start_us;
+    playing = false;
+    rec = true;
+}
+
+void InputRecorder::stop() {
+    rec = false;
+}
+
+void InputRecorder::append(const ControllerSnapshot& s) {
+    if (!rec) {
+        return;
+    }
+    if (len + RECORD_TICK_MAX > RECORD_BUFFER_SIZE) {
+        rec = false;
+        return;
+    }
+
+    std::uint64_t now = micros();
+    std::uint8_t* p = buf + len;
+    std::uint8_t* flags = p++;
+    *flags = 0;
+
+    // Time as the deviation from one period after the last tick
+    p = put_varint(p, (std::int64_t)(now - prev_us) - PERIOD_US);
+    prev_us = now;
+
+    for (int i = 0; i < NUM_AXES; i++) {
+        if (s.axis[i] != last.axis[i]) {
+            *flags |= 1u << i;
+            *p++ = (std::uint8_t)s.axis[i];
+            last.axis[i] = s.axis[i];
+        }
+    }
+    if (s.held != last.buttons) {
+        *flags |= FLAG_BUTTONS;
+        *p++ = (std::uint8_t)s.held;
+        *p++ = (std::uint8_t)(s.held >> 8);
+        last.buttons = s.held;
+    }
+
+    len = p - buf;
+    n++;
+}
+
+bool InputRecorder::save(const char* path) const {
+    if (!usd::is_installed()) {
+        return false;
+    }
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+
+    RecordHeader h = {{'V', 'X', 'I', 'R'}, RECORD_VERSION, RECORD_PERIOD_MS, n, len};
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(buf, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+bool InputRecorder::load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+
+    RecordHeader h;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && std::memcmp(h.magic, "VXIR", 4) == 0 &&
+              h.version == RECORD_VERSION && h.period_ms == RECORD_PERIOD_MS &&
+              h.bytes <= RECORD_BUFFER_SIZE && fread(buf, 1, h.bytes, f) == h.bytes;
+    fclose(f);
+
+    rec = false;
+    playing = false;
+    len = ok ? h.bytes : 0;
+    n = ok ? h.ticks : 0;
+    return ok;
+}
+
+// Reads the tick at pos into t, carrying unchanged values over from the
+// tick before. False at the end of the stream or on a truncated tick.
+bool InputRecorder::decode(Tick& t) {
+    const std::uint8_t* p = buf + pos;
+    const std::uint8_t* end = buf + len;
+    if (p >= end) {
+        return false;
+    }
+
+    std::uint8_t flags = *p++;
+    std::int64_t dt;
+    p = get_varint(p, end, dt);
+    if (!p) {
+        return false;
+    }
+    t.time_us += PERIOD_US + dt;
+
+    for (int i = 0; i < NUM_AXES; i++) {
+        if (flags & (1u << i)) {
+            if (p >= end) return false;
+            t.axis[i] = (std::int8_t)*p++;
+        }
+    }
+    if (flags & FLAG_BUTTONS) {
+        if (p + 2 > end) return false;
+        t.buttons = p[0] | (p[1] << 8);
+        p += 2;
+    }
+
+    pos = p - buf;
+    return true;
+}
+
+void InputRecorder::begin_replay() {
+    pos = 0;
+    next = {};
+    have_next = decode(next);
+    play_start_us = micros();
+    playing = true;
+}
+
+bool InputRecorder::replay(ControllerSnapshot& s) {
+    if (!playing) {
+        return false;
+    }
+    if (!have_next) {
+        // Past the end, let go of everything
+        const std::int8_t idle[NUM_AXES] = {};
+        s.apply(idle, 0, millis());
+        return false;
+    }
+
+    // A tick is due once we are within half a period of its recorded time,
+    // so each lands on the nearest scheduler tick despite jitter either way
+    std::uint64_t now = micros() - play_start_us + PERIOD_US / 2;
+    std::uint16_t pressed = 0;
+    std::uint16_t released = 0;
+    bool applied = false;
+
+    while (have_next && next.time_us <= now) {
+        s.apply(next.axis, next.buttons, millis());
+        pressed |= s.pressed;
+        released |= s.released;
+        applied = true;
+        have_next = decode(next);
+    }
+
+    if (applied) {
+        s.pressed = pressed;
+        s.released = released;
+    } else {
+        s.apply(s.axis, s.held, millis());
+    }
+
+    return have_next;
+}
+
+void replay_recording() {
+    recorder.begin_replay();
+    sched.reset_stats();
+    reset_drive();
+    sched.start();
+
+    while (!recorder.finished()) {
+        delay(RECORD_PERIOD_MS);
+    }
+
+    // One more tick so the loops see everything released
+    delay(2 * RECORD_PERIOD_MS);
+    sched.stop();
+    recorder.end_replay();
+
+    mgL.move_voltage(0);
+    mgR.move_voltage(0);
+    rollers.off();
+}
@@ -0,0 +1,158 @@
+#include "scheduler.h"
+#include "telemetry.h"
+#include <numeric>
+
+using namespace pros;
+
+bool Scheduler::add(const char* name, loop_fn_t fn, std::uint32_t period_ms) {
+    if (running || n >= SCHED_MAX_LOOPS || period_ms == 0 || fn == nullptr) {
+        return false;
+    }
+
+    loops[n] = {};
+    loops[n].name = name;
+    loops[n].fn = fn;
+    loops[n].period_ms = period_ms;
+    n++;
+    return true;
+}
+
+void Scheduler::start(std::uint32_t prio) {
+    if (running || n == 0) {
+        return;
+    }
+
+    // Base tick is the largest step that still lands on every loop's period
+    tick = loops[0].period_ms;
+    for (int i = 1; i < n; i++) {
+        tick = std::gcd(tick, loops[i].period_ms);
+    }
+
+    running = true;
+    alive = true;
+    c::task_create(task_fn, this, prio, TASK_STACK_DEPTH_DEFAULT, "scheduler");
+}
+
+void Scheduler::stop() {
+    running = false;
+
+    // Wait for the executor to leave its current tick so a following start()
+    // never ends up with two executors driving the same motors
+    while (alive) {
+        delay(1);
+    }
+}
+
+bool Scheduler::is_running() const {
+    return running;
+}
+
+void Scheduler::reset_stats() {
+    for (int i = 0; i < n; i++) {
+        loops[i].stats = {};
+        loops[i].last_start_us = 0;
+    }
+}
+
+int Scheduler::count() const {
+    return n;
+}
+
+const char* Scheduler::name(int i) const {
+    return loops[i].name;
+}
+
+LoopStats Scheduler::stats(int i) const {
+    return loops[i].stats;
+}
+
+std::uint32_t Scheduler::tick_ms() const {
+    return tick;
+}
+
+void Scheduler::set_log(TelemetryLog* l) {
+    if (!running) {
+        log = l;
+    }
+}
+
+void Scheduler::task_fn(void* param) {
+    static_cast<Scheduler*>(param)->run();
+}
+
+void Scheduler::run() {
+    std::uint32_t wake = millis();
+
+    for (int i = 0; i < n; i++) {
+        loops[i].next_ms = wake;
+        loops[i].last_start_us = 0;
+        if (log) {
+            log->name(i, loops[i].name);
+        }
+    }
+
+    while (running) {
+        std::uint32_t now = millis();
+
+        for (int i = 0; i < n; i++) {
+            Loop& l = loops[i];
+
+            // Signed difference so millis() wrap-around is handled
+            if ((std::int32_t)(now - l.next_ms) < 0) {
+                continue;
+            }
+
+            std::uint64_t start = micros();
+            l.fn();
+            std::uint64_t end = micros();
+
+            LoopStats& s = l.stats;
+            s.runs++;
+            s.last_exec_us = end - start;
+            if (s.last_exec_us > s.max_exec_us) {
+                s.max_exec_us = s.last_exec_us;
+            }
+
+            std::uint32_t period = 0;
+            if (l.last_start_us != 0) {
+                period = start - l.last_start_us;
+                s.last_period_us = period;
+                if (s.min_period_us == 0 || period < s.min_period_us) {
+                    s.min_period_us = period;
+                }
+                if (period > s.max_period_us) {
+                    s.max_period_us = period;
+                }
+                if (s.avg_period_us == 0) {
+                    s.avg_period_us = period;
+                } else {
+                    s.avg_period_us += ((std::int32_t)(period - s.avg_period_us)) / 8;
+                }
+            }
+            l.last_start_us = start;
+
+            // If the next deadline has already passed, the slot is lost.
+            // Count it and re-align instead of bursting to catch up.
+            l.next_ms += l.period_ms;
+            std::uint32_t after = millis();
+            if ((std::int32_t)(after - l.next_ms) > 0) {
+                s.overruns++;
+                l.next_ms = after + l.period_ms;
+            }
+
+            if (log) {
+                TelemetryRecord r = {};
+                r.type = TELEM_LOOP;
+                r.id = i;
+                r.loop.period_us = period;
+                r.loop.exec_us = s.last_exec_us;
+                r.loop.overruns = s.overruns;
+                log->push(r);
+            }
+        }
+
+        c::task_delay_until(&wake, tick);
+    }
+
+    alive = false;
+}
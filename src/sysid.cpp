@@ -0,0 +1,169 @@
+#include "globals.h"
+
+using namespace pros;
+
+// Stop the motors a test drives however it ends
+struct DriveOffOnExit {
+    ~DriveOffOnExit() {
+        chassis.stop();
+    }
+};
+
+struct RollersOffOnExit {
+    const std::int8_t* ports;
+    int count;
+
+    ~RollersOffOnExit() {
+        for (int i = 0; i < count; i++) {
+            c::motor_move_voltage(ports[i], 0);
+        }
+    }
+};
+
+static void log_sample(SysidMechanism m, SysidTest t, float mv, float vel, float acc) {
+    TelemetryRecord r = {};
+    r.type = TELEM_SYSID;
+    r.id = m;
+    r.sysid.voltage = mv;
+    r.sysid.velocity = vel;
+    r.sysid.accel = acc;
+    r.sysid.omega = odom.get_pose().omega;
+    r.sysid.test = t;
+    telem.push(r);
+}
+
+// Voltage of a test ms into it, ramps stop at their end voltage
+static float test_mv(int sign, float start_mv, float ramp_mv_s, float max_mv, std::uint32_t ms) {
+    float mv = start_mv + ramp_mv_s * ms / 1000.0f;
+    return sign * (mv < max_mv ? mv : max_mv);
+}
+
+/**
+ * One drive test. Quasistatic tests ramp from 0, steps start at their
+ * voltage. Turns drive the right side against the left.
+ */
+static Command drive_test(SysidTest t, float start_mv, float ramp_mv_s, float max_mv, std::uint32_t ms) {
+    int sign = t == SYSID_QUASI_REV || t == SYSID_STEP_REV || t == SYSID_TURN_CCW ? -1 : 1;
+    int turn = t == SYSID_TURN_CW || t == SYSID_TURN_CCW ? -1 : 1;
+
+    DriveOffOnExit guard;
+
+    std::uint32_t t0 = millis();
+    float mv = test_mv(sign, start_mv, ramp_mv_s, max_mv, 0);
+    while (millis() - t0 < ms) {
+        chassis.groupLeft.move_voltage(mv);
+        chassis.groupRight.move_voltage(turn * mv);
+        co_await next_tick();
+
+        // The speed now is the answer to the voltage held over the last tick
+        MotionState l = motion.group(MOTION_LEFT);
+        MotionState r = motion.group(MOTION_RIGHT);
+        log_sample(SYSID_LEFT, t, mv, l.vel * INCHES_PER_TICK, l.acc * INCHES_PER_TICK);
+        log_sample(SYSID_RIGHT, t, turn * mv, r.vel * INCHES_PER_TICK, r.acc * INCHES_PER_TICK);
+        mv = test_mv(sign, start_mv, ramp_mv_s, max_mv, millis() - t0);
+    }
+}
+
+/**
+ * One test on both intake stages at once, each stage's speed is the average
+ * of its motors turned forward.
+ */
+static Command intake_test(SysidTest t, float start_mv, float ramp_mv_s, float max_mv, std::uint32_t ms) {
+    int sign = t == SYSID_QUASI_REV || t == SYSID_STEP_REV ? -1 : 1;
+
+    std::int8_t port[INTAKE_STAGES][INTAKE_STAGE_MOTORS];
+    std::int8_t dir[INTAKE_STAGES][INTAKE_STAGE_MOTORS];
+    std::int8_t all[INTAKE_STAGES * INTAKE_STAGE_MOTORS];
+    int count[INTAKE_STAGES];
+    int n = 0;
+    for (int s = 0; s < INTAKE_STAGES; s++) {
+        count[s] = rollers.motors((IntakeStage)s, port[s], dir[s]);
+        for (int i = 0; i < count[s]; i++) {
+            all[n++] = port[s][i];
+        }
+    }
+
+    RollersOffOnExit guard{all, n};
+
+    std::uint32_t t0 = millis();
+    float mv = test_mv(sign, start_mv, ramp_mv_s, max_mv, 0);
+    while (millis() - t0 < ms) {
+        for (int s = 0; s < INTAKE_STAGES; s++) {
+            for (int i = 0; i < count[s]; i++) {
+                c::motor_move_voltage(port[s][i], dir[s][i] * mv);
+            }
+        }
+        co_await next_tick();
+
+        for (int s = 0; s < INTAKE_STAGES; s++) {
+            float vel = 0;
+            float acc = 0;
+            int used = 0;
+            for (int i = 0; i < count[s]; i++) {
+                MotionState m = motion.motor(port[s][i]);
+                if (m.time_ms) {
+                    vel += dir[s][i] * m.vel;
+                    acc += dir[s][i] * m.acc;
+                    used++;
+                }
+            }
+            if (used) {
+                log_sample((SysidMechanism)(SYSID_INTAKE_MAIN + s), t, mv, vel / used, acc / used);
+            }
+        }
+        mv = test_mv(sign, start_mv, ramp_mv_s, max_mv, millis() - t0);
+    }
+}
+
+// Forward tests then the reverse ones, which bring the robot back
+static Command drive_tests() {
+    const std::uint32_t ramp_ms = SYSID_DRIVE_RAMP_MAX_MV * 1000 / SYSID_DRIVE_RAMP_MV_S;
+    const float step = SYSID_DRIVE_STEP_MV;
+
+    co_await drive_test(SYSID_QUASI_FWD, 0, SYSID_DRIVE_RAMP_MV_S, SYSID_DRIVE_RAMP_MAX_MV, ramp_ms);
+    co_await wait(SYSID_REST_MS);
+    co_await drive_test(SYSID_QUASI_REV, 0, SYSID_DRIVE_RAMP_MV_S, SYSID_DRIVE_RAMP_MAX_MV, ramp_ms);
+    co_await wait(SYSID_REST_MS);
+    co_await drive_test(SYSID_STEP_FWD, step, 0, step, SYSID_DRIVE_STEP_MS);
+    co_await wait(SYSID_REST_MS);
+    co_await drive_test(SYSID_STEP_REV, step, 0, step, SYSID_DRIVE_STEP_MS);
+    co_await wait(SYSID_REST_MS);
+    co_await drive_test(SYSID_TURN_CW, 0, SYSID_DRIVE_RAMP_MV_S, SYSID_DRIVE_RAMP_MAX_MV, ramp_ms);
+    co_await wait(SYSID_REST_MS);
+    co_await drive_test(SYSID_TURN_CCW, 0, SYSID_DRIVE_RAMP_MV_S, SYSID_DRIVE_RAMP_MAX_MV, ramp_ms);
+}
+
+static Command intake_tests() {
+    const std::uint32_t ramp_ms = SYSID_INTAKE_RAMP_MAX_MV * 1000 / SYSID_INTAKE_RAMP_MV_S;
+    const float step = SYSID_INTAKE_STEP_MV;
+
+    co_await intake_test(SYSID_QUASI_FWD, 0, SYSID_INTAKE_RAMP_MV_S, SYSID_INTAKE_RAMP_MAX_MV, ramp_ms);
+    co_await wait(SYSID_REST_MS);
+    co_await intake_test(SYSID_QUASI_REV, 0, SYSID_INTAKE_RAMP_MV_S, SYSID_INTAKE_RAMP_MAX_MV, ramp_ms);
+    co_await wait(SYSID_REST_MS);
+    co_await intake_test(SYSID_STEP_FWD, step, 0, step, SYSID_INTAKE_STEP_MS);
+    co_await wait(SYSID_REST_MS);
+    co_await intake_test(SYSID_STEP_REV, step, 0, step, SYSID_INTAKE_STEP_MS);
+}
+
+// Hands the roller motors back to the intake task however the tests end,
+// including cancelled by disabled() when the period runs out first
+struct IntakeBackOnExit {
+    ~IntakeBackOnExit() {
+        rollers.start();
+    }
+};
+
+Command sysid_routine() {
+    IntakeBackOnExit guard;
+    co_await parallel(drive_tests(), intake_tests());
+}
+
+void sysid() {
+    // The tests write the roller motors, the intake task gets them back after
+    rollers.stop();
+    commands.run(sysid_routine());
+    commands.wait();
+
+    telem.flush();
+}
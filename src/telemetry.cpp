@@ -0,0 +1,318 @@
+#include "telemetry.h"
+#include <cstring>
+
+using namespace pros;
+
+#define BLOCK_RECORDS ((int)(TELEM_BLOCK_BYTES / sizeof(TelemetryRecord)))
+#define RING_MASK (TELEM_RING_SIZE - 1)
+
+// Records carry 48 bits of micros(), years before it wraps
+static void stamp(TelemetryRecord& r) {
+    std::uint64_t now = micros();
+    r.time_us = (std::uint32_t)now;
+    r.time_hi = (std::uint16_t)(now >> 32);
+}
+
+TelemetryLog::TelemetryLog(Odometry& odom, Localizer& loc) : odom(odom), loc(loc) {}
+
+bool TelemetryLog::add_motor(std::int8_t port) {
+    if (running || n_ports >= TELEM_LOG_MOTORS) {
+        return false;
+    }
+    ports[n_ports++] = port;
+    return true;
+}
+
+void TelemetryLog::add_motors(const MotorGroup& mg) {
+    std::int8_t group[TELEM_MAX_MOTORS];
+    int n = telemetry_ports(mg, group);
+    for (int i = 0; i < n; i++) {
+        add_motor(group[i]);
+    }
+}
+
+bool TelemetryLog::start() {
+    if (running || !usd::is_installed()) {
+        return false;
+    }
+
+    // Next number not on the card yet, so earlier runs are kept
+    char path[32];
+    unsigned idx = 0;
+    for (; idx < TELEM_MAX_FILES; idx++) {
+        snprintf(path, sizeof(path), TELEM_FILE_FMT, idx);
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            break;
+        }
+        fclose(f);
+    }
+    if (idx == TELEM_MAX_FILES || !(file = fopen(path, "wb"))) {
+        return false;
+    }
+
+    // Blocks are already the size the card wants, don't copy them again
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    for (std::uint32_t i = 0; i < TELEM_RING_SIZE; i++) {
+        ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    head = 0;
+    tail = 0;
+    fill = 0;
+
+    TelemetryRecord h = {};
+    h.type = TELEM_HEADER;
+    stamp(h);
+    std::memcpy(h.header.magic, "VXTL", 4);
+    h.header.version = TELEM_VERSION;
+    h.header.record_bytes = sizeof(TelemetryRecord);
+    h.header.block_bytes = TELEM_BLOCK_BYTES;
+    h.header.time_ms = millis();
+    put(h);
+
+    running = true;
+    alive = 2;
+    c::task_create(write_fn, this, TELEM_WRITE_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "telemetry writer");
+    c::task_create(sample_fn, this, TELEM_SAMPLE_PRIORITY, TASK_STACK_DEPTH_DEFAULT, "telemetry sampler");
+    return true;
+}
+
+void TelemetryLog::stop() {
+    running = false;
+    while (alive) {
+        delay(1);
+    }
+}
+
+void TelemetryLog::flush() {
+    flush_pending = true;
+}
+
+bool TelemetryLog::push(TelemetryRecord& r) {
+    stamp(r);
+
+    // A slot is free for position pos once its sequence has come back round
+    // to pos. Losing the race to another producer just moves on to the next.
+    std::uint32_t pos = head.load(std::memory_order_relaxed);
+    Slot* s;
+    while (true) {
+        s = &ring[pos & RING_MASK];
+        std::int32_t diff = (std::int32_t)(s->seq.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    s->rec = r;
+    s->seq.store(pos + 1, std::memory_order_release);
+    pushed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void TelemetryLog::name(std::uint8_t id, const char* text) {
+    TelemetryRecord r = {};
+    r.type = TELEM_NAME;
+    r.id = id;
+    std::strncpy(r.name.text, text, sizeof(r.name.text) - 1);
+    push(r);
+}
+
+TelemetryStats TelemetryLog::stats() const {
+    return {pushed, dropped, written, high_water, blocks, write_errors, max_write_us};
+}
+
+bool TelemetryLog::pop(TelemetryRecord& r) {
+    Slot& s = ring[tail & RING_MASK];
+    if ((std::int32_t)(s.seq.load(std::memory_order_acquire) - (tail + 1)) < 0) {
+        return false;
+    }
+
+    r = s.rec;
+    s.seq.store(tail + TELEM_RING_SIZE, std::memory_order_release);
+    tail++;
+    return true;
+}
+
+void TelemetryLog::put(const TelemetryRecord& r) {
+    block[fill++] = r;
+    written++;
+    if (fill == BLOCK_RECORDS) {
+        write_block();
+    }
+}
+
+void TelemetryLog::write_block() {
+    std::uint64_t start = micros();
+    if (fwrite(block, sizeof(block), 1, file) != 1) {
+        write_errors++;
+    }
+    std::uint32_t us = micros() - start;
+    if (us > max_write_us) {
+        max_write_us = us;
+    }
+    blocks++;
+    fill = 0;
+}
+
+void TelemetryLog::sample_fn(void* param) {
+    static_cast<TelemetryLog*>(param)->sample();
+}
+
+void TelemetryLog::write_fn(void* param) {
+    static_cast<TelemetryLog*>(param)->write();
+}
+
+void TelemetryLog::sample() {
+    std::uint32_t wake = millis();
+    MotorTelemetry t;
+
+    while (running) {
+        // Through read_telemetry, TELEM_MAX_MOTORS at a time, so the log's
+        // motor values are the same reads as everything else's
+        for (int first = 0; first < n_ports; first += TELEM_MAX_MOTORS) {
+            read_telemetry(ports + first, n_ports - first, t);
+            for (int i = 0; i < t.count; i++) {
+                TelemetryRecord r = {};
+                r.type = TELEM_MOTOR;
+                r.id = (std::uint8_t)t.port[i];
+                r.motor.position = t.position[i];
+                r.motor.velocity = t.velocity[i];
+                r.motor.current = t.current[i];
+                r.motor.voltage = t.voltage[i];
+                r.motor.temperature = t.temperature[i];
+                r.motor.flags = t.flags[i];
+                push(r);
+            }
+        }
+
+        const Pose poses[2] = {odom.get_pose(), loc.get_pose()};
+        for (int i = 0; i < 2; i++) {
+            TelemetryRecord r = {};
+            r.type = TELEM_POSE;
+            r.id = i == 0 ? TELEM_POSE_ODOM : TELEM_POSE_FUSED;
+            r.pose.x = poses[i].x;
+            r.pose.y = poses[i].y;
+            r.pose.theta = poses[i].theta;
+            r.pose.v = poses[i].v;
+            r.pose.omega = poses[i].omega;
+            r.pose.time_ms = poses[i].time_ms;
+            push(r);
+        }
+
+        c::task_delay_until(&wake, TELEM_SAMPLE_MS);
+    }
+
+    alive--;
+}
+
+void TelemetryLog::write() {
+    std::uint32_t wake = millis();
+    std::uint32_t next_stats = wake + TELEM_STATS_MS;
+
+    while (true) {
+        // Read before draining so the records pushed up to stop() make it out
+        bool last = !running;
+
+        std::uint32_t waiting = head.load(std::memory_order_relaxed) - tail;
+        if (waiting > high_water) {
+            high_water = waiting;
+        }
+
+        TelemetryRecord r;
+        while (pop(r)) {
+            put(r);
+        }
+
+        std::uint32_t now = millis();
+        bool flush_now = flush_pending.exchange(false) || last;
+        if ((std::int32_t)(now - next_stats) >= 0 || flush_now) {
+            next_stats = now + TELEM_STATS_MS;
+
+            TelemetryRecord s = {};
+            s.type = TELEM_STATS;
+            stamp(s);
+            s.stats.written = written + 1;
+            s.stats.dropped = dropped;
+            s.stats.high_water = high_water;
+            s.stats.blocks = blocks;
+            s.stats.write_errors = write_errors;
+            s.stats.max_write_us = max_write_us;
+            put(s);
+        }
+
+        // Pad out the partial block so the card has everything up to now
+        if (flush_now && fill > 0) {
+            std::memset(&block[fill], 0, (BLOCK_RECORDS - fill) * sizeof(TelemetryRecord));
+            write_block();
+            fflush(file);
+        }
+
+        if (last) {
+            break;
+        }
+        c::task_delay_until(&wake, TELEM_WRITE_MS);
+    }
+
+    fclose(file);
+    file = nullptr;
+    alive--;
+}
+
+// Producer task for bench_log()
+struct BenchProducer {
+    TelemetryLog* log;
+    int rate_hz;
+    int seconds;
+    std::atomic<int>* done;
+};
+
+static void bench_producer(void* param) {
+    BenchProducer* b = static_cast<BenchProducer*>(param);
+    std::uint32_t wake = millis();
+
+    // Bursts once per ms, like several loops landing on the same tick
+    int per_ms = b->rate_hz / 1000;
+    int extra = b->rate_hz % 1000;
+    for (int ms = 0; ms < b->seconds * 1000; ms++) {
+        int count = per_ms + (ms % 1000 < extra ? 1 : 0);
+        for (int i = 0; i < count; i++) {
+            TelemetryRecord r = {};
+            r.type = TELEM_LOOP;
+            r.id = 0xff;
+            r.loop.period_us = ms;
+            b->log->push(r);
+        }
+        c::task_delay_until(&wake, 1);
+    }
+    (*b->done)++;
+}
+
+void bench_log(TelemetryLog& log, int rate_hz, int seconds) {
+    const int producers = 4;
+    std::atomic<int> done{0};
+    BenchProducer b[producers];
+    TelemetryStats before = log.stats();
+
+    for (int i = 0; i < producers; i++) {
+        b[i] = {&log, rate_hz / producers, seconds, &done};
+        c::task_create(bench_producer, &b[i], TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT, "log bench");
+    }
+    while (done < producers) {
+        delay(10);
+    }
+
+    TelemetryStats s = log.stats();
+    printf("log bench: %d records/s from %d tasks for %d s\n", rate_hz, producers, seconds);
+    printf("  pushed %lu dropped %lu, ring high water %lu of %d\n", (unsigned long)(s.pushed - before.pushed),
+           (unsigned long)(s.dropped - before.dropped), (unsigned long)s.high_water, TELEM_RING_SIZE);
+    printf("  %lu blocks written, slowest %lu us, %lu errors\n", (unsigned long)(s.blocks - before.blocks),
+           (unsigned long)s.max_write_us, (unsigned long)s.write_errors);
+}
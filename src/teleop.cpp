@@ -1,63 +1,88 @@
 #include "globals.h"
+#include "mixer.h"
+#include "slew.h"
+#include <bit>
 
-void drive() {
-    int dir = ct.get_analog(ANALOG_LEFT_Y); 
-	int turn = ct.get_analog(ANALOG_RIGHT_X);
+// STICK SHAPING: deadband in stick units, expo in percent cubic
+#define THROTTLE_DEADBAND 5
+#define THROTTLE_EXPO 30
+#define TURN_DEADBAND 5
+#define TURN_EXPO 50
 
-    bool IF_LEFT_CHANGE = (ct.get_analog(ANALOG_LEFT_Y) != 0);
-    bool IF_RIGHT_CHANGE = (ct.get_analog(ANALOG_RIGHT_X) != 0);
+// OUTPUT SLEW: stick units per second, and per second^2 for the jerk.
+// Full stick is reached in about a quarter second, the wheels keep their
+// grip and the robot doesn't rock back on a hard start or reversal.
+#define DRIVE_SLEW_RATE 635
+#define DRIVE_SLEW_JERK 12700
 
-    bool RIGHT_GREATER = (ct.get_analog(ANALOG_RIGHT_X) > 0);
-    bool RIGHT_LESSER = (ct.get_analog(ANALOG_RIGHT_X) < 0);
+using ThrottleCurve = InputCurve<THROTTLE_DEADBAND, THROTTLE_EXPO>;
+using TurnCurve = InputCurve<TURN_DEADBAND, TURN_EXPO>;
 
+constexpr SlewConfig<2> DRIVE_SLEW = {
+    .dt = DRIVE_PERIOD_MS / 1000.0f,
+    .ch = {{DRIVE_SLEW_RATE, DRIVE_SLEW_JERK}, {DRIVE_SLEW_RATE, DRIVE_SLEW_JERK}},
+};
 
-    if(IF_LEFT_CHANGE) {
-        mgL.move(ct.get_analog(ANALOG_LEFT_Y));
-        mgR.move(ct.get_analog(ANALOG_LEFT_Y));
-    } else {
-        mgL.move(0);
-        mgR.move(0);
-    }
+// Left and right side outputs
+static SlewStage<2, DRIVE_SLEW> drive_slew;
+
+void reset_drive() {
+    drive_slew.reset();
+}
 
-    int X_LR = ct.get_analog(ANALOG_RIGHT_X);
+void drive() {
+    StageTimer t(tick_prof, STAGE_DRIVE);
+
+    int dir = ThrottleCurve::apply(ctIn.get_analog(ANALOG_LEFT_Y));
+    int turn = TurnCurve::apply(ctIn.get_analog(ANALOG_RIGHT_X));
 
-    if(IF_RIGHT_CHANGE) {
-        if(RIGHT_GREATER) {
-            mgL.move(X_LR);
-        } else if (RIGHT_LESSER) {
-            mgR.move(-1 * X_LR);
-        }
+    // Both sides always get throttle +/- turn, scaled together if saturated
+    DriveOutput mix = arcade_mix(dir, turn);
+    float out[2] = {(float)mix.left, (float)mix.right};
+
+    // A side that lost motors is weaker, so the other is eased down to
+    // match and the robot still drives where the sticks point
+    static const std::uint32_t left_ports = port_mask(mgL);
+    static const std::uint32_t right_ports = port_mask(mgR);
+    std::uint32_t h = devices.health();
+    int nl = std::popcount(h & left_ports);
+    int nr = std::popcount(h & right_ports);
+    if (nl && nr && nl != nr) {
+        out[nl > nr ? 0 : 1] *= (float)std::min(nl, nr) / std::max(nl, nr);
     }
+    drive_slew.apply(out);
 
+    StageTimer w(tick_prof, STAGE_MOTOR_WRITE);
+    mgL.move(std::lround(out[0]));
+    mgR.move(std::lround(out[1]));
 }
 
+// Buttons only pick a mode, the intake task runs the motors and clears jams
 void intake(){
-	if(ct.get_digital_new_press(E_CONTROLLER_DIGITAL_R1)) {
-		mgIN.move_voltage(-12000);
-		mtIN3.move_voltage(12000);
-	} else if (ct.get_digital_new_release(E_CONTROLLER_DIGITAL_R1)) {
-		mgIN.move_voltage(0);
-		mtIN3.move_voltage(0);
+	StageTimer t(tick_prof, STAGE_INTAKE);
+
+	if(ctIn.get_digital_new_press(E_CONTROLLER_DIGITAL_R1)) {
+		rollers.set(INTAKE_MAIN, INTAKE_FWD);
+	} else if (ctIn.get_digital_new_release(E_CONTROLLER_DIGITAL_R1)) {
+		rollers.set(INTAKE_MAIN, INTAKE_OFF);
 	}
 
-	if(ct.get_digital_new_press(E_CONTROLLER_DIGITAL_R2)) {
-		mgIN.move_voltage(12000);
-		mtIN3.move_voltage(-12000);
-	} else if (ct.get_digital_new_release(E_CONTROLLER_DIGITAL_R2)) {
-		mgIN.move_voltage(0);
-		mtIN3.move_voltage(0);
+	if(ctIn.get_digital_new_press(E_CONTROLLER_DIGITAL_R2)) {
+		rollers.set(INTAKE_MAIN, INTAKE_REV);
+	} else if (ctIn.get_digital_new_release(E_CONTROLLER_DIGITAL_R2)) {
+		rollers.set(INTAKE_MAIN, INTAKE_OFF);
 	}
 
-    if(ct.get_digital_new_press(E_CONTROLLER_DIGITAL_B)) {
-        mtIN4.move_voltage(12000);
-    } else if (ct.get_digital_new_release(E_CONTROLLER_DIGITAL_B)) {
-        mtIN4.move(0);
+    if(ctIn.get_digital_new_press(E_CONTROLLER_DIGITAL_B)) {
+        rollers.set(INTAKE_TOP, INTAKE_FWD);
+    } else if (ctIn.get_digital_new_release(E_CONTROLLER_DIGITAL_B)) {
+        rollers.set(INTAKE_TOP, INTAKE_OFF);
     }
 
-    if(ct.get_digital_new_press(E_CONTROLLER_DIGITAL_A)) {
-        mtIN4.move_voltage(-12000);
-    } else if (ct.get_digital_new_release(E_CONTROLLER_DIGITAL_A)) {
-        mtIN4.move(0);
+    if(ctIn.get_digital_new_press(E_CONTROLLER_DIGITAL_A)) {
+        rollers.set(INTAKE_TOP, INTAKE_REV);
+    } else if (ctIn.get_digital_new_release(E_CONTROLLER_DIGITAL_A)) {
+        rollers.set(INTAKE_TOP, INTAKE_OFF);
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "tick_profile.h"
+
+using namespace pros;
+
+void TickProfile::begin_tick() {
+    std::uint64_t now = micros();
+
+    // A tick that wrote nothing has no output latency to report
+    if (tick_start != 0 && last_write >= tick_start) {
+        hist[STAGE_TICK].record(last_write - tick_start);
+    }
+    tick_start = now;
+}
+
+void TickProfile::reset() {
+    for (LatencyHistogram& h : hist) {
+        h.reset();
+    }
+    tick_start = 0;
+    last_write = 0;
+}
+
+void TickProfile::print(int first_line) const {
+    for (int i = 0; i < NUM_STAGES; i++) {
+        const LatencyHistogram& h = hist[i];
+        lcd::print(first_line + i, "%-6s p50 %lu p99 %lu max %lu us", TICK_STAGE_NAMES[i],
+                   (unsigned long)h.percentile(0.5f), (unsigned long)h.percentile(0.99f),
+                   (unsigned long)h.max_value());
+    }
+}
+
+void TickProfile::log(TelemetryLog& log) const {
+    for (int i = 0; i < NUM_STAGES; i++) {
+        const LatencyHistogram& h = hist[i];
+        TelemetryRecord r = {};
+        r.type = TELEM_PROFILE;
+        r.id = i;
+        r.profile.count = h.count();
+        r.profile.p50_us = h.percentile(0.5f);
+        r.profile.p90_us = h.percentile(0.9f);
+        r.profile.p99_us = h.percentile(0.99f);
+        r.profile.p999_us = h.percentile(0.999f);
+        r.profile.max_us = h.max_value();
+        log.push(r);
+    }
+}
@@ -0,0 +1,177 @@
+// Bakes the autonomous route's paths into include/routes_baked.h.
+//
+// Plans each leg of routine() on the bare field the way the navigator
+// would, generates its path at the drive's limits and writes the samples out
+// in PathSample fixed point as constexpr tables, along with the inflated
+// field grid the navigator starts from. The brain then links them into flash
+// and drives the first leg on the first tick, with no planning or spline and
+// profile work at startup. The header records what it was baked from and
+// stops the robot's build once any of that changes, so re-run this after
+// editing routes.h, field_map.h, the planner's margins or the drive limits.
+//
+// Build:  g++ -std=c++20 -O2 -Iinclude tools/bake_routes.cpp -o bake_routes
+// Usage:  ./bake_routes [OUT.h]       (default include/routes_baked.h)
+//
+// Prints each leg's size and the worst rounding error the fixed point adds.
+
+#include "drive_gains.h"
+#include "planner.h"
+#include "routes.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+struct LegSpec {
+    const char* name;
+    float sx, sy, facing;
+    float gx, gy, heading;
+};
+
+// In the order routine() drives them, each starting from rest facing the
+// way the robot is left by what came before
+constexpr LegSpec LEGS[] = {
+    {"TO_GOAL", START_X, START_Y, START_HEADING, GOAL_X, GOAL_Y, GOAL_HEADING},
+    {"TO_LOADER", GOAL_X, GOAL_Y, GOAL_HEADING + GOAL_TURN, LOADER_X, LOADER_Y, LOADER_HEADING},
+};
+
+// Everything the tables depend on
+struct Input {
+    const char* name;
+    float value;
+};
+
+#define INPUT(x) {#x, (float)(x)}
+
+constexpr Input INPUTS[] = {
+    INPUT(DRIVE_MAX_VEL),     INPUT(DRIVE_MAX_ACCEL),    INPUT(PATH_SPACING),       INPUT(PLAN_TURN_K),
+    INPUT(PLAN_ROBOT_RADIUS), INPUT(PLAN_MARGIN),        INPUT(PLAN_MAX_LEG),       INPUT(PLAN_ESCAPE),
+    INPUT(PLAN_APPROACH),     INPUT(PLAN_APPROACH_TURN), INPUT(OCC_CELL),           INPUT(OCC_ORIGIN),
+    INPUT(OCC_N),             INPUT(SAMPLE_POS_SCALE),   INPUT(SAMPLE_ANGLE_SCALE), INPUT(SAMPLE_CURVATURE_SCALE),
+    INPUT(SAMPLE_VEL_SCALE),  INPUT(START_X),            INPUT(START_Y),            INPUT(START_HEADING),
+    INPUT(GOAL_X),            INPUT(GOAL_Y),             INPUT(GOAL_HEADING),       INPUT(GOAL_TURN),
+    INPUT(LOADER_X),          INPUT(LOADER_Y),           INPUT(LOADER_HEADING),     INPUT(field_fingerprint()),
+};
+
+static OccupancyGrid field;
+static Planner planner;
+static Path path;
+
+// v as a float literal that reads back exactly, from a few rotating buffers
+static const char* lit(float v) {
+    static char buf[8][32];
+    static int next = 0;
+    char* b = buf[next++ % 8];
+    int n = std::snprintf(b, 32, "%.9g", v);
+    if (!std::strpbrk(b, ".e")) {
+        std::snprintf(b + n, 32 - n, ".0");
+    }
+    std::strcat(b, "f");
+    return b;
+}
+
+static std::int16_t quantize(float v, float scale) {
+    float q = std::round(v * scale);
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (std::int16_t)q;
+}
+
+static bool bake(std::FILE* out, const LegSpec& leg) {
+    Waypoint wps[PLAN_MAX_WAYPOINTS];
+    int n = planner.plan(field, leg.sx, leg.sy, leg.gx, leg.gy, leg.heading, wps, PLAN_MAX_WAYPOINTS);
+    if (n < 2) {
+        std::fprintf(stderr, "%s: no plan on the bare field\n", leg.name);
+        return false;
+    }
+    // Leaves the way the robot faces, as Navigator::plan() does from rest
+    wps[0].heading = leg.facing;
+    PathLimits lim = {DRIVE_MAX_VEL, DRIVE_MAX_ACCEL, PLAN_TURN_K};
+    if (!path.generate(wps, n, lim)) {
+        std::fprintf(stderr, "%s: path longer than PATH_MAX_POINTS\n", leg.name);
+        return false;
+    }
+
+    std::fprintf(out, "inline constexpr Waypoint %s_WAYPOINTS[] = {\n", leg.name);
+    for (int i = 0; i < n; i++) {
+        std::fprintf(out, "    {%s, %s, %s},\n", lit(wps[i].x), lit(wps[i].y), lit(wps[i].heading));
+    }
+    std::fprintf(out, "};\n\n");
+
+    float worst_pos = 0, worst_vel = 0, worst_k = 0;
+    std::fprintf(out, "inline constexpr PathSample %s_SAMPLES[] = {\n", leg.name);
+    for (int i = 0; i < path.size; i++) {
+        PathSample s = {quantize(path.x[i], SAMPLE_POS_SCALE), quantize(path.y[i], SAMPLE_POS_SCALE),
+                        quantize(path.heading[i], SAMPLE_ANGLE_SCALE),
+                        quantize(path.curvature[i], SAMPLE_CURVATURE_SCALE), quantize(path.vel[i], SAMPLE_VEL_SCALE)};
+        std::fprintf(out, "%s{%d, %d, %d, %d, %d},%s", i % 3 ? " " : "    ", s.x, s.y, s.heading, s.curvature, s.vel,
+                     i % 3 == 2 || i + 1 == path.size ? "\n" : "");
+        worst_pos = std::fmax(worst_pos, std::hypot(s.x / SAMPLE_POS_SCALE - path.x[i], s.y / SAMPLE_POS_SCALE - path.y[i]));
+        worst_vel = std::fmax(worst_vel, std::fabs(s.vel / SAMPLE_VEL_SCALE - path.vel[i]));
+        worst_k = std::fmax(worst_k, std::fabs(s.curvature / SAMPLE_CURVATURE_SCALE - path.curvature[i]));
+    }
+    std::fprintf(out, "};\n\n");
+
+    std::fprintf(out,
+                 "inline constexpr BakedLeg %s = {\n"
+                 "    %s, %s, %s,\n"
+                 "    %s, %s, %s,\n"
+                 "    %s_WAYPOINTS, %d,\n"
+                 "    %s_SAMPLES, %d,\n"
+                 "};\n\n",
+                 leg.name, lit(leg.sx), lit(leg.sy), lit(leg.facing), lit(leg.gx), lit(leg.gy), lit(leg.heading),
+                 leg.name, n, leg.name, path.size);
+
+    std::printf("%-10s %2d waypoints  %3d samples  %4.1f s  rounding %.4f in  %.4f in/s  %.5f 1/in\n", leg.name, n,
+                path.size, path.duration(), worst_pos, worst_vel, worst_k);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* name = argc > 1 ? argv[1] : "include/routes_baked.h";
+    build_field_occupancy(field, PLAN_ROBOT_RADIUS + PLAN_MARGIN);
+
+    std::FILE* out = std::fopen(name, "w");
+    if (!out) {
+        std::perror(name);
+        return 2;
+    }
+
+    std::fprintf(out,
+                 "#pragma once\n\n"
+                 "#include \"drive_gains.h\"\n"
+                 "#include \"planner.h\"\n"
+                 "#include \"routes.h\"\n"
+                 "#include <cstdint>\n\n"
+                 "// Generated by tools/bake_routes.cpp, do not edit. The autonomous route's\n"
+                 "// legs planned on the bare field and generated at the drive's limits, and\n"
+                 "// the inflated field grid, all in flash.\n\n");
+
+    // What it was baked from, each checked against the build it lands in
+    std::fprintf(out, "// BAKED FROM, re-run tools/bake_routes if any of these fail\n");
+    for (const Input& in : INPUTS) {
+        std::fprintf(out, "static_assert(%s == %s, \"stale routes_baked.h\");\n", in.name, lit(in.value));
+    }
+    std::fprintf(out, "\n");
+
+    for (const LegSpec& leg : LEGS) {
+        if (!bake(out, leg)) {
+            std::fclose(out);
+            std::remove(name);
+            return 1;
+        }
+    }
+
+    std::fprintf(out, "inline constexpr OccupancyGrid::Row FIELD_OCCUPANCY[OCC_N] = {\n");
+    for (int iy = 0; iy < OCC_N; iy++) {
+        std::fprintf(out, "    {");
+        for (int k = 0; k < OCC_WORDS; k++) {
+            std::fprintf(out, "%s0x%016llxull", k ? ", " : "", (unsigned long long)field.data()[iy][k]);
+        }
+        std::fprintf(out, "},\n");
+    }
+    std::fprintf(out, "};\n");
+
+    std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,42 @@
+// Host micro-benchmark for pid.h.
+//
+// Times Pid::update and Feedforward::calc on a synthetic signal and prints
+// nanoseconds per call. The brain's Cortex-A9 is several times slower than a
+// desktop core, so the budget is a microsecond there.
+//
+// Build:  g++ -std=c++20 -O2 -Iinclude tools/bench_pid.cpp -o bench_pid
+
+#include "pid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+constexpr PidGains P_ONLY = {.kp = 500};
+constexpr PidGains FULL = {.kp = 500, .ki = 80, .kd = 20, .i_max = 3000, .d_alpha = 0.3f};
+constexpr FfGains FF = {.ks = 600, .kv = 150, .ka = 20};
+
+template <typename F>
+static double time_ns(F&& f, int n) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        f(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+int main() {
+    const int n = 20000000;
+    volatile float sink = 0;
+
+    Pid<P_ONLY> p;
+    Pid<FULL> full;
+
+    double ns_p = time_ns([&](int i) { sink = p.update(10, sink * 1e-4f + i * 1e-6f); }, n);
+    double ns_full = time_ns([&](int i) { sink = full.update(10, sink * 1e-4f + i * 1e-6f); }, n);
+    double ns_ff = time_ns([&](int i) { sink = Feedforward<FF>::calc(sink * 1e-4f + i * 1e-6f, 2); }, n);
+
+    std::printf("Pid<P only>      %6.2f ns/update\n", ns_p);
+    std::printf("Pid<PID+filter>  %6.2f ns/update\n", ns_full);
+    std::printf("Feedforward      %6.2f ns/calc\n", ns_ff);
+    return 0;
+}
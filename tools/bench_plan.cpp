@@ -0,0 +1,93 @@
+// Host benchmark for planner.h.
+//
+// Plans between random points on the field grid with a few random
+// opponent-sized discs dropped in, and prints the time per plan including
+// inflating the discs (mean and worst), the cells expanded and how many
+// smoothed paths pass closer to an obstacle than the robot's radius. The brain's Cortex-A9 is several times
+// slower than a desktop core, so the budget for a replan is 1 ms here.
+//
+// Build:  g++ -std=c++20 -O2 -Iinclude tools/bench_plan.cpp -o bench_plan
+// Usage:  ./bench_plan [PLANS]
+
+#include "planner.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+constexpr int OBSTACLES = 3;
+constexpr float OBSTACLE_RADIUS = 9;
+constexpr int REPEATS = 3;
+
+static Planner planner;
+static OccupancyGrid field, tight, grid, body, discs, grown;
+static Path path;
+
+static float rand_coord(unsigned& s) {
+    s = s * 1664525 + 1013904223;
+    return (s >> 8) / 16777216.0f * 2 * FIELD_HALF - FIELD_HALF;
+}
+
+int main(int argc, char** argv) {
+    int plans = argc > 1 ? std::atoi(argv[1]) : 2000;
+    build_field_occupancy(field, PLAN_ROBOT_RADIUS + PLAN_MARGIN);
+    build_field_occupancy(tight, PLAN_ROBOT_RADIUS);
+
+    Waypoint wps[PLAN_MAX_WAYPOINTS];
+    PathLimits lim = {60, 120, 30};
+    unsigned seed = 1;
+    double total = 0, worst = 0;
+    long expanded = 0;
+    int found = 0, blocked = 0, grazing = 0;
+
+    for (int i = 0; i < plans; i++) {
+        discs.clear();
+        for (int k = 0; k < OBSTACLES; k++) {
+            discs.fill_disc(rand_coord(seed), rand_coord(seed), OBSTACLE_RADIUS);
+        }
+        float sx = rand_coord(seed), sy = rand_coord(seed);
+        float gx = rand_coord(seed), gy = rand_coord(seed);
+
+        // Best of a few, so a preempted run doesn't count as the worst
+        int n = 0;
+        double us = 1e9;
+        for (int rep = 0; rep < REPEATS; rep++) {
+            auto t0 = std::chrono::steady_clock::now();
+            grown.inflate(discs, PLAN_ROBOT_RADIUS + PLAN_MARGIN);
+            grid = field;
+            grid.merge(grown);
+            n = planner.plan(grid, sx, sy, gx, gy, NAN, wps, PLAN_MAX_WAYPOINTS);
+            double t = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            us = t < us ? t : us;
+        }
+
+        total += us;
+        worst = us > worst ? us : worst;
+        expanded += planner.expanded();
+        if (!n) {
+            blocked++;
+            continue;
+        }
+        found++;
+
+        // Checked against the obstacles grown by the radius alone
+        body.inflate(discs, PLAN_ROBOT_RADIUS);
+        body.merge(tight);
+        path.generate(wps, n, lim);
+        bool started_clear = !body.occupied(OccupancyGrid::cell(sx), OccupancyGrid::cell(sy));
+        bool clear = false;
+        for (int k = 0; k < path.size; k++) {
+            bool occ = body.occupied(OccupancyGrid::cell(path.x[k]), OccupancyGrid::cell(path.y[k]));
+            clear = clear || !occ || started_clear;
+            if (occ && clear) {
+                grazing++;
+                break;
+            }
+        }
+    }
+
+    std::printf("%d plans: %.1f us mean, %.1f us worst, %.0f cells expanded mean\n", plans, total / plans, worst,
+                (double)expanded / plans);
+    std::printf("%d found, %d blocked or unreachable, %d paths within the robot's radius of something\n", found,
+                blocked, grazing);
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Host replay harness for the pose EKF.
+//
+// Feeds a recorded (or synthetic) sensor stream through the same PoseEkf the
+// robot runs and checks the estimate stays within drift bounds of ground
+// truth. Exits non-zero if a bound is broken, so it can gate filter changes.
+//
+// Build:  g++ -std=c++20 -O2 -Iinclude tools/ekf_replay.cpp -o ekf_replay
+// Usage:  ./ekf_replay [--synth SECONDS | FILE.csv] [--max-pos IN] [--max-theta DEG]
+//
+// CSV columns, one row per odometry step, header line skipped:
+//   t_ms, ds, dtheta, gps_valid, gps_x, gps_y, gps_theta, gps_sd, truth_x, truth_y, truth_theta
+// Distances in inches, angles in radians, Pose convention (clockwise from +y).
+
+#include "ekf.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct Row {
+    float t_ms;
+    float ds, dtheta;
+    int gps_valid;
+    float gps_x, gps_y, gps_theta, gps_sd;
+    float truth_x, truth_y, truth_theta;
+};
+
+static std::vector<Row> load_csv(const char* path) {
+    std::vector<Row> rows;
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::perror(path);
+        std::exit(2);
+    }
+
+    char line[512];
+    std::fgets(line, sizeof line, f);
+    while (std::fgets(line, sizeof line, f)) {
+        Row r;
+        int n = std::sscanf(line, "%f,%f,%f,%d,%f,%f,%f,%f,%f,%f,%f", &r.t_ms, &r.ds, &r.dtheta,
+                            &r.gps_valid, &r.gps_x, &r.gps_y, &r.gps_theta, &r.gps_sd,
+                            &r.truth_x, &r.truth_y, &r.truth_theta);
+        if (n == 11) {
+            rows.push_back(r);
+        }
+    }
+    std::fclose(f);
+    return rows;
+}
+
+// Drives an oval at 100 Hz with a biased, noisy odometry and a 20 Hz GPS
+static std::vector<Row> synth(float seconds) {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> n01(0, 1);
+
+    std::vector<Row> rows;
+    float x = -36, y = -48, th = 0;
+    const float dt = 0.01f;
+
+    for (int i = 0; i < seconds / dt; i++) {
+        float t = i * dt;
+        float v = 40 + 20 * std::sin(t * 0.5f);          // in/s
+        float w = 0.9f * std::sin(t * 0.35f);            // rad/s
+
+        float ds = v * dt;
+        float dth = w * dt;
+        float mid = th + dth / 2;
+        x += ds * std::sin(mid);
+        y += ds * std::cos(mid);
+        th += dth;
+
+        Row r = {};
+        r.t_ms = t * 1000;
+        r.ds = ds * 1.02f + n01(rng) * 0.01f;            // 2% wheel scale error
+        r.dtheta = dth + 0.0001f * dt + n01(rng) * 0.0005f;
+        r.gps_valid = i % 5 == 0;
+        r.gps_sd = 0.8f;
+        r.gps_x = x + n01(rng) * r.gps_sd;
+        r.gps_y = y + n01(rng) * r.gps_sd;
+        r.gps_theta = th + n01(rng) * 0.03f;
+        r.truth_x = x;
+        r.truth_y = y;
+        r.truth_theta = th;
+        rows.push_back(r);
+    }
+    return rows;
+}
+
+int main(int argc, char** argv) {
+    std::vector<Row> rows;
+    float max_pos = 3.0f;
+    float max_theta = 3.0f;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--synth") && i + 1 < argc) {
+            rows = synth(std::atof(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--max-pos") && i + 1 < argc) {
+            max_pos = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--max-theta") && i + 1 < argc) {
+            max_theta = std::atof(argv[++i]);
+        } else {
+            rows = load_csv(argv[i]);
+        }
+    }
+    if (rows.empty()) {
+        rows = synth(120);
+    }
+
+    PoseEkf ekf;
+    const Row& r0 = rows[0];
+    ekf.reset(r0.truth_x, r0.truth_y, r0.truth_theta, 0.5f, 0.02f);
+
+    // Plain dead reckoning on the same stream, for comparison
+    float ox = r0.truth_x, oy = r0.truth_y, oth = r0.truth_theta;
+
+    float prev_t = r0.t_ms;
+    double worst_pos = 0, worst_theta = 0, sum_sq = 0;
+    double odom_worst = 0;
+    int accepted = 0, rejected = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const Row& r : rows) {
+        float dt = (r.t_ms - prev_t) / 1000.0f;
+        prev_t = r.t_ms;
+
+        ekf.predict(r.ds, r.dtheta, dt);
+        if (r.gps_valid) {
+            if (ekf.update(r.gps_x, r.gps_y, r.gps_theta, r.gps_sd, 0.035f)) {
+                accepted++;
+            } else {
+                rejected++;
+            }
+        }
+
+        float mid = oth + r.dtheta / 2;
+        ox += r.ds * std::sin(mid);
+        oy += r.ds * std::cos(mid);
+        oth += r.dtheta;
+
+        double e = std::hypot(ekf.x(0, 0) - r.truth_x, ekf.x(1, 0) - r.truth_y);
+        double et = std::fabs(PoseEkf::wrap(ekf.x(2, 0) - r.truth_theta)) * 180 / M_PI;
+        worst_pos = std::fmax(worst_pos, e);
+        worst_theta = std::fmax(worst_theta, et);
+        sum_sq += e * e;
+        odom_worst = std::fmax(odom_worst, std::hypot(ox - r.truth_x, oy - r.truth_y));
+    }
+
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("steps %zu, fixes accepted %d rejected %d\n", rows.size(), accepted, rejected);
+    std::printf("odometry only : max pos err %.2f in\n", odom_worst);
+    std::printf("ekf           : max pos err %.2f in, rms %.2f in, max heading err %.2f deg\n",
+                worst_pos, std::sqrt(sum_sq / rows.size()), worst_theta);
+    std::printf("host cost     : %.2f us per step\n", us / rows.size());
+
+    bool ok = worst_pos <= max_pos && worst_theta <= max_theta;
+    std::printf("%s (bounds %.2f in, %.2f deg)\n", ok ? "PASS" : "FAIL", max_pos, max_theta);
+    return ok ? 0 : 1;
+}
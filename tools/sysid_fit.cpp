@@ -0,0 +1,295 @@
+// Host fitter for the feedforward characterization logs (sysid.h).
+//
+// Reads the TELEM_SYSID samples out of one or more telemetry logs and fits
+// each mechanism's voltage as
+//
+//   V = kS sgn(v) + kV v + kA a
+//
+// by least squares over its quasistatic and step tests, and the drive's
+// effective track width from the turn tests as (v_left - v_right) / omega.
+// Accelerations are differenced from the logged velocities. The normal
+// equations are built from dot products of the sample columns, each summed
+// in independent lanes so the loop compiles to SIMD without reassociating a
+// single float sum, and solved by Cholesky.
+//
+// Build:  g++ -std=c++20 -O3 -march=native -Iinclude tools/sysid_fit.cpp -o sysid_fit
+// Usage:  ./sysid_fit [--min-speed FRACTION] [--trim MS] LOG.bin...
+//
+// Samples slower than FRACTION (default 0.05) of the mechanism's top speed
+// are left out: standing still, the friction that holds it is anywhere
+// between -kS and kS and fits nothing. So is the first MS (default 80) of
+// each step, while the robot's velocity fit still spans the step. Drive
+// gains are mV per in/s and in/s^2 per side, roller gains mV per raw count/s
+// and count/s^2.
+
+#include "telemetry_record.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+constexpr int LANES = 8;
+constexpr int K = 3;                                // kS, kV, kA
+constexpr float MIN_TURN_RATE = 0.3f;               // rad/s, for the track width
+constexpr int DIFF_SPAN = 4;                        // samples, for the acceleration
+
+static std::uint64_t time_us(const TelemetryRecord& r) {
+    return (std::uint64_t)r.time_hi << 32 | r.time_us;
+}
+
+// One mechanism's samples as columns
+struct Columns {
+    std::vector<float> sign, vel, acc, volts;
+};
+
+struct Fit {
+    double k[K];
+    double r2;
+    double rms;                                     // mV
+    std::size_t n;
+    bool ok;
+};
+
+// Sum of a[i] * b[i], in LANES partial sums that vectorize
+static double dot(const float* a, const float* b, std::size_t n) {
+    double lane[LANES] = {};
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int l = 0; l < LANES; l++) {
+            lane[l] += (double)a[i + l] * b[i + l];
+        }
+    }
+    double s = 0;
+    for (int l = 0; l < LANES; l++) {
+        s += lane[l];
+    }
+    for (; i < n; i++) {
+        s += (double)a[i] * b[i];
+    }
+    return s;
+}
+
+// Solves the symmetric positive definite m x = y in place by Cholesky,
+// false if m is singular (a column never varied)
+static bool cholesky_solve(double m[K][K], double y[K]) {
+    for (int j = 0; j < K; j++) {
+        double d = m[j][j];
+        for (int p = 0; p < j; p++) d -= m[j][p] * m[j][p];
+        if (d <= 1e-12) {
+            return false;
+        }
+        m[j][j] = std::sqrt(d);
+        for (int i = j + 1; i < K; i++) {
+            double s = m[i][j];
+            for (int p = 0; p < j; p++) s -= m[i][p] * m[j][p];
+            m[i][j] = s / m[j][j];
+        }
+    }
+    for (int i = 0; i < K; i++) {
+        for (int p = 0; p < i; p++) y[i] -= m[i][p] * y[p];
+        y[i] /= m[i][i];
+    }
+    for (int i = K - 1; i >= 0; i--) {
+        for (int p = i + 1; p < K; p++) y[i] -= m[p][i] * y[p];
+        y[i] /= m[i][i];
+    }
+    return true;
+}
+
+static Fit fit(const Columns& c) {
+    Fit f = {};
+    f.n = c.volts.size();
+    if (f.n < 10) {
+        return f;
+    }
+
+    const float* x[K] = {c.sign.data(), c.vel.data(), c.acc.data()};
+    const float* y = c.volts.data();
+    double m[K][K];
+    double b[K];
+    for (int i = 0; i < K; i++) {
+        for (int j = 0; j <= i; j++) {
+            m[i][j] = m[j][i] = dot(x[i], x[j], f.n);
+        }
+        b[i] = dot(x[i], y, f.n);
+    }
+    double yy = dot(y, y, f.n);
+    double ybar = 0;
+    for (float v : c.volts) ybar += v;
+    ybar /= f.n;
+
+    if (!cholesky_solve(m, b)) {
+        return f;
+    }
+    for (int i = 0; i < K; i++) f.k[i] = b[i];
+
+    double sse = 0;
+    for (std::size_t i = 0; i < f.n; i++) {
+        double e = y[i] - (b[0] * x[0][i] + b[1] * x[1][i] + b[2] * x[2][i]);
+        sse += e * e;
+    }
+    double sst = yy - f.n * ybar * ybar;
+    f.r2 = sst > 0 ? 1 - sse / sst : 0;
+    f.rms = std::sqrt(sse / f.n);
+    f.ok = true;
+    return f;
+}
+
+static void print_fit(const char* name, const Fit& f, const char* unit) {
+    if (!f.ok) {
+        std::printf("%-12s not enough samples (%zu)\n", name, f.n);
+        return;
+    }
+    std::printf("%-12s kS %7.1f mV  kV %8.3f mV/(%s/s)  kA %8.4f mV/(%s/s^2)  r2 %.4f  rms %5.1f mV  (%zu)\n",
+                name, f.k[0], f.k[1], unit, f.k[2], unit, f.r2, f.rms, f.n);
+}
+
+static bool load(const char* path, std::vector<TelemetryRecord>& out) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        std::perror(path);
+        return false;
+    }
+    TelemetryRecord r;
+    bool first = true;
+    while (std::fread(&r, sizeof r, 1, f) == 1) {
+        if (first && (r.type != TELEM_HEADER || std::memcmp(r.header.magic, "VXTL", 4))) {
+            std::fprintf(stderr, "%s: not a telemetry log\n", path);
+            std::fclose(f);
+            return false;
+        }
+        first = false;
+        if (r.type == TELEM_SYSID && r.id < SYSID_MECHANISMS && r.sysid.test < SYSID_TESTS) {
+            out.push_back(r);
+        }
+    }
+    std::fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    float min_speed = 0.05f;
+    float trim_ms = 80;
+    std::vector<TelemetryRecord> recs;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--min-speed") && i + 1 < argc) {
+            min_speed = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--trim") && i + 1 < argc) {
+            trim_ms = std::atof(argv[++i]);
+        } else if (!load(argv[i], recs)) {
+            return 2;
+        }
+    }
+    if (recs.empty()) {
+        std::fprintf(stderr, "usage: sysid_fit [--min-speed FRACTION] [--trim MS] LOG.bin...\n"
+                             "no characterization samples found\n");
+        return 2;
+    }
+
+    // Top speed per mechanism over its straight tests, for the cutoff
+    float top[SYSID_MECHANISMS] = {};
+    for (const TelemetryRecord& r : recs) {
+        if (r.sysid.test < SYSID_TURN_CW) {
+            top[r.id] = std::fmax(top[r.id], std::fabs(r.sysid.velocity));
+        }
+    }
+
+    // Acceleration from the logged velocities, by a central difference over
+    // DIFF_SPAN samples each side within the same test. The robot's own
+    // estimate is a parabola's curvature, the acceleration in the middle of
+    // its window, which runs ahead of a step's decaying one; a difference
+    // centred on the sample isn't, and spanning a few samples keeps the
+    // count quantization in the velocities from swamping it.
+    std::vector<float> accel(recs.size(), NAN);
+    for (int m = 0; m < SYSID_MECHANISMS; m++) {
+        std::vector<int> run;
+        for (int i = 0; i <= (int)recs.size(); i++) {
+            bool end = i == (int)recs.size();
+            if (!end && recs[i].id != m) {
+                continue;
+            }
+            if (end || (!run.empty() && recs[run.back()].sysid.test != recs[i].sysid.test)) {
+                for (int k = DIFF_SPAN; k + DIFF_SPAN < (int)run.size(); k++) {
+                    const TelemetryRecord& a = recs[run[k - DIFF_SPAN]];
+                    const TelemetryRecord& b = recs[run[k + DIFF_SPAN]];
+                    accel[run[k]] = (b.sysid.velocity - a.sysid.velocity) / ((time_us(b) - time_us(a)) / 1e6f);
+                }
+                run.clear();
+            }
+            if (!end) {
+                run.push_back(i);
+            }
+        }
+    }
+
+    // Straight tests fit the gains. Turns pair each tick's left sample with
+    // the right one after it for the track width.
+    Columns cols[SYSID_MECHANISMS];
+    Columns drive;
+    std::vector<float> diff, omega;
+    const TelemetryRecord* left = nullptr;
+    int last_test[SYSID_MECHANISMS];
+    std::uint64_t test_start[SYSID_MECHANISMS] = {};
+    for (int& t : last_test) t = -1;
+    for (std::size_t i = 0; i < recs.size(); i++) {
+        const TelemetryRecord& r = recs[i];
+        const auto& s = r.sysid;
+        if (s.test != last_test[r.id]) {
+            last_test[r.id] = s.test;
+            test_start[r.id] = time_us(r);
+        }
+        if (s.test >= SYSID_TURN_CW) {
+            if (r.id == SYSID_LEFT) {
+                left = &r;
+            } else if (r.id == SYSID_RIGHT && left && left->sysid.test == s.test) {
+                if (std::fabs(s.omega) >= MIN_TURN_RATE) {
+                    diff.push_back(left->sysid.velocity - s.velocity);
+                    omega.push_back(s.omega);
+                }
+                left = nullptr;
+            }
+            continue;
+        }
+        if (std::fabs(s.velocity) < min_speed * top[r.id] || std::isnan(accel[i])) {
+            continue;
+        }
+        bool step = s.test == SYSID_STEP_FWD || s.test == SYSID_STEP_REV;
+        if (step && time_us(r) - test_start[r.id] < trim_ms * 1000) {
+            continue;
+        }
+        for (Columns* c : {&cols[r.id], r.id <= SYSID_RIGHT ? &drive : nullptr}) {
+            if (!c) continue;
+            c->sign.push_back(s.velocity > 0 ? 1.0f : -1.0f);
+            c->vel.push_back(s.velocity);
+            c->acc.push_back(accel[i]);
+            c->volts.push_back(s.voltage);
+        }
+    }
+
+    Fit fits[SYSID_MECHANISMS];
+    for (int m = 0; m < SYSID_MECHANISMS; m++) {
+        fits[m] = fit(cols[m]);
+        print_fit(SYSID_MECHANISM_NAMES[m], fits[m], m <= SYSID_RIGHT ? "in" : "count");
+    }
+    Fit both = fit(drive);
+    print_fit("drive", both, "in");
+
+    double width = 0;
+    if (omega.size() >= 10) {
+        width = dot(diff.data(), omega.data(), diff.size()) / dot(omega.data(), omega.data(), omega.size());
+        std::printf("track width  %.2f in effective  (%zu)\n", width, omega.size());
+    } else {
+        std::printf("track width  not enough turning samples (%zu)\n", omega.size());
+    }
+
+    // Ready to paste over the hand-set values
+    if (both.ok) {
+        std::printf("\nconstexpr FfGains DRIVE_FF = {.ks = %.0f, .kv = %.1ff, .ka = %.2ff};\n", both.k[0],
+                    both.k[1], both.k[2]);
+    }
+    if (width > 0) {
+        std::printf("#define TRACK_WIDTH %.2f\n", width);
+    }
+    return 0;
+}
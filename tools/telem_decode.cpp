@@ -0,0 +1,762 @@
+// Host decoder for the robot's binary telemetry logs (telemetry_record.h).
+//
+// Memory-maps every log given, splits them on block boundaries into chunks
+// and decodes the chunks on all cores. Each chunk is decoded into its own
+// columns and summary accumulators, which are written out and merged in file
+// order, so the output is the same for any thread count and memory stays
+// bounded however large the archive is.
+//
+// Build:  g++ -std=c++20 -O2 -pthread -Iinclude tools/telem_decode.cpp -o telem_decode
+// Usage:  ./telem_decode [--csv DIR] [--columns DIR] [--threads N] LOG.bin...
+//
+// --csv writes motor.csv, pose.csv, loop.csv and stats.csv to DIR.
+// --columns writes one flat little-endian array per column instead, named
+// <table>.<column>.<type> (e.g. motor.current.i32), for numpy.fromfile() or
+// a columnar store. Times are microseconds since the file's header record.
+//
+// The summary always goes to stdout: current percentiles and temperature
+// trend per motor, period jitter per scheduler loop, the log's own drop
+// counters, and each tick stage's p99 latency across the logs.
+
+#include "telemetry_record.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+constexpr std::size_t RECORD = sizeof(TelemetryRecord);
+constexpr std::size_t BLOCK_RECORDS = TELEM_BLOCK_BYTES / RECORD;
+constexpr std::size_t CHUNK_BLOCKS = 4096;          // 16 MB per work item
+
+constexpr int PORTS = 22;                           // by |port|, 1-21
+constexpr int LOOPS = 16;
+constexpr int CURRENT_BINS = 5001;                  // 1 mA, last bin is 5 A and up
+constexpr int PERIOD_BIN_US = 10;
+constexpr int PERIOD_BINS = 5001;                   // up to 50 ms
+constexpr int MAX_MINUTES = 240;
+
+struct Input {
+    const char* path;
+    const std::uint8_t* data = nullptr;
+    std::size_t records = 0;
+    std::uint64_t start_us = 0;
+};
+
+struct Chunk {
+    int file;
+    std::size_t first;                              // record range [first, last)
+    std::size_t last;
+};
+
+// Summary accumulators, merged from every chunk
+struct MotorAcc {
+    std::int8_t port = 0;
+    std::uint64_t n = 0;
+    double current_sum = 0;
+    std::uint32_t current_hist[CURRENT_BINS] = {};
+    float temp_max = -1000;
+    double temp_min_sum[MAX_MINUTES] = {};          // per minute since file start
+    std::uint32_t temp_min_n[MAX_MINUTES] = {};
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;        // temperature against minutes
+
+    void merge(const MotorAcc& o) {
+        if (!o.n) {
+            return;
+        }
+        port = o.port;
+        n += o.n;
+        current_sum += o.current_sum;
+        for (int i = 0; i < CURRENT_BINS; i++) current_hist[i] += o.current_hist[i];
+        temp_max = std::max(temp_max, o.temp_max);
+        for (int i = 0; i < MAX_MINUTES; i++) {
+            temp_min_sum[i] += o.temp_min_sum[i];
+            temp_min_n[i] += o.temp_min_n[i];
+        }
+        sx += o.sx;
+        sy += o.sy;
+        sxx += o.sxx;
+        sxy += o.sxy;
+    }
+};
+
+struct LoopAcc {
+    std::uint64_t n = 0;
+    std::uint32_t period_hist[PERIOD_BINS] = {};
+    std::uint32_t max_exec_us = 0;
+
+    // The records carry a running total that restarts with the scheduler,
+    // so overruns are counted as the increases seen between records
+    std::uint64_t overruns = 0;
+    std::uint32_t first_total = 0;
+    std::uint32_t last_total = 0;
+
+    void add_total(std::uint32_t total) {
+        if (n == 1) {
+            first_total = total;
+        } else if (total > last_total) {
+            overruns += total - last_total;
+        }
+        last_total = total;
+    }
+
+    void merge(const LoopAcc& o) {
+        if (!o.n) {
+            return;
+        }
+        if (n && o.first_total > last_total) {
+            overruns += o.first_total - last_total;
+        }
+        if (!n) {
+            first_total = o.first_total;
+        }
+        n += o.n;
+        for (int i = 0; i < PERIOD_BINS; i++) period_hist[i] += o.period_hist[i];
+        max_exec_us = std::max(max_exec_us, o.max_exec_us);
+        overruns += o.overruns;
+        last_total = o.last_total;
+    }
+};
+
+struct Summary {
+    std::uint64_t records = 0;
+    std::uint64_t poses = 0;
+    std::uint64_t dropped = 0;                      // from each file's last stats record
+    std::uint32_t max_write_us = 0;
+    std::uint32_t high_water = 0;
+    std::uint32_t write_errors = 0;
+    MotorAcc motor[PORTS];
+    LoopAcc loop[LOOPS];
+    char loop_name[LOOPS][25] = {};
+};
+
+// A growable set of flat columns for one table
+struct Columns {
+    struct Col {
+        const char* name;
+        const char* type;
+        std::size_t size;
+        std::vector<std::uint8_t> data;
+    };
+    std::vector<Col> cols;
+
+    void add(const char* name, const char* type, std::size_t size) {
+        cols.push_back({name, type, size, {}});
+    }
+
+    void reserve(std::size_t rows) {
+        for (Col& c : cols) c.data.reserve(rows * c.size);
+    }
+
+    template <typename T>
+    void put(int i, T v) {
+        std::uint8_t* p = reinterpret_cast<std::uint8_t*>(&v);
+        cols[i].data.insert(cols[i].data.end(), p, p + sizeof(T));
+    }
+};
+
+enum Table { MOTOR, POSE, LOOP, STATS, PROFILE, TABLES };
+static const char* TABLE_NAMES[TABLES] = {"motor", "pose", "loop", "stats", "profile"};
+
+static void make_columns(Columns (&t)[TABLES]) {
+    t[MOTOR].add("file", "u16", 2);
+    t[MOTOR].add("t_us", "u64", 8);
+    t[MOTOR].add("port", "i8", 1);
+    t[MOTOR].add("position", "f32", 4);
+    t[MOTOR].add("velocity", "f32", 4);
+    t[MOTOR].add("current", "i32", 4);
+    t[MOTOR].add("voltage", "i32", 4);
+    t[MOTOR].add("temperature", "f32", 4);
+    t[MOTOR].add("flags", "u32", 4);
+
+    t[POSE].add("file", "u16", 2);
+    t[POSE].add("t_us", "u64", 8);
+    t[POSE].add("source", "u8", 1);
+    t[POSE].add("x", "f32", 4);
+    t[POSE].add("y", "f32", 4);
+    t[POSE].add("theta", "f32", 4);
+    t[POSE].add("v", "f32", 4);
+    t[POSE].add("omega", "f32", 4);
+    t[POSE].add("pose_ms", "u32", 4);
+
+    t[LOOP].add("file", "u16", 2);
+    t[LOOP].add("t_us", "u64", 8);
+    t[LOOP].add("loop", "u8", 1);
+    t[LOOP].add("period_us", "u32", 4);
+    t[LOOP].add("exec_us", "u32", 4);
+    t[LOOP].add("overruns", "u32", 4);
+
+    t[STATS].add("file", "u16", 2);
+    t[STATS].add("t_us", "u64", 8);
+    t[STATS].add("written", "u32", 4);
+    t[STATS].add("dropped", "u32", 4);
+    t[STATS].add("high_water", "u32", 4);
+    t[STATS].add("blocks", "u32", 4);
+    t[STATS].add("write_errors", "u32", 4);
+    t[STATS].add("max_write_us", "u32", 4);
+
+    t[PROFILE].add("file", "u16", 2);
+    t[PROFILE].add("t_us", "u64", 8);
+    t[PROFILE].add("stage", "u8", 1);
+    t[PROFILE].add("count", "u32", 4);
+    t[PROFILE].add("p50_us", "u32", 4);
+    t[PROFILE].add("p90_us", "u32", 4);
+    t[PROFILE].add("p99_us", "u32", 4);
+    t[PROFILE].add("p999_us", "u32", 4);
+    t[PROFILE].add("max_us", "u32", 4);
+}
+
+// What one chunk decodes to
+struct ChunkOut {
+    Summary sum;
+    Columns table[TABLES];
+    std::string csv[TABLES];
+    bool have_stats = false;
+    TelemetryRecord last_stats = {};
+    TelemetryRecord last_profile[NUM_STAGES] = {};  // type 0 until one is seen
+};
+
+// Appends a CSV row without going through printf
+struct Row {
+    std::string& s;
+    bool first = true;
+
+    template <typename T>
+    Row& operator<<(T v) {
+        if (!first) s += ',';
+        first = false;
+        char buf[32];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        s.append(buf, r.ptr);
+        return *this;
+    }
+
+    ~Row() {
+        s += '\n';
+    }
+};
+
+static std::uint64_t record_us(const TelemetryRecord& r) {
+    return ((std::uint64_t)r.time_hi << 32) | r.time_us;
+}
+
+static void decode(const Input& in, const Chunk& c, bool csv, bool columns, ChunkOut& out) {
+    const TelemetryRecord* recs = reinterpret_cast<const TelemetryRecord*>(in.data);
+    Summary& s = out.sum;
+
+    // Counting first lets every column be sized once
+    std::size_t count[TABLES] = {};
+    for (std::size_t i = c.first; i < c.last; i++) {
+        std::uint8_t t = recs[i].type;
+        count[MOTOR] += t == TELEM_MOTOR;
+        count[POSE] += t == TELEM_POSE;
+        count[LOOP] += t == TELEM_LOOP;
+        count[STATS] += t == TELEM_STATS;
+        count[PROFILE] += t == TELEM_PROFILE;
+    }
+    if (columns) {
+        make_columns(out.table);
+        for (int t = 0; t < TABLES; t++) out.table[t].reserve(count[t]);
+    }
+    if (csv) {
+        for (int t = 0; t < TABLES; t++) out.csv[t].reserve(count[t] * 64);
+    }
+
+    std::uint16_t file = c.file;
+    for (std::size_t i = c.first; i < c.last; i++) {
+        const TelemetryRecord& r = recs[i];
+        std::uint64_t t = record_us(r) - in.start_us;
+
+        switch (r.type) {
+            case TELEM_MOTOR: {
+                const auto& m = r.motor;
+                std::int8_t port = (std::int8_t)r.id;
+                MotorAcc& a = s.motor[std::abs(port) % PORTS];
+                a.port = port;
+                a.n++;
+                int amps = std::min(std::abs(m.current), CURRENT_BINS - 1);
+                a.current_hist[amps]++;
+                a.current_sum += std::abs(m.current);
+                a.temp_max = std::max(a.temp_max, m.temperature);
+                double min = t / 60e6;
+                int bin = std::min((int)min, MAX_MINUTES - 1);
+                a.temp_min_sum[bin] += m.temperature;
+                a.temp_min_n[bin]++;
+                a.sx += min;
+                a.sy += m.temperature;
+                a.sxx += min * min;
+                a.sxy += min * m.temperature;
+
+                if (columns) {
+                    Columns& o = out.table[MOTOR];
+                    o.put(0, file);
+                    o.put(1, t);
+                    o.put(2, port);
+                    o.put(3, m.position);
+                    o.put(4, m.velocity);
+                    o.put(5, m.current);
+                    o.put(6, m.voltage);
+                    o.put(7, m.temperature);
+                    o.put(8, m.flags);
+                }
+                if (csv) {
+                    Row(out.csv[MOTOR]) << file << t << (int)port << m.position << m.velocity << m.current
+                                        << m.voltage << m.temperature << m.flags;
+                }
+                break;
+            }
+
+            case TELEM_POSE: {
+                const auto& p = r.pose;
+                s.poses++;
+                if (columns) {
+                    Columns& o = out.table[POSE];
+                    o.put(0, file);
+                    o.put(1, t);
+                    o.put(2, r.id);
+                    o.put(3, p.x);
+                    o.put(4, p.y);
+                    o.put(5, p.theta);
+                    o.put(6, p.v);
+                    o.put(7, p.omega);
+                    o.put(8, p.time_ms);
+                }
+                if (csv) {
+                    Row(out.csv[POSE]) << file << t << (int)r.id << p.x << p.y << p.theta << p.v << p.omega
+                                       << p.time_ms;
+                }
+                break;
+            }
+
+            case TELEM_LOOP: {
+                const auto& l = r.loop;
+                if (r.id < LOOPS) {
+                    LoopAcc& a = s.loop[r.id];
+                    a.n++;
+                    if (l.period_us) {
+                        a.period_hist[std::min<std::uint32_t>(l.period_us / PERIOD_BIN_US, PERIOD_BINS - 1)]++;
+                    }
+                    a.max_exec_us = std::max(a.max_exec_us, l.exec_us);
+                    a.add_total(l.overruns);
+                }
+                if (columns) {
+                    Columns& o = out.table[LOOP];
+                    o.put(0, file);
+                    o.put(1, t);
+                    o.put(2, r.id);
+                    o.put(3, l.period_us);
+                    o.put(4, l.exec_us);
+                    o.put(5, l.overruns);
+                }
+                if (csv) {
+                    Row(out.csv[LOOP]) << file << t << (int)r.id << l.period_us << l.exec_us << l.overruns;
+                }
+                break;
+            }
+
+            case TELEM_STATS: {
+                const auto& st = r.stats;
+                out.have_stats = true;
+                out.last_stats = r;
+                if (columns) {
+                    Columns& o = out.table[STATS];
+                    o.put(0, file);
+                    o.put(1, t);
+                    o.put(2, st.written);
+                    o.put(3, st.dropped);
+                    o.put(4, st.high_water);
+                    o.put(5, st.blocks);
+                    o.put(6, st.write_errors);
+                    o.put(7, st.max_write_us);
+                }
+                if (csv) {
+                    Row(out.csv[STATS]) << file << t << st.written << st.dropped << st.high_water << st.blocks
+                                        << st.write_errors << st.max_write_us;
+                }
+                break;
+            }
+
+            case TELEM_PROFILE: {
+                const auto& pr = r.profile;
+                if (r.id < NUM_STAGES) {
+                    out.last_profile[r.id] = r;
+                }
+                if (columns) {
+                    Columns& o = out.table[PROFILE];
+                    o.put(0, file);
+                    o.put(1, t);
+                    o.put(2, r.id);
+                    o.put(3, pr.count);
+                    o.put(4, pr.p50_us);
+                    o.put(5, pr.p90_us);
+                    o.put(6, pr.p99_us);
+                    o.put(7, pr.p999_us);
+                    o.put(8, pr.max_us);
+                }
+                if (csv) {
+                    Row(out.csv[PROFILE]) << file << t << (int)r.id << pr.count << pr.p50_us << pr.p90_us
+                                          << pr.p99_us << pr.p999_us << pr.max_us;
+                }
+                break;
+            }
+
+            case TELEM_NAME:
+                if (r.id < LOOPS) {
+                    std::memcpy(s.loop_name[r.id], r.name.text, sizeof(r.name.text));
+                }
+                break;
+
+            default:
+                continue;
+        }
+        s.records++;
+    }
+}
+
+static bool open_input(Input& in) {
+    int fd = open(in.path, O_RDONLY);
+    if (fd < 0) {
+        std::perror(in.path);
+        return false;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    std::size_t size = st.st_size;
+
+    if (size >= RECORD) {
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, size, MADV_SEQUENTIAL);
+            in.data = static_cast<const std::uint8_t*>(p);
+        }
+    }
+    close(fd);
+
+    // A file cut short by a power loss just loses its partial record
+    const TelemetryRecord* h = reinterpret_cast<const TelemetryRecord*>(in.data);
+    if (!h || h->type != TELEM_HEADER || std::memcmp(h->header.magic, "VXTL", 4) != 0 ||
+        h->header.version != TELEM_VERSION || h->header.record_bytes != RECORD ||
+        h->header.block_bytes != TELEM_BLOCK_BYTES) {
+        std::fprintf(stderr, "%s: not a version %d telemetry log, skipped\n", in.path, TELEM_VERSION);
+        return false;
+    }
+    in.records = size / RECORD;
+    in.start_us = record_us(*h);
+    return true;
+}
+
+static void write_all(FILE* f, const void* p, std::size_t n) {
+    if (n && std::fwrite(p, 1, n, f) != n) {
+        std::perror("write");
+        std::exit(1);
+    }
+}
+
+static const char* CSV_HEADERS[TABLES] = {
+    "file,t_us,port,position,velocity,current,voltage,temperature,flags\n",
+    "file,t_us,source,x,y,theta,v,omega,pose_ms\n",
+    "file,t_us,loop,period_us,exec_us,overruns\n",
+    "file,t_us,written,dropped,high_water,blocks,write_errors,max_write_us\n",
+    "file,t_us,stage,count,p50_us,p90_us,p99_us,p999_us,max_us\n",
+};
+
+// Value below which a fraction q of the histogram lies
+static int percentile(const std::uint32_t* hist, int bins, std::uint64_t n, double q) {
+    std::uint64_t want = (std::uint64_t)std::ceil(q * n);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < bins; i++) {
+        seen += hist[i];
+        if (seen >= want && seen) return i;
+    }
+    return bins - 1;
+}
+
+// Tick stage latency as each log last reported it, so a regression between
+// logs shows as a file whose p99 stands out
+static void print_profiles(const std::vector<Input>& inputs,
+                           const std::vector<std::array<TelemetryRecord, NUM_STAGES>>& last) {
+    bool any = false;
+    for (int st = 0; st < NUM_STAGES; st++) {
+        std::vector<std::uint32_t> p99;
+        int worst = -1;
+        std::uint32_t worst_max = 0;
+        for (std::size_t f = 0; f < last.size(); f++) {
+            const TelemetryRecord& r = last[f][st];
+            if (r.type != TELEM_PROFILE || !r.profile.count) continue;
+            p99.push_back(r.profile.p99_us);
+            if (worst < 0 || r.profile.p99_us > last[worst][st].profile.p99_us) worst = f;
+            worst_max = std::max(worst_max, r.profile.max_us);
+        }
+        if (p99.empty()) continue;
+
+        if (!any) {
+            std::printf("\ntick stage latency, us   logs  median p99  worst p99  worst max  worst log\n");
+            any = true;
+        }
+        std::nth_element(p99.begin(), p99.begin() + p99.size() / 2, p99.end());
+        std::printf("%-24s %5zu %11u %10u %10u  %s\n", TICK_STAGE_NAMES[st], p99.size(), p99[p99.size() / 2],
+                    last[worst][st].profile.p99_us, worst_max, inputs[worst].path);
+    }
+}
+
+static void print_summary(const Summary& s, int files, std::size_t bytes, double seconds) {
+    std::printf("%d files, %.1f MB, %llu records decoded in %.3f s (%.0f MB/s)\n", files, bytes / 1e6,
+                (unsigned long long)s.records, seconds, bytes / 1e6 / seconds);
+    std::printf("log: %llu records dropped, ring high water %u, slowest block write %u us, %u write errors\n\n",
+                (unsigned long long)s.dropped, s.high_water, s.max_write_us, s.write_errors);
+
+    std::printf("motor  samples   mean mA    p50    p90    p99    max   max C  C/min\n");
+    for (int p = 1; p < PORTS; p++) {
+        const MotorAcc& a = s.motor[p];
+        if (!a.n) continue;
+        double denom = a.n * a.sxx - a.sx * a.sx;
+        double slope = denom > 1e-9 ? (a.n * a.sxy - a.sx * a.sy) / denom : 0;
+        std::printf("%5d %9llu %9.0f %6d %6d %6d %6d %7.1f %6.2f\n", a.port, (unsigned long long)a.n,
+                    a.current_sum / a.n, percentile(a.current_hist, CURRENT_BINS, a.n, 0.5),
+                    percentile(a.current_hist, CURRENT_BINS, a.n, 0.9),
+                    percentile(a.current_hist, CURRENT_BINS, a.n, 0.99),
+                    percentile(a.current_hist, CURRENT_BINS, a.n, 1.0), a.temp_max, slope);
+    }
+
+    // Mean temperature for each minute since the start of a file
+    int minutes = 0;
+    for (int p = 1; p < PORTS; p++) {
+        for (int m = 0; m < MAX_MINUTES; m++) {
+            if (s.motor[p].temp_min_n[m]) minutes = std::max(minutes, m + 1);
+        }
+    }
+    if (minutes > 0) {
+        std::printf("\ntemperature trend, mean C per minute of each log\n  min");
+        for (int p = 1; p < PORTS; p++) {
+            if (s.motor[p].n) std::printf(" %5d", s.motor[p].port);
+        }
+        std::printf("\n");
+        for (int m = 0; m < minutes; m++) {
+            std::printf("%5d", m);
+            for (int p = 1; p < PORTS; p++) {
+                const MotorAcc& a = s.motor[p];
+                if (!a.n) continue;
+                if (a.temp_min_n[m]) std::printf(" %5.1f", a.temp_min_sum[m] / a.temp_min_n[m]);
+                else std::printf("     -");
+            }
+            std::printf("\n");
+        }
+    }
+
+    for (int l = 0; l < LOOPS; l++) {
+        const LoopAcc& a = s.loop[l];
+        std::uint64_t n = 0;
+        for (int i = 0; i < PERIOD_BINS; i++) n += a.period_hist[i];
+        if (!n) continue;
+
+        // Nominal period is the median, jitter is the distance from it
+        int mid = percentile(a.period_hist, PERIOD_BINS, n, 0.5);
+        int lo = percentile(a.period_hist, PERIOD_BINS, n, 0.001);
+        int hi = percentile(a.period_hist, PERIOD_BINS, n, 0.999);
+        int max = percentile(a.period_hist, PERIOD_BINS, n, 1.0);
+        std::printf("\nloop %d %s: %llu runs, period %d us, p0.1 %+d us, p99.9 %+d us, max %+d us, "
+                    "max exec %u us, %llu overruns\n",
+                    l, s.loop_name[l][0] ? s.loop_name[l] : "?", (unsigned long long)a.n, mid * PERIOD_BIN_US,
+                    (lo - mid) * PERIOD_BIN_US, (hi - mid) * PERIOD_BIN_US, (max - mid) * PERIOD_BIN_US,
+                    a.max_exec_us, (unsigned long long)a.overruns);
+
+        // Jitter histogram, 100 us buckets around the nominal period
+        const int bucket = 100 / PERIOD_BIN_US;
+        std::uint64_t peak = 1;
+        std::uint64_t bins[21] = {};
+        for (int i = 0; i < PERIOD_BINS; i++) {
+            int b = (int)std::lround((double)(i - mid) / bucket) + 10;
+            bins[std::clamp(b, 0, 20)] += a.period_hist[i];
+        }
+        for (std::uint64_t b : bins) peak = std::max(peak, b);
+        for (int b = 0; b < 21; b++) {
+            if (!bins[b]) continue;
+            int bar = (int)(50 * bins[b] / peak);
+            std::printf("  %s%+5d us %10llu %.*s\n", b == 0 ? "<=" : b == 20 ? ">=" : "  ", (b - 10) * 100,
+                        (unsigned long long)bins[b], std::max(bar, 1),
+                        "##################################################");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* csv_dir = nullptr;
+    const char* col_dir = nullptr;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Input> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--csv") && i + 1 < argc) {
+            csv_dir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--columns") && i + 1 < argc) {
+            col_dir = argv[++i];
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "usage: telem_decode [--csv DIR] [--columns DIR] [--threads N] LOG.bin...\n");
+            return 2;
+        } else {
+            inputs.push_back({argv[i]});
+        }
+    }
+    if (inputs.empty()) {
+        std::fprintf(stderr, "usage: telem_decode [--csv DIR] [--columns DIR] [--threads N] LOG.bin...\n");
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Whole blocks per chunk, so no record or padding run is split
+    std::vector<Chunk> chunks;
+    std::size_t bytes = 0;
+    int files = 0;
+    for (int f = 0; f < (int)inputs.size(); f++) {
+        if (!open_input(inputs[f])) continue;
+        files++;
+        bytes += inputs[f].records * RECORD;
+        for (std::size_t r = 0; r < inputs[f].records; r += CHUNK_BLOCKS * BLOCK_RECORDS) {
+            chunks.push_back({f, r, std::min(inputs[f].records, r + CHUNK_BLOCKS * BLOCK_RECORDS)});
+        }
+    }
+
+    FILE* out[TABLES] = {};
+    std::vector<FILE*> col_out[TABLES];
+    if (csv_dir) {
+        for (int t = 0; t < TABLES; t++) {
+            std::string path = std::string(csv_dir) + "/" + TABLE_NAMES[t] + ".csv";
+            if (!(out[t] = std::fopen(path.c_str(), "w"))) {
+                std::perror(path.c_str());
+                return 1;
+            }
+            std::fputs(CSV_HEADERS[t], out[t]);
+        }
+    }
+    if (col_dir) {
+        Columns names[TABLES];
+        make_columns(names);
+        for (int t = 0; t < TABLES; t++) {
+            for (const Columns::Col& c : names[t].cols) {
+                std::string path = std::string(col_dir) + "/" + TABLE_NAMES[t] + "." + c.name + "." + c.type;
+                FILE* f = std::fopen(path.c_str(), "wb");
+                if (!f) {
+                    std::perror(path.c_str());
+                    return 1;
+                }
+                col_out[t].push_back(f);
+            }
+        }
+    }
+
+    // Workers decode ahead of the writer by at most a few chunks each
+    std::mutex m;
+    std::condition_variable cv;
+    std::size_t next = 0;
+    std::size_t consumed = 0;
+    const std::size_t window = 2 * threads;
+    std::vector<std::unique_ptr<ChunkOut>> done(chunks.size());
+
+    auto worker = [&]() {
+        while (true) {
+            std::size_t idx;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return next >= chunks.size() || next < consumed + window; });
+                if (next >= chunks.size()) return;
+                idx = next++;
+            }
+            auto o = std::make_unique<ChunkOut>();
+            decode(inputs[chunks[idx].file], chunks[idx], csv_dir, col_dir, *o);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                done[idx] = std::move(o);
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) pool.emplace_back(worker);
+
+    auto sum = std::make_unique<Summary>();
+    std::vector<TelemetryRecord> file_stats(inputs.size());
+    std::vector<bool> file_has_stats(inputs.size());
+    std::vector<std::array<TelemetryRecord, NUM_STAGES>> file_profile(inputs.size());
+
+    for (std::size_t i = 0; i < chunks.size(); i++) {
+        std::unique_ptr<ChunkOut> o;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return done[i] != nullptr; });
+            o = std::move(done[i]);
+        }
+
+        for (int t = 0; t < TABLES; t++) {
+            if (csv_dir) write_all(out[t], o->csv[t].data(), o->csv[t].size());
+            if (col_dir) {
+                for (std::size_t c = 0; c < o->table[t].cols.size(); c++) {
+                    const auto& d = o->table[t].cols[c].data;
+                    write_all(col_out[t][c], d.data(), d.size());
+                }
+            }
+        }
+
+        Summary& s = *sum;
+        const Summary& c = o->sum;
+        s.records += c.records;
+        s.poses += c.poses;
+        for (int p = 0; p < PORTS; p++) s.motor[p].merge(c.motor[p]);
+        for (int l = 0; l < LOOPS; l++) {
+            s.loop[l].merge(c.loop[l]);
+            if (c.loop_name[l][0]) std::memcpy(s.loop_name[l], c.loop_name[l], sizeof(s.loop_name[l]));
+        }
+        if (o->have_stats) {
+            file_stats[chunks[i].file] = o->last_stats;
+            file_has_stats[chunks[i].file] = true;
+        }
+        for (int st = 0; st < NUM_STAGES; st++) {
+            if (o->last_profile[st].type == TELEM_PROFILE) file_profile[chunks[i].file][st] = o->last_profile[st];
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            consumed = i + 1;
+        }
+        cv.notify_all();
+    }
+    for (std::thread& t : pool) t.join();
+
+    // The log's counters are running totals, so each file's last stats
+    // record covers the whole file
+    for (std::size_t f = 0; f < inputs.size(); f++) {
+        if (!file_has_stats[f]) continue;
+        const auto& st = file_stats[f].stats;
+        sum->dropped += st.dropped;
+        sum->high_water = std::max(sum->high_water, st.high_water);
+        sum->max_write_us = std::max(sum->max_write_us, st.max_write_us);
+        sum->write_errors += st.write_errors;
+    }
+
+    for (int t = 0; t < TABLES; t++) {
+        if (out[t]) std::fclose(out[t]);
+        for (FILE* f : col_out[t]) std::fclose(f);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    print_summary(*sum, files, bytes, seconds);
+    print_profiles(inputs, file_profile);
+    return 0;
+}
@@ -0,0 +1,629 @@
+// Simulator-driven tuner for the drive's gains and profile limits.
+//
+// Runs the autonomous route (the plans baked into routes_baked.h, as
+// routine() in auton.cpp drives them) through the drivetrain's move, turn and
+// follow control laws (drive_control.h) against the simulator's chassis and
+// motor models (sim/physics.h), and searches the gains and limits in
+// drive_gains.h by CMA-ES for the lowest
+//
+//   cost = seconds + W_ERR * final error (in) + W_AMPS * peak supply current (A)
+//
+// averaged over a fixed set of perturbed robots (mass, friction, battery,
+// placement) so the answer doesn't only suit one model. robot_sim can't do
+// this, its world and kernel are one per process. Each run here is a pure
+// function of its parameters and robot, on the stack with no allocation, so
+// a generation's runs are spread over every core and the search finds the
+// same answer with any thread count.
+//
+// Build:  g++ -std=c++20 -O2 -pthread -Iinclude -Isim tools/tune_gains.cpp -o tune_gains
+// Usage:  ./tune_gains [--generations N] [--population N] [--robots N] [--threads N]
+//                      [--seed N] [--w-err X] [--w-amps X]
+//
+// The loops below only add the clock and the plant around drive_control.h,
+// as drivetrain.cpp adds the scheduler and the motors. Feedforward is
+// DRIVE_FF as it stands, fit it with sysid_fit first. The controllers see the
+// true pose and wheel speeds, standing in for the localizer and the motion
+// estimator. Prints the tuned values ready to paste over drive_gains.h,
+// nothing is changed on the robot until they are (then re-run bake_routes).
+
+#include "drive_control.h"
+#include "routes_baked.h"
+#include "sim.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+constexpr float M_PER_IN = 0.0254f;
+constexpr float DRIVE_CURRENT_LIMIT = 2.5f;         // A per motor
+constexpr int SIDE_MOTORS = 3;
+constexpr int PHYS_PER_TICK = MOVE_PERIOD_MS;       // 1 ms physics steps
+constexpr float PHYS_DT = 0.001f;
+constexpr float BOUND_PENALTY = 100;                // per unit squared outside the box
+constexpr float FAILED_COST = 1e6f;
+
+// Where routine() leaves the robot: at the loader, backed up 6 in (it faces
+// +y there)
+constexpr float FINAL_MOVE = -6;
+constexpr float TARGET_X = LOADER_X;
+constexpr float TARGET_Y = LOADER_Y + FINAL_MOVE;
+constexpr float TARGET_HEADING = LOADER_HEADING;
+constexpr std::uint32_t LOADER_CAP_MS = 4000;
+
+// SEARCH SPACE, log scaled between the bounds
+enum Param {
+    P_DRIVE_KP,
+    P_HEADING_KP,
+    P_TURN_KP,
+    P_PURSUIT_KP,
+    P_DRIVE_VEL,
+    P_DRIVE_ACCEL,
+    P_DRIVE_JERK,
+    P_TURN_VEL,
+    P_TURN_ACCEL,
+    P_TURN_JERK,
+    PARAMS,
+};
+
+struct ParamInfo {
+    const char* name;
+    float lo, hi, now;
+};
+
+// The drive tops out near 76 in/s and 12 rad/s unloaded, the limits leave
+// the feedforward some headroom
+constexpr ParamInfo INFO[PARAMS] = {
+    {"DRIVE_PID.kp", 20, 5000, DRIVE_PID.kp},
+    {"HEADING_PID.kp", 200, 50000, HEADING_PID.kp},
+    {"TURN_PID.kp", 200, 50000, TURN_PID.kp},
+    {"PURSUIT_VEL_PID.kp", 1, 500, PURSUIT_VEL_PID.kp},
+    {"DRIVE_MAX_VEL", 20, 70, DRIVE_MAX_VEL},
+    {"DRIVE_MAX_ACCEL", 30, 600, DRIVE_MAX_ACCEL},
+    {"DRIVE_MAX_JERK", 100, 10000, DRIVE_MAX_JERK},
+    {"TURN_MAX_VEL", 1, 11, TURN_MAX_VEL},
+    {"TURN_MAX_ACCEL", 4, 150, TURN_MAX_ACCEL},
+    {"TURN_MAX_JERK", 20, 3000, TURN_MAX_JERK},
+};
+
+// splitmix64, the same stream on every platform unlike <random>'s
+// distributions
+struct Rng {
+    std::uint64_t s;
+
+    std::uint64_t next() {
+        std::uint64_t z = (s += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    double gauss() {
+        double u = uniform();
+        double v = uniform();
+        return std::sqrt(-2 * std::log(u > 0 ? u : 1e-300)) * std::cos(2 * M_PI * v);
+    }
+};
+
+// One perturbed robot
+struct Variant {
+    float mass, inertia, roll_drag, static_friction;
+    float battery;          // V the motors can reach
+    float dx, dy, dtheta;   // placement error, in and rad
+};
+
+// The gains and limits of one candidate
+struct Tuning {
+    PidGains drive, heading, turn, pursuit;
+    float drive_vel, drive_accel, drive_jerk;
+    float turn_vel, turn_accel, turn_jerk;
+};
+
+struct Result {
+    float seconds;
+    float error;            // in from the target, plus heading error as arc at TRACK_WIDTH/2
+    float peak_amps;
+    bool ok;
+};
+
+static float clamp01(double u) {
+    return u < 0 ? 0 : u > 1 ? 1 : (float)u;
+}
+
+static float param_value(int i, double u) {
+    return INFO[i].lo * std::pow(INFO[i].hi / INFO[i].lo, clamp01(u));
+}
+
+static double param_unit(int i, float v) {
+    return std::log(v / INFO[i].lo) / std::log(INFO[i].hi / INFO[i].lo);
+}
+
+static Tuning tuning(const double* u) {
+    Tuning t;
+    t.drive = DRIVE_PID;
+    t.heading = HEADING_PID;
+    t.turn = TURN_PID;
+    t.pursuit = PURSUIT_VEL_PID;
+    t.drive.kp = param_value(P_DRIVE_KP, u[P_DRIVE_KP]);
+    t.heading.kp = param_value(P_HEADING_KP, u[P_HEADING_KP]);
+    t.turn.kp = param_value(P_TURN_KP, u[P_TURN_KP]);
+    t.pursuit.kp = param_value(P_PURSUIT_KP, u[P_PURSUIT_KP]);
+    t.drive_vel = param_value(P_DRIVE_VEL, u[P_DRIVE_VEL]);
+    t.drive_accel = param_value(P_DRIVE_ACCEL, u[P_DRIVE_ACCEL]);
+    t.drive_jerk = param_value(P_DRIVE_JERK, u[P_DRIVE_JERK]);
+    t.turn_vel = param_value(P_TURN_VEL, u[P_TURN_VEL]);
+    t.turn_accel = param_value(P_TURN_ACCEL, u[P_TURN_ACCEL]);
+    t.turn_jerk = param_value(P_TURN_JERK, u[P_TURN_JERK]);
+    return t;
+}
+
+// The chassis with its six motors, stepped a command tick at a time
+struct Robot {
+    sim::DriveModel drive;
+    sim::DcMotor motor;     // blue, every drive motor alike
+    float battery = 12;
+    float mv_left = 0;
+    float mv_right = 0;
+    std::uint32_t ms = 0;
+    float peak_amps = 0;
+
+    Pose pose() const {
+        return {drive.x / M_PER_IN, drive.y / M_PER_IN, drive.theta, drive.v / M_PER_IN, drive.omega, ms, 0};
+    }
+
+    float left() const {
+        return drive.left_speed() / M_PER_IN;
+    }
+
+    float right() const {
+        return drive.right_speed() / M_PER_IN;
+    }
+
+    void drive_ff(float vl, float al, float fbl, float vr, float ar, float fbr) {
+        mv_left = Feedforward<DRIVE_FF>::calc(vl, al) + fbl;
+        mv_right = Feedforward<DRIVE_FF>::calc(vr, ar) + fbr;
+    }
+
+    // As World::step, for the drive motors alone
+    void tick() {
+        float vl = std::fmax(-battery, std::fmin(battery, mv_left / 1000));
+        float vr = std::fmax(-battery, std::fmin(battery, mv_right / 1000));
+        for (int k = 0; k < PHYS_PER_TICK; k++) {
+            float wl = drive.motor_speed(drive.left_speed());
+            float wr = drive.motor_speed(drive.right_speed());
+            float il = motor.current(vl, wl, DRIVE_CURRENT_LIMIT);
+            float ir = motor.current(vr, wr, DRIVE_CURRENT_LIMIT);
+            float supply = SIDE_MOTORS * (std::fabs(il * vl) + std::fabs(ir * vr)) / motor.nominal_v;
+            if (supply > sim::SUPPLY_LIMIT_A) {
+                il *= sim::SUPPLY_LIMIT_A / supply;
+                ir *= sim::SUPPLY_LIMIT_A / supply;
+                supply = sim::SUPPLY_LIMIT_A;
+            }
+            peak_amps = std::fmax(peak_amps, supply);
+            drive.step(SIDE_MOTORS * motor.torque(il, wl), SIDE_MOTORS * motor.torque(ir, wr), PHYS_DT);
+        }
+        ms += MOVE_PERIOD_MS;
+    }
+
+    void stop() {
+        mv_left = 0;
+        mv_right = 0;
+    }
+};
+
+// drivetrain::move
+static void move(Robot& r, const Tuning& g, float inches) {
+    Profile prof = Profile::s_curve(inches, g.drive_vel, g.drive_accel, g.drive_jerk);
+    MoveControl ctl(prof, r.pose(), RuntimePid(g.drive), RuntimePid(g.heading));
+
+    std::uint32_t t0 = r.ms;
+    std::uint32_t end = t0 + ctl.timeout_ms();
+
+    while ((std::int32_t)(r.ms - end) < 0) {
+        DriveCommand o = ctl.update((r.ms - t0) / 1000.0f, r.pose());
+        if (o.done) {
+            break;
+        }
+        r.drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+        r.tick();
+    }
+    r.stop();
+}
+
+// drivetrain::turn
+static void turn(Robot& r, const Tuning& g, float degrees, float half) {
+    float angle = degrees * (float)(M_PI / 180.0);
+    Profile prof = Profile::s_curve(angle, g.turn_vel, g.turn_accel, g.turn_jerk);
+    TurnControl ctl(prof, r.pose().theta, half, RuntimePid(g.turn));
+
+    std::uint32_t t0 = r.ms;
+    std::uint32_t end = t0 + ctl.timeout_ms();
+
+    while ((std::int32_t)(r.ms - end) < 0) {
+        DriveCommand o = ctl.update((r.ms - t0) / 1000.0f, r.pose().theta);
+        if (o.done) {
+            break;
+        }
+        r.drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+        r.tick();
+    }
+    r.stop();
+}
+
+// drivetrain::follow, raced against cap_ms (0 for none) as routine() does
+static void follow(Robot& r, const Tuning& g, const Path& path, float half, std::uint32_t cap_ms) {
+    if (path.size < 2) {
+        return;
+    }
+
+    FollowControl ctl(path, half, RuntimePid(g.pursuit), RuntimePid(g.pursuit));
+
+    std::uint32_t end = r.ms + ctl.timeout_ms();
+    if (cap_ms && (std::int32_t)(r.ms + cap_ms - end) < 0) {
+        end = r.ms + cap_ms;
+    }
+
+    while ((std::int32_t)(r.ms - end) < 0) {
+        DriveCommand o = ctl.update(r.pose(), r.left(), r.right());
+        if (o.done) {
+            break;
+        }
+        r.drive_ff(o.vl, o.al, o.fbl, o.vr, o.ar, o.fbr);
+        r.tick();
+    }
+    r.stop();
+}
+
+// One run of routine() in auton.cpp, the intake left out
+static Result run(const Tuning& g, const Variant& v) {
+    PathLimits lim = {g.drive_vel, g.drive_accel, PLAN_TURN_K};
+    Path to_goal;
+    Path to_loader;
+    to_goal.generate(TO_GOAL.wps, TO_GOAL.wp_count, lim);
+    to_loader.generate(TO_LOADER.wps, TO_LOADER.wp_count, lim);
+
+    Robot r;
+    r.drive.mass = v.mass;
+    r.drive.inertia = v.inertia;
+    r.drive.roll_drag = v.roll_drag;
+    r.drive.static_friction = v.static_friction;
+    r.battery = v.battery;
+    r.drive.x = (START_X + v.dx) * M_PER_IN;
+    r.drive.y = (START_Y + v.dy) * M_PER_IN;
+    r.drive.theta = START_HEADING * (float)(M_PI / 180.0) + v.dtheta;
+    const float half = r.drive.track / M_PER_IN / 2;
+
+    follow(r, g, to_goal, half, 0);
+    turn(r, g, GOAL_TURN, half);
+    follow(r, g, to_loader, half, LOADER_CAP_MS);
+    move(r, g, FINAL_MOVE);
+
+    Pose p = r.pose();
+    float ex = p.x - TARGET_X;
+    float ey = p.y - TARGET_Y;
+    float eh = std::remainder(p.theta - TARGET_HEADING * (float)(M_PI / 180.0), 2 * (float)M_PI);
+    Result res;
+    res.seconds = r.ms / 1000.0f;
+    res.error = std::sqrt(ex * ex + ey * ey) + std::fabs(eh) * half;
+    res.peak_amps = r.peak_amps;
+    res.ok = std::isfinite(res.error);
+    return res;
+}
+
+struct Weights {
+    float err = 2;
+    float amps = 0.05f;
+};
+
+static float cost(const Result& r, const Weights& w) {
+    if (!r.ok) {
+        return FAILED_COST;
+    }
+    return r.seconds + w.err * r.error + w.amps * r.peak_amps;
+}
+
+// The nominal robot first, then the perturbed ones
+static std::vector<Variant> variants(int n, Rng& rng) {
+    sim::DriveModel d;
+    std::vector<Variant> out;
+    out.push_back({d.mass, d.inertia, d.roll_drag, d.static_friction, 12, 0, 0, 0});
+    for (int i = 1; i < n; i++) {
+        auto spread = [&](float x, float frac) {
+            return x * (float)(1 + frac * (2 * rng.uniform() - 1));
+        };
+        Variant v;
+        v.mass = spread(d.mass, 0.15f);
+        v.inertia = spread(d.inertia, 0.2f);
+        v.roll_drag = spread(d.roll_drag, 0.3f);
+        v.static_friction = spread(d.static_friction, 0.3f);
+        v.battery = (float)(11 + rng.uniform());
+        v.dx = (float)(rng.gauss() * 0.5);
+        v.dy = (float)(rng.gauss() * 0.5);
+        v.dtheta = (float)(rng.gauss() * 0.01);
+        out.push_back(v);
+    }
+    return out;
+}
+
+// Every candidate against every robot, results[c * robots + v], spread over
+// the threads by an atomic job counter
+static void evaluate(const std::vector<Tuning>& cands, const std::vector<Variant>& robots,
+                     std::vector<Result>& results, int threads) {
+    const int jobs = (int)(cands.size() * robots.size());
+    std::atomic<int> next{0};
+    auto worker = [&] {
+        for (int j; (j = next.fetch_add(1, std::memory_order_relaxed)) < jobs;) {
+            results[j] = run(cands[j / robots.size()], robots[j % robots.size()]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
+
+// A candidate's results over the robots, the peak current the highest
+static Result mean(const Result* r, int n) {
+    Result m = {0, 0, 0, true};
+    for (int i = 0; i < n; i++) {
+        m.seconds += r[i].seconds / n;
+        m.error += r[i].error / n;
+        m.peak_amps = std::fmax(m.peak_amps, r[i].peak_amps);
+        m.ok = m.ok && r[i].ok;
+    }
+    return m;
+}
+
+static float mean_cost(const Result* r, int n, const Weights& w) {
+    float c = 0;
+    for (int i = 0; i < n; i++) c += cost(r[i], w) / n;
+    return c;
+}
+
+// Symmetric eigendecomposition by cyclic Jacobi rotations: a = b diag(d) b^T
+static void eigen(const double a_in[PARAMS][PARAMS], double b[PARAMS][PARAMS], double d[PARAMS]) {
+    double a[PARAMS][PARAMS];
+    std::memcpy(a, a_in, sizeof a);
+    for (int i = 0; i < PARAMS; i++) {
+        for (int j = 0; j < PARAMS; j++) b[i][j] = i == j;
+    }
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0;
+        for (int i = 0; i < PARAMS; i++) {
+            for (int j = i + 1; j < PARAMS; j++) off += a[i][j] * a[i][j];
+        }
+        if (off < 1e-30) {
+            break;
+        }
+        for (int p = 0; p < PARAMS; p++) {
+            for (int q = p + 1; q < PARAMS; q++) {
+                if (std::fabs(a[p][q]) < 1e-300) {
+                    continue;
+                }
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (theta >= 0 ? 1 : -1) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1);
+                double s = t * c;
+                for (int k = 0; k < PARAMS; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < PARAMS; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < PARAMS; k++) {
+                    double bkp = b[k][p], bkq = b[k][q];
+                    b[k][p] = c * bkp - s * bkq;
+                    b[k][q] = s * bkp + c * bkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < PARAMS; i++) d[i] = a[i][i] > 1e-20 ? std::sqrt(a[i][i]) : 1e-10;
+}
+
+static void print_result(const char* name, const Result& r, float c) {
+    std::printf("%-8s cost %7.3f  time %6.2f s  error %5.2f in  peak %5.1f A\n", name, c, r.seconds, r.error,
+                r.peak_amps);
+}
+
+int main(int argc, char** argv) {
+    int generations = 60;
+    int population = 0;
+    int robots = 8;
+    int threads = (int)std::thread::hardware_concurrency();
+    std::uint64_t seed = 1;
+    Weights w;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool more = i + 1 < argc;
+        if (!std::strcmp(a, "--generations") && more) generations = std::atoi(argv[++i]);
+        else if (!std::strcmp(a, "--population") && more) population = std::atoi(argv[++i]);
+        else if (!std::strcmp(a, "--robots") && more) robots = std::atoi(argv[++i]);
+        else if (!std::strcmp(a, "--threads") && more) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(a, "--seed") && more) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(a, "--w-err") && more) w.err = std::atof(argv[++i]);
+        else if (!std::strcmp(a, "--w-amps") && more) w.amps = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: tune_gains [--generations N] [--population N] [--robots N] [--threads N]\n"
+                                 "                  [--seed N] [--w-err X] [--w-amps X]\n");
+            return 2;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (robots < 1) robots = 1;
+
+    // CMA-ES settings as in Hansen's tutorial
+    // The population doesn't depend on the thread count, the job counter
+    // spreads its runs over the threads however many there are
+    const int n = PARAMS;
+    int lambda = 4 + (int)(3 * std::log(n));
+    if (population > 0) lambda = population;
+    const int mu = lambda / 2;
+    std::vector<double> wt(mu);
+    double wsum = 0;
+    for (int i = 0; i < mu; i++) wsum += wt[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+    double mueff_num = 0;
+    for (double& x : wt) {
+        x /= wsum;
+        mueff_num += x * x;
+    }
+    const double mueff = 1 / mueff_num;
+    const double cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+    const double cs = (mueff + 2) / (n + mueff + 5);
+    const double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+    const double cmu = std::fmin(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((n + 2) * (n + 2) + mueff));
+    const double damps = 1 + 2 * std::fmax(0, std::sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+    const double chin = std::sqrt(n) * (1 - 1.0 / (4 * n) + 1.0 / (21.0 * n * n));
+
+    Rng rng{seed};
+    std::vector<Variant> robot_set = variants(robots, rng);
+
+    double mean_u[PARAMS];
+    for (int i = 0; i < n; i++) mean_u[i] = param_unit(i, INFO[i].now);
+    double sigma = 0.15;
+    double C[PARAMS][PARAMS] = {};
+    double B[PARAMS][PARAMS];
+    double D[PARAMS];
+    double pc[PARAMS] = {};
+    double ps[PARAMS] = {};
+    for (int i = 0; i < n; i++) C[i][i] = 1;
+    eigen(C, B, D);
+
+    // Preallocated once, the runs themselves allocate nothing
+    std::vector<double> z(lambda * n), y(lambda * n), u(lambda * n);
+    std::vector<Tuning> cands(lambda);
+    std::vector<Result> results(lambda * robots);
+    std::vector<float> costs(lambda);
+    std::vector<int> order(lambda);
+
+    cands.assign(1, tuning(mean_u));
+    evaluate(cands, robot_set, results, threads);
+    const Result start_result = mean(results.data(), robots);
+    const float start_cost = mean_cost(results.data(), robots, w);
+    print_result("current", start_result, start_cost);
+
+    double best_u[PARAMS];
+    std::memcpy(best_u, mean_u, sizeof best_u);
+    float best_cost = start_cost;
+    Result best_result = start_result;
+    cands.resize(lambda);
+
+    long runs = robots;
+    for (int gen = 0; gen < generations; gen++) {
+        for (int k = 0; k < lambda; k++) {
+            for (int i = 0; i < n; i++) z[k * n + i] = rng.gauss();
+            for (int i = 0; i < n; i++) {
+                double s = 0;
+                for (int j = 0; j < n; j++) s += B[i][j] * D[j] * z[k * n + j];
+                y[k * n + i] = s;
+                u[k * n + i] = mean_u[i] + sigma * s;
+            }
+            cands[k] = tuning(&u[k * n]);
+        }
+
+        evaluate(cands, robot_set, results, threads);
+        runs += (long)lambda * robots;
+
+        for (int k = 0; k < lambda; k++) {
+            float out = 0;
+            for (int i = 0; i < n; i++) {
+                double e = u[k * n + i] - clamp01(u[k * n + i]);
+                out += (float)(e * e);
+            }
+            costs[k] = mean_cost(&results[k * robots], robots, w) + BOUND_PENALTY * out;
+            order[k] = k;
+        }
+        // Insertion sort, stable so ties keep their sample order
+        for (int a = 1; a < lambda; a++) {
+            int k = order[a];
+            int b = a;
+            for (; b > 0 && costs[order[b - 1]] > costs[k]; b--) order[b] = order[b - 1];
+            order[b] = k;
+        }
+
+        int top = order[0];
+        if (costs[top] < best_cost) {
+            best_cost = costs[top];
+            best_result = mean(&results[top * robots], robots);
+            for (int i = 0; i < n; i++) best_u[i] = clamp01(u[top * n + i]);
+        }
+
+        // Mean step, in the sampled y's
+        double yw[PARAMS] = {};
+        for (int r = 0; r < mu; r++) {
+            for (int i = 0; i < n; i++) yw[i] += wt[r] * y[order[r] * n + i];
+        }
+        for (int i = 0; i < n; i++) mean_u[i] += sigma * yw[i];
+
+        // Step size path, through C^-1/2 = B D^-1 B^T
+        double bty[PARAMS];
+        for (int j = 0; j < n; j++) {
+            double s = 0;
+            for (int i = 0; i < n; i++) s += B[i][j] * yw[i];
+            bty[j] = s / D[j];
+        }
+        double ps_norm = 0;
+        for (int i = 0; i < n; i++) {
+            double s = 0;
+            for (int j = 0; j < n; j++) s += B[i][j] * bty[j];
+            ps[i] = (1 - cs) * ps[i] + std::sqrt(cs * (2 - cs) * mueff) * s;
+            ps_norm += ps[i] * ps[i];
+        }
+        ps_norm = std::sqrt(ps_norm);
+        bool hsig = ps_norm / std::sqrt(1 - std::pow(1 - cs, 2.0 * (gen + 1))) / chin < 1.4 + 2.0 / (n + 1);
+        for (int i = 0; i < n; i++) {
+            pc[i] = (1 - cc) * pc[i] + (hsig ? std::sqrt(cc * (2 - cc) * mueff) * yw[i] : 0);
+        }
+
+        // Covariance: rank one from the path, rank mu from the best samples
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j <= i; j++) {
+                double rmu = 0;
+                for (int r = 0; r < mu; r++) rmu += wt[r] * y[order[r] * n + i] * y[order[r] * n + j];
+                double c = (1 - c1 - cmu) * C[i][j] + c1 * (pc[i] * pc[j] + (!hsig) * cc * (2 - cc) * C[i][j]) +
+                           cmu * rmu;
+                C[i][j] = C[j][i] = c;
+            }
+        }
+        sigma *= std::exp(cs / damps * (ps_norm / chin - 1));
+        eigen(C, B, D);
+
+        std::printf("gen %3d  best %7.3f  this %7.3f  sigma %.4f  runs %ld\n", gen + 1, best_cost, costs[top], sigma,
+                    runs);
+        std::fflush(stdout);
+    }
+
+    std::printf("\n");
+    print_result("current", start_result, start_cost);
+    print_result("tuned", best_result, best_cost);
+    std::printf("(time and error averaged over %d robots, peak current the highest)\n\n", robots);
+
+    // Ready to paste over drive_gains.h
+    Tuning t = tuning(best_u);
+    std::printf("#define DRIVE_MAX_VEL %.1ff\n", t.drive_vel);
+    std::printf("#define DRIVE_MAX_ACCEL %.1ff\n", t.drive_accel);
+    std::printf("#define DRIVE_MAX_JERK %.0f.0f\n", t.drive_jerk);
+    std::printf("#define TURN_MAX_VEL %.2ff\n", t.turn_vel);
+    std::printf("#define TURN_MAX_ACCEL %.1ff\n", t.turn_accel);
+    std::printf("#define TURN_MAX_JERK %.0f.0f\n", t.turn_jerk);
+    std::printf("constexpr PidGains DRIVE_PID = {.kp = %.0f, .dt = MOVE_DT};\n", t.drive.kp);
+    std::printf("constexpr PidGains HEADING_PID = {.kp = %.0f, .dt = MOVE_DT};\n", t.heading.kp);
+    std::printf("constexpr PidGains TURN_PID = {.kp = %.0f, .dt = MOVE_DT};\n", t.turn.kp);
+    std::printf("constexpr PidGains PURSUIT_VEL_PID = {.kp = %.1f, .dt = MOVE_DT};\n", t.pursuit.kp);
+    return 0;
+}